@@ -3,6 +3,12 @@
 
 #include <stdint.h> // uint64_t
 #include <stdio.h> // printf
+#include <stdlib.h> // exit
+#include <stdarg.h> // va_list
+
+#if defined(__linux__)
+#include <time.h> // clock_gettime
+#endif //__linux__
 
 #if defined(_WIN32)
 #include <Windows.h>
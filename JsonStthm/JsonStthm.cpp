@@ -1,9 +1,63 @@
 #include "JsonStthm.h"
 
 #include <stdio.h> // FILE, fopen, fclose, fwrite, fread
-
-// Experimental long/double parser
-//#define STTHM_USE_CUSTOM_NUMERIC_PARSER
+#include <locale.h> // localeconv
+#include <errno.h> // errno, EINTR
+
+#if defined(_WIN32)
+#	include <io.h> // _write
+#else
+#	include <unistd.h> // write
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility> // std::move
+
+#if !defined(STTHM_DISABLE_FILE_MAPPING) && (defined(__unix__) || defined(__APPLE__))
+#	define STTHM_FILE_MAPPING
+#	include <sys/mman.h> // mmap, madvise
+#	include <sys/stat.h> // fstat
+#	include <fcntl.h> // open
+#	include <unistd.h> // close, sysconf
+#endif
+
+#if !defined(STTHM_DISABLE_SIMD)
+#	if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#		define STTHM_SSE2
+#		include <emmintrin.h>
+#		if defined(_MSC_VER)
+#			define STTHM_SSSE3
+#			define STTHM_TARGET_SSSE3
+#			define STTHM_AVX2
+#			define STTHM_TARGET_AVX2
+#			include <immintrin.h>
+#			include <intrin.h>
+#		elif defined(__GNUC__) || defined(__clang__)
+#			define STTHM_SSSE3
+#			define STTHM_TARGET_SSSE3 __attribute__((target("ssse3")))
+#			define STTHM_AVX2
+#			define STTHM_TARGET_AVX2 __attribute__((target("avx2")))
+#			include <immintrin.h>
+#		endif
+#	endif
+#endif //!STTHM_DISABLE_SIMD
+
+#if defined(__clang__) || defined(__GNUC__)
+#	define STTHM_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+#	define STTHM_NO_SANITIZE_ADDRESS
+#endif
+
+#if defined(__clang__) || defined(__GNUC__)
+#	define STTHM_PREFETCH(pAddress) __builtin_prefetch(pAddress)
+#elif defined(STTHM_SSE2)
+#	define STTHM_PREFETCH(pAddress) _mm_prefetch((const char*)(pAddress), _MM_HINT_T0)
+#else
+#	define STTHM_PREFETCH(pAddress)
+#endif
 
 namespace JsonStthm
 {
@@ -66,1695 +120,7212 @@ namespace JsonStthm
 			while (IsSpace(*pString)) ++pString;
 		}
 
-		int64_t StrToInt64(const char* pString, char** pEnd)
+		// Compare char by char to never read past the null terminator
+		inline bool MatchLiteral(const char*& pString, const char* pLiteral, size_t iLength)
 		{
-			bool bNeg = false;
-			if (*pString == '-')
+			for (size_t i = 0; i < iLength; ++i)
 			{
-				++pString;
-				bNeg = true;
+				if (pString[i] != pLiteral[i])
+					return false;
 			}
-
-			int64_t lValue = 0;
-			while (IsDigit(*pString))
-				lValue = lValue * 10 + (*pString++ & 0xF);
-
-			if (pEnd != NULL)
-				*pEnd = (char*)pString;
-
-			return bNeg ? -lValue : lValue;
+			pString += iLength;
+			return true;
 		}
-	}
-
-	//////////////////////////////
-	// JsonValue::Iterator
-	//////////////////////////////
 
-	JsonValue::Iterator::Iterator(const JsonValue* pJson)
-	{
-		if (pJson != NULL && pJson->IsContainer())
+		inline int CountLeadingZeros(uint64_t iValue)
 		{
-			m_pChild = pJson->m_oValue.Childs.m_pFirst;
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+			unsigned long iIndex;
+			_BitScanReverse64(&iIndex, iValue);
+			return 63 - (int)iIndex;
+#elif defined(_MSC_VER)
+			unsigned long iIndex;
+			if (_BitScanReverse(&iIndex, (unsigned long)(iValue >> 32)))
+				return 31 - (int)iIndex;
+			_BitScanReverse(&iIndex, (unsigned long)iValue);
+			return 63 - (int)iIndex;
+#else
+			return __builtin_clzll(iValue);
+#endif
 		}
-		else
+
+		// Returns low 64 bits of iA * iB, high 64 bits in iHigh
+		inline uint64_t Multiply128(uint64_t iA, uint64_t iB, uint64_t& iHigh)
 		{
-			m_pChild = NULL;
+#if defined(__SIZEOF_INT128__)
+			unsigned __int128 iResult = (unsigned __int128)iA * iB;
+			iHigh = (uint64_t)(iResult >> 64);
+			return (uint64_t)iResult;
+#elif defined(_MSC_VER) && defined(_M_X64)
+			return _umul128(iA, iB, &iHigh);
+#else
+			uint64_t iALow = (uint32_t)iA, iAHigh = iA >> 32;
+			uint64_t iBLow = (uint32_t)iB, iBHigh = iB >> 32;
+			uint64_t iLowLow = iALow * iBLow;
+			uint64_t iLowHigh = iALow * iBHigh;
+			uint64_t iHighLow = iAHigh * iBLow;
+			uint64_t iCross = (iLowLow >> 32) + (uint32_t)iLowHigh + (uint32_t)iHighLow;
+			iHigh = iAHigh * iBHigh + (iLowHigh >> 32) + (iHighLow >> 32) + (iCross >> 32);
+			return (iCross << 32) | (uint32_t)iLowLow;
+#endif
 		}
-	}
-
-	JsonValue::Iterator::Iterator(const Iterator& oIt)
-	{
-		m_pChild = oIt.m_pChild;
-	}
-
-	bool JsonValue::Iterator::IsValid() const
-	{
-		return m_pChild != NULL;
-	}
-
-	bool JsonValue::Iterator::operator!=(const Iterator& oIte) const
-	{
-		return m_pChild != oIte.m_pChild;
-	}
-
-	void JsonValue::Iterator::operator++()
-	{
-		if (m_pChild != NULL)
-			m_pChild = m_pChild->m_pNext;
-	}
-
-	JsonValue& JsonValue::Iterator::operator*() const
-	{
-		return m_pChild != NULL ? *m_pChild : INVALID;
-	}
-
-	JsonValue* JsonValue::Iterator::operator->() const
-	{
-		return m_pChild;
-	}
-
-	//////////////////////////////
-	// JsonValue
-	//////////////////////////////
-
-	JsonValue JsonValue::INVALID;
-
-	Allocator JsonValue::s_oDefaultAllocator = {
-		JsonValue::DefaultAllocatorCreateJsonValue,
-		JsonValue::DefaultAllocatorDeleteJsonValue,
-		JsonValue::DefaultAllocatorAllocString,
-		JsonValue::DefaultAllocatorFreeString,
-		NULL
-	};
-
-	JsonValue::JsonValue(Allocator* pAllocator)
-		: m_pAllocator(pAllocator)
-		, m_eType(E_TYPE_NULL)
-		, m_pName(NULL)
-		, m_pNext(NULL)
-	{
-		JsonStthmAssert(m_pAllocator != NULL);
-	}
-
-	JsonValue::JsonValue()
-		: m_pAllocator(&s_oDefaultAllocator)
-		, m_eType(E_TYPE_NULL)
-		, m_pName(NULL)
-		, m_pNext(NULL)
-	{
-	}
-
-	JsonValue::JsonValue(const JsonValue& oSource)
-		: m_pAllocator(&s_oDefaultAllocator)
-		, m_eType(E_TYPE_NULL)
-		, m_pName(NULL)
-		, m_pNext(NULL)
-	{
-		*this = oSource;
-	}
-
-	JsonValue::JsonValue(bool bValue)
-		: m_pAllocator(&s_oDefaultAllocator)
-		, m_eType(E_TYPE_NULL)
-		, m_pName(NULL)
-		, m_pNext(NULL)
-	{
-		*this = bValue;
-	}
-
-#ifdef JsonStthmString
-	JsonValue::JsonValue(const JsonStthmString& sValue)
-		: m_pAllocator(&s_oDefaultAllocator)
-		, m_eType(E_TYPE_NULL)
-		, m_pName(NULL)
-		, m_pNext(NULL)
-	{
-		*this = sValue;
-	}
-#endif //JsonStthmString
 
-	JsonValue::JsonValue(const char* pValue)
-		: m_pAllocator(&s_oDefaultAllocator)
-		, m_eType(E_TYPE_NULL)
-		, m_pName(NULL)
-		, m_pNext(NULL)
-	{
-		*this = pValue;
-	}
-
-	JsonValue::JsonValue(int64_t iValue)
-		: m_pAllocator(&s_oDefaultAllocator)
-		, m_eType(E_TYPE_NULL)
-		, m_pName(NULL)
-		, m_pNext(NULL)
-	{
-		*this = iValue;
-	}
+		const double c_pExactPowersOfTen[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
 
-	JsonValue::JsonValue(double fValue)
-		: m_pAllocator(&s_oDefaultAllocator)
-		, m_eType(E_TYPE_NULL)
-		, m_pName(NULL)
-		, m_pNext(NULL)
-	{
-		*this = fValue;
-	}
+		const int c_iPowersOfTen128Min = -348;
+		const int c_iPowersOfTen128Max = 347;
+
+		// 128 bits normalized approximations (rounded down) of 10^e, { low, high }
+		const uint64_t c_pPowersOfTen128[][2] = {
+			{ 0x1732C869CD60E453, 0xFA8FD5A0081C0288 }, { 0x0E7FBD42205C8EB4, 0x9C99E58405118195 },
+			{ 0x521FAC92A873B261, 0xC3C05EE50655E1FA }, { 0xE6A797B752909EF9, 0xF4B0769E47EB5A78 },
+			{ 0x9028BED2939A635C, 0x98EE4A22ECF3188B }, { 0x7432EE873880FC33, 0xBF29DCABA82FDEAE },
+			{ 0x113FAA2906A13B3F, 0xEEF453D6923BD65A }, { 0x4AC7CA59A424C507, 0x9558B4661B6565F8 },
+			{ 0x5D79BCF00D2DF649, 0xBAAEE17FA23EBF76 }, { 0xF4D82C2C107973DC, 0xE95A99DF8ACE6F53 },
+			{ 0x79071B9B8A4BE869, 0x91D8A02BB6C10594 }, { 0x9748E2826CDEE284, 0xB64EC836A47146F9 },
+			{ 0xFD1B1B2308169B25, 0xE3E27A444D8D98B7 }, { 0xFE30F0F5E50E20F7, 0x8E6D8C6AB0787F72 },
+			{ 0xBDBD2D335E51A935, 0xB208EF855C969F4F }, { 0xAD2C788035E61382, 0xDE8B2B66B3BC4723 },
+			{ 0x4C3BCB5021AFCC31, 0x8B16FB203055AC76 }, { 0xDF4ABE242A1BBF3D, 0xADDCB9E83C6B1793 },
+			{ 0xD71D6DAD34A2AF0D, 0xD953E8624B85DD78 }, { 0x8672648C40E5AD68, 0x87D4713D6F33AA6B },
+			{ 0x680EFDAF511F18C2, 0xA9C98D8CCB009506 }, { 0x0212BD1B2566DEF2, 0xD43BF0EFFDC0BA48 },
+			{ 0x014BB630F7604B57, 0x84A57695FE98746D }, { 0x419EA3BD35385E2D, 0xA5CED43B7E3E9188 },
+			{ 0x52064CAC828675B9, 0xCF42894A5DCE35EA }, { 0x7343EFEBD1940993, 0x818995CE7AA0E1B2 },
+			{ 0x1014EBE6C5F90BF8, 0xA1EBFB4219491A1F }, { 0xD41A26E077774EF6, 0xCA66FA129F9B60A6 },
+			{ 0x8920B098955522B4, 0xFD00B897478238D0 }, { 0x55B46E5F5D5535B0, 0x9E20735E8CB16382 },
+			{ 0xEB2189F734AA831D, 0xC5A890362FDDBC62 }, { 0xA5E9EC7501D523E4, 0xF712B443BBD52B7B },
+			{ 0x47B233C92125366E, 0x9A6BB0AA55653B2D }, { 0x999EC0BB696E840A, 0xC1069CD4EABE89F8 },
+			{ 0xC00670EA43CA250D, 0xF148440A256E2C76 }, { 0x380406926A5E5728, 0x96CD2A865764DBCA },
+			{ 0xC605083704F5ECF2, 0xBC807527ED3E12BC }, { 0xF7864A44C633682E, 0xEBA09271E88D976B },
+			{ 0x7AB3EE6AFBE0211D, 0x93445B8731587EA3 }, { 0x5960EA05BAD82964, 0xB8157268FDAE9E4C },
+			{ 0x6FB92487298E33BD, 0xE61ACF033D1A45DF }, { 0xA5D3B6D479F8E056, 0x8FD0C16206306BAB },
+			{ 0x8F48A4899877186C, 0xB3C4F1BA87BC8696 }, { 0x331ACDABFE94DE87, 0xE0B62E2929ABA83C },
+			{ 0x9FF0C08B7F1D0B14, 0x8C71DCD9BA0B4925 }, { 0x07ECF0AE5EE44DD9, 0xAF8E5410288E1B6F },
+			{ 0xC9E82CD9F69D6150, 0xDB71E91432B1A24A }, { 0xBE311C083A225CD2, 0x892731AC9FAF056E },
+			{ 0x6DBD630A48AAF406, 0xAB70FE17C79AC6CA }, { 0x092CBBCCDAD5B108, 0xD64D3D9DB981787D },
+			{ 0x25BBF56008C58EA5, 0x85F0468293F0EB4E }, { 0xAF2AF2B80AF6F24E, 0xA76C582338ED2621 },
+			{ 0x1AF5AF660DB4AEE1, 0xD1476E2C07286FAA }, { 0x50D98D9FC890ED4D, 0x82CCA4DB847945CA },
+			{ 0xE50FF107BAB528A0, 0xA37FCE126597973C }, { 0x1E53ED49A96272C8, 0xCC5FC196FEFD7D0C },
+			{ 0x25E8E89C13BB0F7A, 0xFF77B1FCBEBCDC4F }, { 0x77B191618C54E9AC, 0x9FAACF3DF73609B1 },
+			{ 0xD59DF5B9EF6A2417, 0xC795830D75038C1D }, { 0x4B0573286B44AD1D, 0xF97AE3D0D2446F25 },
+			{ 0x4EE367F9430AEC32, 0x9BECCE62836AC577 }, { 0x229C41F793CDA73F, 0xC2E801FB244576D5 },
+			{ 0x6B43527578C1110F, 0xF3A20279ED56D48A }, { 0x830A13896B78AAA9, 0x9845418C345644D6 },
+			{ 0x23CC986BC656D553, 0xBE5691EF416BD60C }, { 0x2CBFBE86B7EC8AA8, 0xEDEC366B11C6CB8F },
+			{ 0x7BF7D71432F3D6A9, 0x94B3A202EB1C3F39 }, { 0xDAF5CCD93FB0CC53, 0xB9E08A83A5E34F07 },
+			{ 0xD1B3400F8F9CFF68, 0xE858AD248F5C22C9 }, { 0x23100809B9C21FA1, 0x91376C36D99995BE },
+			{ 0xABD40A0C2832A78A, 0xB58547448FFFFB2D }, { 0x16C90C8F323F516C, 0xE2E69915B3FFF9F9 },
+			{ 0xAE3DA7D97F6792E3, 0x8DD01FAD907FFC3B }, { 0x99CD11CFDF41779C, 0xB1442798F49FFB4A },
+			{ 0x40405643D711D583, 0xDD95317F31C7FA1D }, { 0x482835EA666B2572, 0x8A7D3EEF7F1CFC52 },
+			{ 0xDA3243650005EECF, 0xAD1C8EAB5EE43B66 }, { 0x90BED43E40076A82, 0xD863B256369D4A40 },
+			{ 0x5A7744A6E804A291, 0x873E4F75E2224E68 }, { 0x711515D0A205CB36, 0xA90DE3535AAAE202 },
+			{ 0x0D5A5B44CA873E03, 0xD3515C2831559A83 }, { 0xE858790AFE9486C2, 0x8412D9991ED58091 },
+			{ 0x626E974DBE39A872, 0xA5178FFF668AE0B6 }, { 0xFB0A3D212DC8128F, 0xCE5D73FF402D98E3 },
+			{ 0x7CE66634BC9D0B99, 0x80FA687F881C7F8E }, { 0x1C1FFFC1EBC44E80, 0xA139029F6A239F72 },
+			{ 0xA327FFB266B56220, 0xC987434744AC874E }, { 0x4BF1FF9F0062BAA8, 0xFBE9141915D7A922 },
+			{ 0x6F773FC3603DB4A9, 0x9D71AC8FADA6C9B5 }, { 0xCB550FB4384D21D3, 0xC4CE17B399107C22 },
+			{ 0x7E2A53A146606A48, 0xF6019DA07F549B2B }, { 0x2EDA7444CBFC426D, 0x99C102844F94E0FB },
+			{ 0xFA911155FEFB5308, 0xC0314325637A1939 }, { 0x793555AB7EBA27CA, 0xF03D93EEBC589F88 },
+			{ 0x4BC1558B2F3458DE, 0x96267C7535B763B5 }, { 0x9EB1AAEDFB016F16, 0xBBB01B9283253CA2 },
+			{ 0x465E15A979C1CADC, 0xEA9C227723EE8BCB }, { 0x0BFACD89EC191EC9, 0x92A1958A7675175F },
+			{ 0xCEF980EC671F667B, 0xB749FAED14125D36 }, { 0x82B7E12780E7401A, 0xE51C79A85916F484 },
+			{ 0xD1B2ECB8B0908810, 0x8F31CC0937AE58D2 }, { 0x861FA7E6DCB4AA15, 0xB2FE3F0B8599EF07 },
+			{ 0x67A791E093E1D49A, 0xDFBDCECE67006AC9 }, { 0xE0C8BB2C5C6D24E0, 0x8BD6A141006042BD },
+			{ 0x58FAE9F773886E18, 0xAECC49914078536D }, { 0xAF39A475506A899E, 0xDA7F5BF590966848 },
+			{ 0x6D8406C952429603, 0x888F99797A5E012D }, { 0xC8E5087BA6D33B83, 0xAAB37FD7D8F58178 },
+			{ 0xFB1E4A9A90880A64, 0xD5605FCDCF32E1D6 }, { 0x5CF2EEA09A55067F, 0x855C3BE0A17FCD26 },
+			{ 0xF42FAA48C0EA481E, 0xA6B34AD8C9DFC06F }, { 0xF13B94DAF124DA26, 0xD0601D8EFC57B08B },
+			{ 0x76C53D08D6B70858, 0x823C12795DB6CE57 }, { 0x54768C4B0C64CA6E, 0xA2CB1717B52481ED },
+			{ 0xA9942F5DCF7DFD09, 0xCB7DDCDDA26DA268 }, { 0xD3F93B35435D7C4C, 0xFE5D54150B090B02 },
+			{ 0xC47BC5014A1A6DAF, 0x9EFA548D26E5A6E1 }, { 0x359AB6419CA1091B, 0xC6B8E9B0709F109A },
+			{ 0xC30163D203C94B62, 0xF867241C8CC6D4C0 }, { 0x79E0DE63425DCF1D, 0x9B407691D7FC44F8 },
+			{ 0x985915FC12F542E4, 0xC21094364DFB5636 }, { 0x3E6F5B7B17B2939D, 0xF294B943E17A2BC4 },
+			{ 0xA705992CEECF9C42, 0x979CF3CA6CEC5B5A }, { 0x50C6FF782A838353, 0xBD8430BD08277231 },
+			{ 0xA4F8BF5635246428, 0xECE53CEC4A314EBD }, { 0x871B7795E136BE99, 0x940F4613AE5ED136 },
+			{ 0x28E2557B59846E3F, 0xB913179899F68584 }, { 0x331AEADA2FE589CF, 0xE757DD7EC07426E5 },
+			{ 0x3FF0D2C85DEF7621, 0x9096EA6F3848984F }, { 0x0FED077A756B53A9, 0xB4BCA50B065ABE63 },
+			{ 0xD3E8495912C62894, 0xE1EBCE4DC7F16DFB }, { 0x64712DD7ABBBD95C, 0x8D3360F09CF6E4BD },
+			{ 0xBD8D794D96AACFB3, 0xB080392CC4349DEC }, { 0xECF0D7A0FC5583A0, 0xDCA04777F541C567 },
+			{ 0xF41686C49DB57244, 0x89E42CAAF9491B60 }, { 0x311C2875C522CED5, 0xAC5D37D5B79B6239 },
+			{ 0x7D633293366B828B, 0xD77485CB25823AC7 }, { 0xAE5DFF9C02033197, 0x86A8D39EF77164BC },
+			{ 0xD9F57F830283FDFC, 0xA8530886B54DBDEB }, { 0xD072DF63C324FD7B, 0xD267CAA862A12D66 },
+			{ 0x4247CB9E59F71E6D, 0x8380DEA93DA4BC60 }, { 0x52D9BE85F074E608, 0xA46116538D0DEB78 },
+			{ 0x67902E276C921F8B, 0xCD795BE870516656 }, { 0x00BA1CD8A3DB53B6, 0x806BD9714632DFF6 },
+			{ 0x80E8A40ECCD228A4, 0xA086CFCD97BF97F3 }, { 0x6122CD128006B2CD, 0xC8A883C0FDAF7DF0 },
+			{ 0x796B805720085F81, 0xFAD2A4B13D1B5D6C }, { 0xCBE3303674053BB0, 0x9CC3A6EEC6311A63 },
+			{ 0xBEDBFC4411068A9C, 0xC3F490AA77BD60FC }, { 0xEE92FB5515482D44, 0xF4F1B4D515ACB93B },
+			{ 0x751BDD152D4D1C4A, 0x991711052D8BF3C5 }, { 0xD262D45A78A0635D, 0xBF5CD54678EEF0B6 },
+			{ 0x86FB897116C87C34, 0xEF340A98172AACE4 }, { 0xD45D35E6AE3D4DA0, 0x9580869F0E7AAC0E },
+			{ 0x8974836059CCA109, 0xBAE0A846D2195712 }, { 0x2BD1A438703FC94B, 0xE998D258869FACD7 },
+			{ 0x7B6306A34627DDCF, 0x91FF83775423CC06 }, { 0x1A3BC84C17B1D542, 0xB67F6455292CBF08 },
+			{ 0x20CABA5F1D9E4A93, 0xE41F3D6A7377EECA }, { 0x547EB47B7282EE9C, 0x8E938662882AF53E },
+			{ 0xE99E619A4F23AA43, 0xB23867FB2A35B28D }, { 0x6405FA00E2EC94D4, 0xDEC681F9F4C31F31 },
+			{ 0xDE83BC408DD3DD04, 0x8B3C113C38F9F37E }, { 0x9624AB50B148D445, 0xAE0B158B4738705E },
+			{ 0x3BADD624DD9B0957, 0xD98DDAEE19068C76 }, { 0xE54CA5D70A80E5D6, 0x87F8A8D4CFA417C9 },
+			{ 0x5E9FCF4CCD211F4C, 0xA9F6D30A038D1DBC }, { 0x7647C3200069671F, 0xD47487CC8470652B },
+			{ 0x29ECD9F40041E073, 0x84C8D4DFD2C63F3B }, { 0xF468107100525890, 0xA5FB0A17C777CF09 },
+			{ 0x7182148D4066EEB4, 0xCF79CC9DB955C2CC }, { 0xC6F14CD848405530, 0x81AC1FE293D599BF },
+			{ 0xB8ADA00E5A506A7C, 0xA21727DB38CB002F }, { 0xA6D90811F0E4851C, 0xCA9CF1D206FDC03B },
+			{ 0x908F4A166D1DA663, 0xFD442E4688BD304A }, { 0x9A598E4E043287FE, 0x9E4A9CEC15763E2E },
+			{ 0x40EFF1E1853F29FD, 0xC5DD44271AD3CDBA }, { 0xD12BEE59E68EF47C, 0xF7549530E188C128 },
+			{ 0x82BB74F8301958CE, 0x9A94DD3E8CF578B9 }, { 0xE36A52363C1FAF01, 0xC13A148E3032D6E7 },
+			{ 0xDC44E6C3CB279AC1, 0xF18899B1BC3F8CA1 }, { 0x29AB103A5EF8C0B9, 0x96F5600F15A7B7E5 },
+			{ 0x7415D448F6B6F0E7, 0xBCB2B812DB11A5DE }, { 0x111B495B3464AD21, 0xEBDF661791D60F56 },
+			{ 0xCAB10DD900BEEC34, 0x936B9FCEBB25C995 }, { 0x3D5D514F40EEA742, 0xB84687C269EF3BFB },
+			{ 0x0CB4A5A3112A5112, 0xE65829B3046B0AFA }, { 0x47F0E785EABA72AB, 0x8FF71A0FE2C2E6DC },
+			{ 0x59ED216765690F56, 0xB3F4E093DB73A093 }, { 0x306869C13EC3532C, 0xE0F218B8D25088B8 },
+			{ 0x1E414218C73A13FB, 0x8C974F7383725573 }, { 0xE5D1929EF90898FA, 0xAFBD2350644EEACF },
+			{ 0xDF45F746B74ABF39, 0xDBAC6C247D62A583 }, { 0x6B8BBA8C328EB783, 0x894BC396CE5DA772 },
+			{ 0x066EA92F3F326564, 0xAB9EB47C81F5114F }, { 0xC80A537B0EFEFEBD, 0xD686619BA27255A2 },
+			{ 0xBD06742CE95F5F36, 0x8613FD0145877585 }, { 0x2C48113823B73704, 0xA798FC4196E952E7 },
+			{ 0xF75A15862CA504C5, 0xD17F3B51FCA3A7A0 }, { 0x9A984D73DBE722FB, 0x82EF85133DE648C4 },
+			{ 0xC13E60D0D2E0EBBA, 0xA3AB66580D5FDAF5 }, { 0x318DF905079926A8, 0xCC963FEE10B7D1B3 },
+			{ 0xFDF17746497F7052, 0xFFBBCFE994E5C61F }, { 0xFEB6EA8BEDEFA633, 0x9FD561F1FD0F9BD3 },
+			{ 0xFE64A52EE96B8FC0, 0xC7CABA6E7C5382C8 }, { 0x3DFDCE7AA3C673B0, 0xF9BD690A1B68637B },
+			{ 0x06BEA10CA65C084E, 0x9C1661A651213E2D }, { 0x486E494FCFF30A62, 0xC31BFA0FE5698DB8 },
+			{ 0x5A89DBA3C3EFCCFA, 0xF3E2F893DEC3F126 }, { 0xF89629465A75E01C, 0x986DDB5C6B3A76B7 },
+			{ 0xF6BBB397F1135823, 0xBE89523386091465 }, { 0x746AA07DED582E2C, 0xEE2BA6C0678B597F },
+			{ 0xA8C2A44EB4571CDC, 0x94DB483840B717EF }, { 0x92F34D62616CE413, 0xBA121A4650E4DDEB },
+			{ 0x77B020BAF9C81D17, 0xE896A0D7E51E1566 }, { 0x0ACE1474DC1D122E, 0x915E2486EF32CD60 },
+			{ 0x0D819992132456BA, 0xB5B5ADA8AAFF80B8 }, { 0x10E1FFF697ED6C69, 0xE3231912D5BF60E6 },
+			{ 0xCA8D3FFA1EF463C1, 0x8DF5EFABC5979C8F }, { 0xBD308FF8A6B17CB2, 0xB1736B96B6FD83B3 },
+			{ 0xAC7CB3F6D05DDBDE, 0xDDD0467C64BCE4A0 }, { 0x6BCDF07A423AA96B, 0x8AA22C0DBEF60EE4 },
+			{ 0x86C16C98D2C953C6, 0xAD4AB7112EB3929D }, { 0xE871C7BF077BA8B7, 0xD89D64D57A607744 },
+			{ 0x11471CD764AD4972, 0x87625F056C7C4A8B }, { 0xD598E40D3DD89BCF, 0xA93AF6C6C79B5D2D },
+			{ 0x4AFF1D108D4EC2C3, 0xD389B47879823479 }, { 0xCEDF722A585139BA, 0x843610CB4BF160CB },
+			{ 0xC2974EB4EE658828, 0xA54394FE1EEDB8FE }, { 0x733D226229FEEA32, 0xCE947A3DA6A9273E },
+			{ 0x0806357D5A3F525F, 0x811CCC668829B887 }, { 0xCA07C2DCB0CF26F7, 0xA163FF802A3426A8 },
+			{ 0xFC89B393DD02F0B5, 0xC9BCFF6034C13052 }, { 0xBBAC2078D443ACE2, 0xFC2C3F3841F17C67 },
+			{ 0xD54B944B84AA4C0D, 0x9D9BA7832936EDC0 }, { 0x0A9E795E65D4DF11, 0xC5029163F384A931 },
+			{ 0x4D4617B5FF4A16D5, 0xF64335BCF065D37D }, { 0x504BCED1BF8E4E45, 0x99EA0196163FA42E },
+			{ 0xE45EC2862F71E1D6, 0xC06481FB9BCF8D39 }, { 0x5D767327BB4E5A4C, 0xF07DA27A82C37088 },
+			{ 0x3A6A07F8D510F86F, 0x964E858C91BA2655 }, { 0x890489F70A55368B, 0xBBE226EFB628AFEA },
+			{ 0x2B45AC74CCEA842E, 0xEADAB0ABA3B2DBE5 }, { 0x3B0B8BC90012929D, 0x92C8AE6B464FC96F },
+			{ 0x09CE6EBB40173744, 0xB77ADA0617E3BBCB }, { 0xCC420A6A101D0515, 0xE55990879DDCAABD },
+			{ 0x9FA946824A12232D, 0x8F57FA54C2A9EAB6 }, { 0x47939822DC96ABF9, 0xB32DF8E9F3546564 },
+			{ 0x59787E2B93BC56F7, 0xDFF9772470297EBD }, { 0x57EB4EDB3C55B65A, 0x8BFBEA76C619EF36 },
+			{ 0xEDE622920B6B23F1, 0xAEFAE51477A06B03 }, { 0xE95FAB368E45ECED, 0xDAB99E59958885C4 },
+			{ 0x11DBCB0218EBB414, 0x88B402F7FD75539B }, { 0xD652BDC29F26A119, 0xAAE103B5FCD2A881 },
+			{ 0x4BE76D3346F0495F, 0xD59944A37C0752A2 }, { 0x6F70A4400C562DDB, 0x857FCAE62D8493A5 },
+			{ 0xCB4CCD500F6BB952, 0xA6DFBD9FB8E5B88E }, { 0x7E2000A41346A7A7, 0xD097AD07A71F26B2 },
+			{ 0x8ED400668C0C28C8, 0x825ECC24C873782F }, { 0x728900802F0F32FA, 0xA2F67F2DFA90563B },
+			{ 0x4F2B40A03AD2FFB9, 0xCBB41EF979346BCA }, { 0xE2F610C84987BFA8, 0xFEA126B7D78186BC },
+			{ 0x0DD9CA7D2DF4D7C9, 0x9F24B832E6B0F436 }, { 0x91503D1C79720DBB, 0xC6EDE63FA05D3143 },
+			{ 0x75A44C6397CE912A, 0xF8A95FCF88747D94 }, { 0xC986AFBE3EE11ABA, 0x9B69DBE1B548CE7C },
+			{ 0xFBE85BADCE996168, 0xC24452DA229B021B }, { 0xFAE27299423FB9C3, 0xF2D56790AB41C2A2 },
+			{ 0xDCCD879FC967D41A, 0x97C560BA6B0919A5 }, { 0x5400E987BBC1C920, 0xBDB6B8E905CB600F },
+			{ 0x290123E9AAB23B68, 0xED246723473E3813 }, { 0xF9A0B6720AAF6521, 0x9436C0760C86E30B },
+			{ 0xF808E40E8D5B3E69, 0xB94470938FA89BCE }, { 0xB60B1D1230B20E04, 0xE7958CB87392C2C2 },
+			{ 0xB1C6F22B5E6F48C2, 0x90BD77F3483BB9B9 }, { 0x1E38AEB6360B1AF3, 0xB4ECD5F01A4AA828 },
+			{ 0x25C6DA63C38DE1B0, 0xE2280B6C20DD5232 }, { 0x579C487E5A38AD0E, 0x8D590723948A535F },
+			{ 0x2D835A9DF0C6D851, 0xB0AF48EC79ACE837 }, { 0xF8E431456CF88E65, 0xDCDB1B2798182244 },
+			{ 0x1B8E9ECB641B58FF, 0x8A08F0F8BF0F156B }, { 0xE272467E3D222F3F, 0xAC8B2D36EED2DAC5 },
+			{ 0x5B0ED81DCC6ABB0F, 0xD7ADF884AA879177 }, { 0x98E947129FC2B4E9, 0x86CCBB52EA94BAEA },
+			{ 0x3F2398D747B36224, 0xA87FEA27A539E9A5 }, { 0x8EEC7F0D19A03AAD, 0xD29FE4B18E88640E },
+			{ 0x1953CF68300424AC, 0x83A3EEEEF9153E89 }, { 0x5FA8C3423C052DD7, 0xA48CEAAAB75A8E2B },
+			{ 0x3792F412CB06794D, 0xCDB02555653131B6 }, { 0xE2BBD88BBEE40BD0, 0x808E17555F3EBF11 },
+			{ 0x5B6ACEAEAE9D0EC4, 0xA0B19D2AB70E6ED6 }, { 0xF245825A5A445275, 0xC8DE047564D20A8B },
+			{ 0xEED6E2F0F0D56712, 0xFB158592BE068D2E }, { 0x55464DD69685606B, 0x9CED737BB6C4183D },
+			{ 0xAA97E14C3C26B886, 0xC428D05AA4751E4C }, { 0xD53DD99F4B3066A8, 0xF53304714D9265DF },
+			{ 0xE546A8038EFE4029, 0x993FE2C6D07B7FAB }, { 0xDE98520472BDD033, 0xBF8FDB78849A5F96 },
+			{ 0x963E66858F6D4440, 0xEF73D256A5C0F77C }, { 0xDDE7001379A44AA8, 0x95A8637627989AAD },
+			{ 0x5560C018580D5D52, 0xBB127C53B17EC159 }, { 0xAAB8F01E6E10B4A6, 0xE9D71B689DDE71AF },
+			{ 0xCAB3961304CA70E8, 0x9226712162AB070D }, { 0x3D607B97C5FD0D22, 0xB6B00D69BB55C8D1 },
+			{ 0x8CB89A7DB77C506A, 0xE45C10C42A2B3B05 }, { 0x77F3608E92ADB242, 0x8EB98A7A9A5B04E3 },
+			{ 0x55F038B237591ED3, 0xB267ED1940F1C61C }, { 0x6B6C46DEC52F6688, 0xDF01E85F912E37A3 },
+			{ 0x2323AC4B3B3DA015, 0x8B61313BBABCE2C6 }, { 0xABEC975E0A0D081A, 0xAE397D8AA96C1B77 },
+			{ 0x96E7BD358C904A21, 0xD9C7DCED53C72255 }, { 0x7E50D64177DA2E54, 0x881CEA14545C7575 },
+			{ 0xDDE50BD1D5D0B9E9, 0xAA242499697392D2 }, { 0x955E4EC64B44E864, 0xD4AD2DBFC3D07787 },
+			{ 0xBD5AF13BEF0B113E, 0x84EC3C97DA624AB4 }, { 0xECB1AD8AEACDD58E, 0xA6274BBDD0FADD61 },
+			{ 0x67DE18EDA5814AF2, 0xCFB11EAD453994BA }, { 0x80EACF948770CED7, 0x81CEB32C4B43FCF4 },
+			{ 0xA1258379A94D028D, 0xA2425FF75E14FC31 }, { 0x096EE45813A04330, 0xCAD2F7F5359A3B3E },
+			{ 0x8BCA9D6E188853FC, 0xFD87B5F28300CA0D }, { 0x775EA264CF55347D, 0x9E74D1B791E07E48 },
+			{ 0x95364AFE032A819D, 0xC612062576589DDA }, { 0x3A83DDBD83F52204, 0xF79687AED3EEC551 },
+			{ 0xC4926A9672793542, 0x9ABE14CD44753B52 }, { 0x75B7053C0F178293, 0xC16D9A0095928A27 },
+			{ 0x5324C68B12DD6338, 0xF1C90080BAF72CB1 }, { 0xD3F6FC16EBCA5E03, 0x971DA05074DA7BEE },
+			{ 0x88F4BB1CA6BCF584, 0xBCE5086492111AEA }, { 0x2B31E9E3D06C32E5, 0xEC1E4A7DB69561A5 },
+			{ 0x3AFF322E62439FCF, 0x9392EE8E921D5D07 }, { 0x09BEFEB9FAD487C2, 0xB877AA3236A4B449 },
+			{ 0x4C2EBE687989A9B3, 0xE69594BEC44DE15B }, { 0x0F9D37014BF60A10, 0x901D7CF73AB0ACD9 },
+			{ 0x538484C19EF38C94, 0xB424DC35095CD80F }, { 0x2865A5F206B06FB9, 0xE12E13424BB40E13 },
+			{ 0xF93F87B7442E45D3, 0x8CBCCC096F5088CB }, { 0xF78F69A51539D748, 0xAFEBFF0BCB24AAFE },
+			{ 0xB573440E5A884D1B, 0xDBE6FECEBDEDD5BE }, { 0x31680A88F8953030, 0x89705F4136B4A597 },
+			{ 0xFDC20D2B36BA7C3D, 0xABCC77118461CEFC }, { 0x3D32907604691B4C, 0xD6BF94D5E57A42BC },
+			{ 0xA63F9A49C2C1B10F, 0x8637BD05AF6C69B5 }, { 0x0FCF80DC33721D53, 0xA7C5AC471B478423 },
+			{ 0xD3C36113404EA4A8, 0xD1B71758E219652B }, { 0x645A1CAC083126E9, 0x83126E978D4FDF3B },
+			{ 0x3D70A3D70A3D70A3, 0xA3D70A3D70A3D70A }, { 0xCCCCCCCCCCCCCCCC, 0xCCCCCCCCCCCCCCCC },
+			{ 0x0000000000000000, 0x8000000000000000 }, { 0x0000000000000000, 0xA000000000000000 },
+			{ 0x0000000000000000, 0xC800000000000000 }, { 0x0000000000000000, 0xFA00000000000000 },
+			{ 0x0000000000000000, 0x9C40000000000000 }, { 0x0000000000000000, 0xC350000000000000 },
+			{ 0x0000000000000000, 0xF424000000000000 }, { 0x0000000000000000, 0x9896800000000000 },
+			{ 0x0000000000000000, 0xBEBC200000000000 }, { 0x0000000000000000, 0xEE6B280000000000 },
+			{ 0x0000000000000000, 0x9502F90000000000 }, { 0x0000000000000000, 0xBA43B74000000000 },
+			{ 0x0000000000000000, 0xE8D4A51000000000 }, { 0x0000000000000000, 0x9184E72A00000000 },
+			{ 0x0000000000000000, 0xB5E620F480000000 }, { 0x0000000000000000, 0xE35FA931A0000000 },
+			{ 0x0000000000000000, 0x8E1BC9BF04000000 }, { 0x0000000000000000, 0xB1A2BC2EC5000000 },
+			{ 0x0000000000000000, 0xDE0B6B3A76400000 }, { 0x0000000000000000, 0x8AC7230489E80000 },
+			{ 0x0000000000000000, 0xAD78EBC5AC620000 }, { 0x0000000000000000, 0xD8D726B7177A8000 },
+			{ 0x0000000000000000, 0x878678326EAC9000 }, { 0x0000000000000000, 0xA968163F0A57B400 },
+			{ 0x0000000000000000, 0xD3C21BCECCEDA100 }, { 0x0000000000000000, 0x84595161401484A0 },
+			{ 0x0000000000000000, 0xA56FA5B99019A5C8 }, { 0x0000000000000000, 0xCECB8F27F4200F3A },
+			{ 0x4000000000000000, 0x813F3978F8940984 }, { 0x5000000000000000, 0xA18F07D736B90BE5 },
+			{ 0xA400000000000000, 0xC9F2C9CD04674EDE }, { 0x4D00000000000000, 0xFC6F7C4045812296 },
+			{ 0xF020000000000000, 0x9DC5ADA82B70B59D }, { 0x6C28000000000000, 0xC5371912364CE305 },
+			{ 0xC732000000000000, 0xF684DF56C3E01BC6 }, { 0x3C7F400000000000, 0x9A130B963A6C115C },
+			{ 0x4B9F100000000000, 0xC097CE7BC90715B3 }, { 0x1E86D40000000000, 0xF0BDC21ABB48DB20 },
+			{ 0x1314448000000000, 0x96769950B50D88F4 }, { 0x17D955A000000000, 0xBC143FA4E250EB31 },
+			{ 0x5DCFAB0800000000, 0xEB194F8E1AE525FD }, { 0x5AA1CAE500000000, 0x92EFD1B8D0CF37BE },
+			{ 0xF14A3D9E40000000, 0xB7ABC627050305AD }, { 0x6D9CCD05D0000000, 0xE596B7B0C643C719 },
+			{ 0xE4820023A2000000, 0x8F7E32CE7BEA5C6F }, { 0xDDA2802C8A800000, 0xB35DBF821AE4F38B },
+			{ 0xD50B2037AD200000, 0xE0352F62A19E306E }, { 0x4526F422CC340000, 0x8C213D9DA502DE45 },
+			{ 0x9670B12B7F410000, 0xAF298D050E4395D6 }, { 0x3C0CDD765F114000, 0xDAF3F04651D47B4C },
+			{ 0xA5880A69FB6AC800, 0x88D8762BF324CD0F }, { 0x8EEA0D047A457A00, 0xAB0E93B6EFEE0053 },
+			{ 0x72A4904598D6D880, 0xD5D238A4ABE98068 }, { 0x47A6DA2B7F864750, 0x85A36366EB71F041 },
+			{ 0x999090B65F67D924, 0xA70C3C40A64E6C51 }, { 0xFFF4B4E3F741CF6D, 0xD0CF4B50CFE20765 },
+			{ 0xBFF8F10E7A8921A4, 0x82818F1281ED449F }, { 0xAFF72D52192B6A0D, 0xA321F2D7226895C7 },
+			{ 0x9BF4F8A69F764490, 0xCBEA6F8CEB02BB39 }, { 0x02F236D04753D5B4, 0xFEE50B7025C36A08 },
+			{ 0x01D762422C946590, 0x9F4F2726179A2245 }, { 0x424D3AD2B7B97EF5, 0xC722F0EF9D80AAD6 },
+			{ 0xD2E0898765A7DEB2, 0xF8EBAD2B84E0D58B }, { 0x63CC55F49F88EB2F, 0x9B934C3B330C8577 },
+			{ 0x3CBF6B71C76B25FB, 0xC2781F49FFCFA6D5 }, { 0x8BEF464E3945EF7A, 0xF316271C7FC3908A },
+			{ 0x97758BF0E3CBB5AC, 0x97EDD871CFDA3A56 }, { 0x3D52EEED1CBEA317, 0xBDE94E8E43D0C8EC },
+			{ 0x4CA7AAA863EE4BDD, 0xED63A231D4C4FB27 }, { 0x8FE8CAA93E74EF6A, 0x945E455F24FB1CF8 },
+			{ 0xB3E2FD538E122B44, 0xB975D6B6EE39E436 }, { 0x60DBBCA87196B616, 0xE7D34C64A9C85D44 },
+			{ 0xBC8955E946FE31CD, 0x90E40FBEEA1D3A4A }, { 0x6BABAB6398BDBE41, 0xB51D13AEA4A488DD },
+			{ 0xC696963C7EED2DD1, 0xE264589A4DCDAB14 }, { 0xFC1E1DE5CF543CA2, 0x8D7EB76070A08AEC },
+			{ 0x3B25A55F43294BCB, 0xB0DE65388CC8ADA8 }, { 0x49EF0EB713F39EBE, 0xDD15FE86AFFAD912 },
+			{ 0x6E3569326C784337, 0x8A2DBF142DFCC7AB }, { 0x49C2C37F07965404, 0xACB92ED9397BF996 },
+			{ 0xDC33745EC97BE906, 0xD7E77A8F87DAF7FB }, { 0x69A028BB3DED71A3, 0x86F0AC99B4E8DAFD },
+			{ 0xC40832EA0D68CE0C, 0xA8ACD7C0222311BC }, { 0xF50A3FA490C30190, 0xD2D80DB02AABD62B },
+			{ 0x792667C6DA79E0FA, 0x83C7088E1AAB65DB }, { 0x577001B891185938, 0xA4B8CAB1A1563F52 },
+			{ 0xED4C0226B55E6F86, 0xCDE6FD5E09ABCF26 }, { 0x544F8158315B05B4, 0x80B05E5AC60B6178 },
+			{ 0x696361AE3DB1C721, 0xA0DC75F1778E39D6 }, { 0x03BC3A19CD1E38E9, 0xC913936DD571C84C },
+			{ 0x04AB48A04065C723, 0xFB5878494ACE3A5F }, { 0x62EB0D64283F9C76, 0x9D174B2DCEC0E47B },
+			{ 0x3BA5D0BD324F8394, 0xC45D1DF942711D9A }, { 0xCA8F44EC7EE36479, 0xF5746577930D6500 },
+			{ 0x7E998B13CF4E1ECB, 0x9968BF6ABBE85F20 }, { 0x9E3FEDD8C321A67E, 0xBFC2EF456AE276E8 },
+			{ 0xC5CFE94EF3EA101E, 0xEFB3AB16C59B14A2 }, { 0xBBA1F1D158724A12, 0x95D04AEE3B80ECE5 },
+			{ 0x2A8A6E45AE8EDC97, 0xBB445DA9CA61281F }, { 0xF52D09D71A3293BD, 0xEA1575143CF97226 },
+			{ 0x593C2626705F9C56, 0x924D692CA61BE758 }, { 0x6F8B2FB00C77836C, 0xB6E0C377CFA2E12E },
+			{ 0x0B6DFB9C0F956447, 0xE498F455C38B997A }, { 0x4724BD4189BD5EAC, 0x8EDF98B59A373FEC },
+			{ 0x58EDEC91EC2CB657, 0xB2977EE300C50FE7 }, { 0x2F2967B66737E3ED, 0xDF3D5E9BC0F653E1 },
+			{ 0xBD79E0D20082EE74, 0x8B865B215899F46C }, { 0xECD8590680A3AA11, 0xAE67F1E9AEC07187 },
+			{ 0xE80E6F4820CC9495, 0xDA01EE641A708DE9 }, { 0x3109058D147FDCDD, 0x884134FE908658B2 },
+			{ 0xBD4B46F0599FD415, 0xAA51823E34A7EEDE }, { 0x6C9E18AC7007C91A, 0xD4E5E2CDC1D1EA96 },
+			{ 0x03E2CF6BC604DDB0, 0x850FADC09923329E }, { 0x84DB8346B786151C, 0xA6539930BF6BFF45 },
+			{ 0xE612641865679A63, 0xCFE87F7CEF46FF16 }, { 0x4FCB7E8F3F60C07E, 0x81F14FAE158C5F6E },
+			{ 0xE3BE5E330F38F09D, 0xA26DA3999AEF7749 }, { 0x5CADF5BFD3072CC5, 0xCB090C8001AB551C },
+			{ 0x73D9732FC7C8F7F6, 0xFDCB4FA002162A63 }, { 0x2867E7FDDCDD9AFA, 0x9E9F11C4014DDA7E },
+			{ 0xB281E1FD541501B8, 0xC646D63501A1511D }, { 0x1F225A7CA91A4226, 0xF7D88BC24209A565 },
+			{ 0x3375788DE9B06958, 0x9AE757596946075F }, { 0x0052D6B1641C83AE, 0xC1A12D2FC3978937 },
+			{ 0xC0678C5DBD23A49A, 0xF209787BB47D6B84 }, { 0xF840B7BA963646E0, 0x9745EB4D50CE6332 },
+			{ 0xB650E5A93BC3D898, 0xBD176620A501FBFF }, { 0xA3E51F138AB4CEBE, 0xEC5D3FA8CE427AFF },
+			{ 0xC66F336C36B10137, 0x93BA47C980E98CDF }, { 0xB80B0047445D4184, 0xB8A8D9BBE123F017 },
+			{ 0xA60DC059157491E5, 0xE6D3102AD96CEC1D }, { 0x87C89837AD68DB2F, 0x9043EA1AC7E41392 },
+			{ 0x29BABE4598C311FB, 0xB454E4A179DD1877 }, { 0xF4296DD6FEF3D67A, 0xE16A1DC9D8545E94 },
+			{ 0x1899E4A65F58660C, 0x8CE2529E2734BB1D }, { 0x5EC05DCFF72E7F8F, 0xB01AE745B101E9E4 },
+			{ 0x76707543F4FA1F73, 0xDC21A1171D42645D }, { 0x6A06494A791C53A8, 0x899504AE72497EBA },
+			{ 0x0487DB9D17636892, 0xABFA45DA0EDBDE69 }, { 0x45A9D2845D3C42B6, 0xD6F8D7509292D603 },
+			{ 0x0B8A2392BA45A9B2, 0x865B86925B9BC5C2 }, { 0x8E6CAC7768D7141E, 0xA7F26836F282B732 },
+			{ 0x3207D795430CD926, 0xD1EF0244AF2364FF }, { 0x7F44E6BD49E807B8, 0x8335616AED761F1F },
+			{ 0x5F16206C9C6209A6, 0xA402B9C5A8D3A6E7 }, { 0x36DBA887C37A8C0F, 0xCD036837130890A1 },
+			{ 0xC2494954DA2C9789, 0x802221226BE55A64 }, { 0xF2DB9BAA10B7BD6C, 0xA02AA96B06DEB0FD },
+			{ 0x6F92829494E5ACC7, 0xC83553C5C8965D3D }, { 0xCB772339BA1F17F9, 0xFA42A8B73ABBF48C },
+			{ 0xFF2A760414536EFB, 0x9C69A97284B578D7 }, { 0xFEF5138519684ABA, 0xC38413CF25E2D70D },
+			{ 0x7EB258665FC25D69, 0xF46518C2EF5B8CD1 }, { 0xEF2F773FFBD97A61, 0x98BF2F79D5993802 },
+			{ 0xAAFB550FFACFD8FA, 0xBEEEFB584AFF8603 }, { 0x95BA2A53F983CF38, 0xEEAABA2E5DBF6784 },
+			{ 0xDD945A747BF26183, 0x952AB45CFA97A0B2 }, { 0x94F971119AEEF9E4, 0xBA756174393D88DF },
+			{ 0x7A37CD5601AAB85D, 0xE912B9D1478CEB17 }, { 0xAC62E055C10AB33A, 0x91ABB422CCB812EE },
+			{ 0x577B986B314D6009, 0xB616A12B7FE617AA }, { 0xED5A7E85FDA0B80B, 0xE39C49765FDF9D94 },
+			{ 0x14588F13BE847307, 0x8E41ADE9FBEBC27D }, { 0x596EB2D8AE258FC8, 0xB1D219647AE6B31C },
+			{ 0x6FCA5F8ED9AEF3BB, 0xDE469FBD99A05FE3 }, { 0x25DE7BB9480D5854, 0x8AEC23D680043BEE },
+			{ 0xAF561AA79A10AE6A, 0xADA72CCC20054AE9 }, { 0x1B2BA1518094DA04, 0xD910F7FF28069DA4 },
+			{ 0x90FB44D2F05D0842, 0x87AA9AFF79042286 }, { 0x353A1607AC744A53, 0xA99541BF57452B28 },
+			{ 0x42889B8997915CE8, 0xD3FA922F2D1675F2 }, { 0x69956135FEBADA11, 0x847C9B5D7C2E09B7 },
+			{ 0x43FAB9837E699095, 0xA59BC234DB398C25 }, { 0x94F967E45E03F4BB, 0xCF02B2C21207EF2E },
+			{ 0x1D1BE0EEBAC278F5, 0x8161AFB94B44F57D }, { 0x6462D92A69731732, 0xA1BA1BA79E1632DC },
+			{ 0x7D7B8F7503CFDCFE, 0xCA28A291859BBF93 }, { 0x5CDA735244C3D43E, 0xFCB2CB35E702AF78 },
+			{ 0x3A0888136AFA64A7, 0x9DEFBF01B061ADAB }, { 0x088AAA1845B8FDD0, 0xC56BAEC21C7A1916 },
+			{ 0x8AAD549E57273D45, 0xF6C69A72A3989F5B }, { 0x36AC54E2F678864B, 0x9A3C2087A63F6399 },
+			{ 0x84576A1BB416A7DD, 0xC0CB28A98FCF3C7F }, { 0x656D44A2A11C51D5, 0xF0FDF2D3F3C30B9F },
+			{ 0x9F644AE5A4B1B325, 0x969EB7C47859E743 }, { 0x873D5D9F0DDE1FEE, 0xBC4665B596706114 },
+			{ 0xA90CB506D155A7EA, 0xEB57FF22FC0C7959 }, { 0x09A7F12442D588F2, 0x9316FF75DD87CBD8 },
+			{ 0x0C11ED6D538AEB2F, 0xB7DCBF5354E9BECE }, { 0x8F1668C8A86DA5FA, 0xE5D3EF282A242E81 },
+			{ 0xF96E017D694487BC, 0x8FA475791A569D10 }, { 0x37C981DCC395A9AC, 0xB38D92D760EC4455 },
+			{ 0x85BBE253F47B1417, 0xE070F78D3927556A }, { 0x93956D7478CCEC8E, 0x8C469AB843B89562 },
+			{ 0x387AC8D1970027B2, 0xAF58416654A6BABB }, { 0x06997B05FCC0319E, 0xDB2E51BFE9D0696A },
+			{ 0x441FECE3BDF81F03, 0x88FCF317F22241E2 }, { 0xD527E81CAD7626C3, 0xAB3C2FDDEEAAD25A },
+			{ 0x8A71E223D8D3B074, 0xD60B3BD56A5586F1 }, { 0xF6872D5667844E49, 0x85C7056562757456 },
+			{ 0xB428F8AC016561DB, 0xA738C6BEBB12D16C }, { 0xE13336D701BEBA52, 0xD106F86E69D785C7 },
+			{ 0xECC0024661173473, 0x82A45B450226B39C }, { 0x27F002D7F95D0190, 0xA34D721642B06084 },
+			{ 0x31EC038DF7B441F4, 0xCC20CE9BD35C78A5 }, { 0x7E67047175A15271, 0xFF290242C83396CE },
+			{ 0x0F0062C6E984D386, 0x9F79A169BD203E41 }, { 0x52C07B78A3E60868, 0xC75809C42C684DD1 },
+			{ 0xA7709A56CCDF8A82, 0xF92E0C3537826145 }, { 0x88A66076400BB691, 0x9BBCC7A142B17CCB },
+			{ 0x6ACFF893D00EA435, 0xC2ABF989935DDBFE }, { 0x0583F6B8C4124D43, 0xF356F7EBF83552FE },
+			{ 0xC3727A337A8B704A, 0x98165AF37B2153DE }, { 0x744F18C0592E4C5C, 0xBE1BF1B059E9A8D6 },
+			{ 0x1162DEF06F79DF73, 0xEDA2EE1C7064130C }, { 0x8ADDCB5645AC2BA8, 0x9485D4D1C63E8BE7 },
+			{ 0x6D953E2BD7173692, 0xB9A74A0637CE2EE1 }, { 0xC8FA8DB6CCDD0437, 0xE8111C87C5C1BA99 },
+			{ 0x1D9C9892400A22A2, 0x910AB1D4DB9914A0 }, { 0x2503BEB6D00CAB4B, 0xB54D5E4A127F59C8 },
+			{ 0x2E44AE64840FD61D, 0xE2A0B5DC971F303A }, { 0x5CEAECFED289E5D2, 0x8DA471A9DE737E24 },
+			{ 0x7425A83E872C5F47, 0xB10D8E1456105DAD }, { 0xD12F124E28F77719, 0xDD50F1996B947518 },
+			{ 0x82BD6B70D99AAA6F, 0x8A5296FFE33CC92F }, { 0x636CC64D1001550B, 0xACE73CBFDC0BFB7B },
+			{ 0x3C47F7E05401AA4E, 0xD8210BEFD30EFA5A }, { 0x65ACFAEC34810A71, 0x8714A775E3E95C78 },
+			{ 0x7F1839A741A14D0D, 0xA8D9D1535CE3B396 }, { 0x1EDE48111209A050, 0xD31045A8341CA07C },
+			{ 0x934AED0AAB460432, 0x83EA2B892091E44D }, { 0xF81DA84D5617853F, 0xA4E4B66B68B65D60 },
+			{ 0x36251260AB9D668E, 0xCE1DE40642E3F4B9 }, { 0xC1D72B7C6B426019, 0x80D2AE83E9CE78F3 },
+			{ 0xB24CF65B8612F81F, 0xA1075A24E4421730 }, { 0xDEE033F26797B627, 0xC94930AE1D529CFC },
+			{ 0x169840EF017DA3B1, 0xFB9B7CD9A4A7443C }, { 0x8E1F289560EE864E, 0x9D412E0806E88AA5 },
+			{ 0xF1A6F2BAB92A27E2, 0xC491798A08A2AD4E }, { 0xAE10AF696774B1DB, 0xF5B5D7EC8ACB58A2 },
+			{ 0xACCA6DA1E0A8EF29, 0x9991A6F3D6BF1765 }, { 0x17FD090A58D32AF3, 0xBFF610B0CC6EDD3F },
+			{ 0xDDFC4B4CEF07F5B0, 0xEFF394DCFF8A948E }, { 0x4ABDAF101564F98E, 0x95F83D0A1FB69CD9 },
+			{ 0x9D6D1AD41ABE37F1, 0xBB764C4CA7A4440F }, { 0x84C86189216DC5ED, 0xEA53DF5FD18D5513 },
+			{ 0x32FD3CF5B4E49BB4, 0x92746B9BE2F8552C }, { 0x3FBC8C33221DC2A1, 0xB7118682DBB66A77 },
+			{ 0x0FABAF3FEAA5334A, 0xE4D5E82392A40515 }, { 0x29CB4D87F2A7400E, 0x8F05B1163BA6832D },
+			{ 0x743E20E9EF511012, 0xB2C71D5BCA9023F8 }, { 0x914DA9246B255416, 0xDF78E4B2BD342CF6 },
+			{ 0x1AD089B6C2F7548E, 0x8BAB8EEFB6409C1A }, { 0xA184AC2473B529B1, 0xAE9672ABA3D0C320 },
+			{ 0xC9E5D72D90A2741E, 0xDA3C0F568CC4F3E8 }, { 0x7E2FA67C7A658892, 0x8865899617FB1871 },
+			{ 0xDDBB901B98FEEAB7, 0xAA7EEBFB9DF9DE8D }, { 0x552A74227F3EA565, 0xD51EA6FA85785631 },
+			{ 0xD53A88958F87275F, 0x8533285C936B35DE }, { 0x8A892ABAF368F137, 0xA67FF273B8460356 },
+			{ 0x2D2B7569B0432D85, 0xD01FEF10A657842C }, { 0x9C3B29620E29FC73, 0x8213F56A67F6B29B },
+			{ 0x8349F3BA91B47B8F, 0xA298F2C501F45F42 }, { 0x241C70A936219A73, 0xCB3F2F7642717713 },
+			{ 0xED238CD383AA0110, 0xFE0EFB53D30DD4D7 }, { 0xF4363804324A40AA, 0x9EC95D1463E8A506 },
+			{ 0xB143C6053EDCD0D5, 0xC67BB4597CE2CE48 }, { 0xDD94B7868E94050A, 0xF81AA16FDC1B81DA },
+			{ 0xCA7CF2B4191C8326, 0x9B10A4E5E9913128 }, { 0xFD1C2F611F63A3F0, 0xC1D4CE1F63F57D72 },
+			{ 0xBC633B39673C8CEC, 0xF24A01A73CF2DCCF }, { 0xD5BE0503E085D813, 0x976E41088617CA01 },
+			{ 0x4B2D8644D8A74E18, 0xBD49D14AA79DBC82 }, { 0xDDF8E7D60ED1219E, 0xEC9C459D51852BA2 },
+			{ 0xCABB90E5C942B503, 0x93E1AB8252F33B45 }, { 0x3D6A751F3B936243, 0xB8DA1662E7B00A17 },
+			{ 0x0CC512670A783AD4, 0xE7109BFBA19C0C9D }, { 0x27FB2B80668B24C5, 0x906A617D450187E2 },
+			{ 0xB1F9F660802DEDF6, 0xB484F9DC9641E9DA }, { 0x5E7873F8A0396973, 0xE1A63853BBD26451 },
+			{ 0xDB0B487B6423E1E8, 0x8D07E33455637EB2 }, { 0x91CE1A9A3D2CDA62, 0xB049DC016ABC5E5F },
+			{ 0x7641A140CC7810FB, 0xDC5C5301C56B75F7 }, { 0xA9E904C87FCB0A9D, 0x89B9B3E11B6329BA },
+			{ 0x546345FA9FBDCD44, 0xAC2820D9623BF429 }, { 0xA97C177947AD4095, 0xD732290FBACAF133 },
+			{ 0x49ED8EABCCCC485D, 0x867F59A9D4BED6C0 }, { 0x5C68F256BFFF5A74, 0xA81F301449EE8C70 },
+			{ 0x73832EEC6FFF3111, 0xD226FC195C6A2F8C }, { 0xC831FD53C5FF7EAB, 0x83585D8FD9C25DB7 },
+			{ 0xBA3E7CA8B77F5E55, 0xA42E74F3D032F525 }, { 0x28CE1BD2E55F35EB, 0xCD3A1230C43FB26F },
+			{ 0x7980D163CF5B81B3, 0x80444B5E7AA7CF85 }, { 0xD7E105BCC332621F, 0xA0555E361951C366 },
+			{ 0x8DD9472BF3FEFAA7, 0xC86AB5C39FA63440 }, { 0xB14F98F6F0FEB951, 0xFA856334878FC150 },
+			{ 0x6ED1BF9A569F33D3, 0x9C935E00D4B9D8D2 }, { 0x0A862F80EC4700C8, 0xC3B8358109E84F07 },
+			{ 0xCD27BB612758C0FA, 0xF4A642E14C6262C8 }, { 0x8038D51CB897789C, 0x98E7E9CCCFBD7DBD },
+			{ 0xE0470A63E6BD56C3, 0xBF21E44003ACDD2C }, { 0x1858CCFCE06CAC74, 0xEEEA5D5004981478 },
+			{ 0x0F37801E0C43EBC8, 0x95527A5202DF0CCB }, { 0xD30560258F54E6BA, 0xBAA718E68396CFFD },
+			{ 0x47C6B82EF32A2069, 0xE950DF20247C83FD }, { 0x4CDC331D57FA5441, 0x91D28B7416CDD27E },
+			{ 0xE0133FE4ADF8E952, 0xB6472E511C81471D }, { 0x58180FDDD97723A6, 0xE3D8F9E563A198E5 },
+			{ 0x570F09EAA7EA7648, 0x8E679C2F5E44FF8F }, { 0x2CD2CC6551E513DA, 0xB201833B35D63F73 },
+			{ 0xF8077F7EA65E58D1, 0xDE81E40A034BCF4F }, { 0xFB04AFAF27FAF782, 0x8B112E86420F6191 },
+			{ 0x79C5DB9AF1F9B563, 0xADD57A27D29339F6 }, { 0x18375281AE7822BC, 0xD94AD8B1C7380874 },
+			{ 0x8F2293910D0B15B5, 0x87CEC76F1C830548 }, { 0xB2EB3875504DDB22, 0xA9C2794AE3A3C69A },
+			{ 0x5FA60692A46151EB, 0xD433179D9C8CB841 }, { 0xDBC7C41BA6BCD333, 0x849FEEC281D7F328 },
+			{ 0x12B9B522906C0800, 0xA5C7EA73224DEFF3 }, { 0xD768226B34870A00, 0xCF39E50FEAE16BEF },
+			{ 0xE6A1158300D46640, 0x81842F29F2CCE375 }, { 0x60495AE3C1097FD0, 0xA1E53AF46F801C53 },
+			{ 0x385BB19CB14BDFC4, 0xCA5E89B18B602368 }, { 0x46729E03DD9ED7B5, 0xFCF62C1DEE382C42 },
+			{ 0x6C07A2C26A8346D1, 0x9E19DB92B4E31BA9 }, { 0xC7098B7305241885, 0xC5A05277621BE293 },
+			{ 0xB8CBEE4FC66D1EA7, 0xF70867153AA2DB38 }, { 0x737F74F1DC043328, 0x9A65406D44A5C903 },
+			{ 0x505F522E53053FF2, 0xC0FE908895CF3B44 }, { 0x647726B9E7C68FEF, 0xF13E34AABB430A15 },
+			{ 0x5ECA783430DC19F5, 0x96C6E0EAB509E64D }, { 0xB67D16413D132072, 0xBC789925624C5FE0 },
+			{ 0xE41C5BD18C57E88F, 0xEB96BF6EBADF77D8 }, { 0x8E91B962F7B6F159, 0x933E37A534CBAAE7 },
+			{ 0x723627BBB5A4ADB0, 0xB80DC58E81FE95A1 }, { 0xCEC3B1AAA30DD91C, 0xE61136F2227E3B09 },
+			{ 0x213A4F0AA5E8A7B1, 0x8FCAC257558EE4E6 }, { 0xA988E2CD4F62D19D, 0xB3BD72ED2AF29E1F },
+			{ 0x93EB1B80A33B8605, 0xE0ACCFA875AF45A7 }, { 0xBC72F130660533C3, 0x8C6C01C9498D8B88 },
+			{ 0xEB8FAD7C7F8680B4, 0xAF87023B9BF0EE6A }, { 0xA67398DB9F6820E1, 0xDB68C2CA82ED2A05 },
+			{ 0x88083F8943A1148C, 0x892179BE91D43A43 }, { 0x6A0A4F6B948959B0, 0xAB69D82E364948D4 },
+			{ 0x848CE34679ABB01C, 0xD6444E39C3DB9B09 }, { 0xF2D80E0C0C0B4E11, 0x85EAB0E41A6940E5 },
+			{ 0x6F8E118F0F0E2195, 0xA7655D1D2103911F }, { 0x4B7195F2D2D1A9FB, 0xD13EB46469447567 }
+		};
 
-	JsonValue::~JsonValue()
-	{
-		if (m_pName != NULL)
+		// Eisel-Lemire algorithm, fails on rare ambiguous cases and on subnormals
+		bool EiselLemire(uint64_t iMantissa, int64_t iExp10, bool bNeg, double& fOut)
 		{
-			m_pAllocator->FreeString(m_pName, m_pAllocator->pUserData);
-			m_pName = NULL;
-		}
-		Reset();
-	}
+			if (iExp10 < c_iPowersOfTen128Min || iExp10 > c_iPowersOfTen128Max)
+				return false;
 
-	void JsonValue::InitType(EType eType)
-	{
-		if (m_eType == E_TYPE_OBJECT || m_eType == E_TYPE_ARRAY || m_eType == E_TYPE_STRING)
-			Reset();
+			int iLeadingZeros = CountLeadingZeros(iMantissa);
+			iMantissa <<= iLeadingZeros;
+			uint64_t iExp2 = (uint64_t)(((217706 * iExp10) >> 16) + 64 + 1023) - (uint64_t)iLeadingZeros;
 
-		if (m_eType != eType)
-		{
-			m_eType = eType;
-			switch (eType)
+			const uint64_t* pPower = c_pPowersOfTen128[iExp10 - c_iPowersOfTen128Min];
+			uint64_t iHigh;
+			uint64_t iLow = Multiply128(iMantissa, pPower[1], iHigh);
+
+			// Wider approximation when the truncated product is not precise enough
+			if ((iHigh & 0x1FF) == 0x1FF && iLow + iMantissa < iMantissa)
 			{
-			case E_TYPE_OBJECT:
-			case E_TYPE_ARRAY:
-				m_oValue.Childs.m_pFirst = NULL;
-				m_oValue.Childs.m_pLast = NULL;
-				break;
-			case E_TYPE_STRING:
-				m_oValue.String = NULL;
-				break;
-			default:
-				break;
+				uint64_t iHigh2;
+				uint64_t iLow2 = Multiply128(iMantissa, pPower[0], iHigh2);
+				uint64_t iMergedHigh = iHigh;
+				uint64_t iMergedLow = iLow + iHigh2;
+				if (iMergedLow < iLow)
+					++iMergedHigh;
+				if ((iMergedHigh & 0x1FF) == 0x1FF && iMergedLow + 1 == 0 && iLow2 + iMantissa < iMantissa)
+					return false;
+				iHigh = iMergedHigh;
+				iLow = iMergedLow;
 			}
-		}
-	}
 
-	void JsonValue::Reset()
-	{
-		switch (m_eType)
-		{
-		case E_TYPE_OBJECT:
-		case E_TYPE_ARRAY:
-		{
-			JsonValue* pChild = m_oValue.Childs.m_pFirst;
-			while (pChild != NULL)
+			uint64_t iMsb = iHigh >> 63;
+			uint64_t iResultMantissa = iHigh >> (iMsb + 9);
+			iExp2 -= 1 ^ iMsb;
+
+			// Half-way ambiguity
+			if (iLow == 0 && (iHigh & 0x1FF) == 0 && (iResultMantissa & 3) == 1)
+				return false;
+
+			iResultMantissa += iResultMantissa & 1;
+			iResultMantissa >>= 1;
+			if ((iResultMantissa >> 53) > 0)
 			{
-				JsonValue* pTemp = pChild->m_pNext;
-				m_pAllocator->DeleteJsonValue(pChild, m_pAllocator->pUserData);
-				pChild = pTemp;
+				iResultMantissa >>= 1;
+				iExp2 += 1;
 			}
-			m_oValue.Childs.m_pFirst = NULL;
-			m_oValue.Childs.m_pLast = NULL;
-			break;
-		}
-		case E_TYPE_STRING:
-		{
-			m_pAllocator->FreeString(m_oValue.String, m_pAllocator->pUserData);
-			m_oValue.String = NULL;
-			break;
-		}
-		default:
-			break;
-		}
-		m_eType = E_TYPE_NULL;
-	}
 
-	JsonValue::EType JsonValue::GetType() const
-	{
-		return m_eType;
-	}
+			// Subnormal or infinity
+			if (iExp2 - 1 >= 0x7FF - 1)
+				return false;
 
-	void JsonValue::SetStringValue(const char* pString)
-	{
-		JsonStthmAssert(IsString());
-		m_pAllocator->FreeString(m_oValue.String, m_pAllocator->pUserData);
-		m_oValue.String = NULL;
-		if (NULL != pString)
-		{
-			size_t iLen  = 1 + strlen(pString);
-			char* pNewString = m_pAllocator->AllocString(iLen, m_pAllocator->pUserData);
-			memcpy(pNewString, pString, iLen);
-			m_oValue.String = pNewString;
+			uint64_t iBits = (iExp2 << 52) | (iResultMantissa & 0x000FFFFFFFFFFFFFULL);
+			if (bNeg)
+				iBits |= 0x8000000000000000ULL;
+			memcpy(&fOut, &iBits, sizeof(double));
+			return true;
 		}
-	}
 
-	int JsonValue::ReadString(const char* pJson)
-	{
-		if (pJson != NULL)
+		// Slow path, strtod with the decimal point of the current locale
+		double StrToDouble(const char* pBegin, const char* pEnd)
 		{
-			Reset();
-			const char* pEnd = pJson;
-			if (Parse(pEnd) == false)
-			{
-				int iLine = 1;
-				int iReturn = 1;
-				while (pJson != pEnd)
-				{
-					if (*pJson == '\n')
-						++iLine;
-					else if (*pJson == '\r')
-						++iReturn;
-					++pJson;
-				}
-				if (iReturn > iLine)
-					iLine = iReturn;
-				return iLine;
-			}
-			return 0;
+			char cDecimalPoint = localeconv()->decimal_point[0];
+			CharBuffer oNumber;
+			oNumber.Resize(pEnd - pBegin + 1);
+			char* pOut = oNumber.Data();
+			for (const char* pIn = pBegin; pIn != pEnd; ++pIn)
+				*pOut++ = (*pIn == '.') ? cDecimalPoint : *pIn;
+			*pOut = 0;
+			return strtod(oNumber.Data(), NULL);
 		}
-		return -1;
-	}
 
-	int JsonValue::ReadFile(const char* pFilename)
-	{
-		FILE* pFile = fopen(pFilename, "r");
-		if (NULL != pFile)
+		enum ENumberType
 		{
-			Reset();
+			E_NUMBER_INVALID,
+			E_NUMBER_INTEGER,
+			E_NUMBER_FLOAT
+		};
 
-			fseek(pFile, 0, SEEK_END);
-			long iSize = ftell(pFile);
-			fseek(pFile, 0, SEEK_SET);
+		// Parse a number in one scan, integers that don't fit in int64 are returned as float
+		ENumberType ParseNumber(const char*& pString, int64_t& iInteger, double& fFloat)
+		{
+			const char* pStart = pString;
+			const char* pCursor = pString;
 
-			char* pString = (char*)JsonStthmMalloc(iSize + 1);
-			if (pString == NULL)
+			bool bNeg = false;
+			if (*pCursor == '-')
 			{
-				fclose(pFile);
-				return -2;
+				++pCursor;
+				bNeg = true;
 			}
 
-			fread(pString, 1, iSize, pFile);
-			fclose(pFile);
-			pString[iSize] = 0;
-
-			int iLine = ReadString(pString);
+			if (IsDigit(*pCursor) == false)
+				return E_NUMBER_INVALID;
 
-			JsonStthmFree(pString);
-			return iLine;
-		}
-		return -1;
-	}
+			// Keep up to 19 significant digits, always fit in uint64
+			const int c_iMaxDigits = 19;
+			uint64_t iMantissa = 0;
+			int iDigits = 0;
+			int64_t iExp10 = 0;
+			bool bTruncated = false;
+			bool bFloat = false;
 
-	void JsonValue::Write(Internal::CharBuffer& sOutJson, size_t iIndent, bool bCompact) const
-	{
-		if (m_eType == E_TYPE_OBJECT)
-		{
-			Internal::CharBuffer sIndent(iIndent, '\t');
-			Internal::CharBuffer sIndent2(iIndent + 1, '\t');
-			sOutJson += '{';
-			JsonValue* pChild = m_oValue.Childs.m_pFirst;
-			bool bFirst = true;
-			while (pChild != NULL)
+			while (IsDigit(*pCursor))
 			{
-				if (bFirst == false)
+				uint64_t iDigit = (uint64_t)(*pCursor++ & 0xF);
+				if (iDigits < c_iMaxDigits)
 				{
-					sOutJson += ',';
+					iMantissa = iMantissa * 10 + iDigit;
+					if (iMantissa != 0)
+						++iDigits;
 				}
 				else
 				{
-					bFirst = false;
+					++iExp10;
+					bTruncated |= iDigit != 0;
 				}
+			}
 
-				if (bCompact == false)
+			if (*pCursor == '.')
+			{
+				++pCursor;
+				bFloat = true;
+				if (IsDigit(*pCursor) == false)
+					return E_NUMBER_INVALID;
+				while (IsDigit(*pCursor))
 				{
-					sOutJson += '\n';
-					sOutJson.PushRange(sIndent2.Data(), sIndent2.Size());
+					uint64_t iDigit = (uint64_t)(*pCursor++ & 0xF);
+					if (iDigits < c_iMaxDigits)
+					{
+						iMantissa = iMantissa * 10 + iDigit;
+						if (iMantissa != 0)
+							++iDigits;
+						--iExp10;
+					}
+					else
+					{
+						bTruncated |= iDigit != 0;
+					}
 				}
-
-				sOutJson += '\"';
-				WriteStringEscaped(sOutJson, pChild->m_pName);
-				sOutJson += '\"';
-				sOutJson += ':';
-				if (bCompact == false)
-					sOutJson += ' ';
-
-				pChild->Write(sOutJson, iIndent + 1, bCompact);
-				pChild = pChild->m_pNext;
 			}
 
-			if (bCompact == false)
+			if (*pCursor == 'e' || *pCursor == 'E')
 			{
-				sOutJson += '\n';
-				sOutJson.PushRange(sIndent.Data(), sIndent.Size());
-			}
+				++pCursor;
+				bFloat = true;
 
-			sOutJson += '}';
-		}
-		else if (m_eType == E_TYPE_ARRAY)
-		{
-			Internal::CharBuffer sIndent(iIndent, '\t');
-			Internal::CharBuffer sIndent2(iIndent + 1, '\t');
-			sOutJson += '[';
-			JsonValue* pChild = m_oValue.Childs.m_pFirst;
-			bool bFirst = true;
-			while (pChild != NULL)
+				bool bNegExp = false;
+				if (*pCursor == '+')
+				{
+					++pCursor;
+				}
+				else if (*pCursor == '-')
+				{
+					++pCursor;
+					bNegExp = true;
+				}
+
+				if (IsDigit(*pCursor) == false)
+					return E_NUMBER_INVALID;
+
+				int64_t iExpValue = 0;
+				while (IsDigit(*pCursor))
+				{
+					if (iExpValue < 0x10000000)
+						iExpValue = iExpValue * 10 + (*pCursor & 0xF);
+					++pCursor;
+				}
+				iExp10 += bNegExp ? -iExpValue : iExpValue;
+			}
+
+			pString = pCursor;
+
+			// "-0" is kept as a float to preserve its sign
+			if (bFloat == false && iExp10 == 0 && (bNeg == false || iMantissa != 0))
 			{
-				if (bFirst == false)
+				if (bNeg && iMantissa <= 0x8000000000000000ULL)
 				{
-					sOutJson += ',';
+					iInteger = (int64_t)(0 - iMantissa);
+					return E_NUMBER_INTEGER;
 				}
-				else
+				else if (bNeg == false && iMantissa <= 0x7FFFFFFFFFFFFFFFULL)
 				{
-					bFirst = false;
+					iInteger = (int64_t)iMantissa;
+					return E_NUMBER_INTEGER;
 				}
+			}
+
+			if (iMantissa == 0 || iExp10 < c_iPowersOfTen128Min - c_iMaxDigits)
+			{
+				fFloat = bNeg ? -0.0 : 0.0;
+				return E_NUMBER_FLOAT;
+			}
+
+			if (iExp10 > c_iPowersOfTen128Max)
+			{
+				fFloat = bNeg ? -c_fInfinity : c_fInfinity;
+				return E_NUMBER_FLOAT;
+			}
+
+			// Clinger fast path, both operands are exact doubles
+			if (bTruncated == false && iMantissa <= ((uint64_t)1 << 53) && iExp10 >= -22 && iExp10 <= 22)
+			{
+				double fValue = (double)iMantissa;
+				if (iExp10 < 0)
+					fValue /= c_pExactPowersOfTen[-iExp10];
+				else
+					fValue *= c_pExactPowersOfTen[iExp10];
+				fFloat = bNeg ? -fValue : fValue;
+				return E_NUMBER_FLOAT;
+			}
 
-				if (bCompact == false)
+			double fValue;
+			if (EiselLemire(iMantissa, iExp10, bNeg, fValue))
+			{
+				// With dropped digits the real value is between iMantissa and iMantissa + 1
+				double fUpper;
+				if (bTruncated == false || (EiselLemire(iMantissa + 1, iExp10, bNeg, fUpper) && fUpper == fValue))
 				{
-					sOutJson += '\n';
-					sOutJson.PushRange(sIndent2.Data(), sIndent2.Size());
+					fFloat = fValue;
+					return E_NUMBER_FLOAT;
 				}
+			}
+
+			fFloat = StrToDouble(pStart, pCursor);
+			return E_NUMBER_FLOAT;
+		}
 
-				pChild->Write(sOutJson, iIndent + 1, bCompact);
-				pChild = pChild->m_pNext;
+		const char c_pDigitPairs[] =
+			"00010203040506070809"
+			"10111213141516171819"
+			"20212223242526272829"
+			"30313233343536373839"
+			"40414243444546474849"
+			"50515253545556575859"
+			"60616263646566676869"
+			"70717273747576777879"
+			"80818283848586878889"
+			"90919293949596979899";
+
+		// Write up to 20 digits, returns end of written chars
+		char* WriteUInt64(char* pOut, uint64_t iValue)
+		{
+			char pTemp[20];
+			char* pCursor = pTemp + sizeof(pTemp);
+			while (iValue >= 100)
+			{
+				unsigned iPair = (unsigned)(iValue % 100);
+				iValue /= 100;
+				pCursor -= 2;
+				memcpy(pCursor, c_pDigitPairs + iPair * 2, 2);
+			}
+			if (iValue < 10)
+			{
+				*--pCursor = (char)('0' + iValue);
 			}
-			if (bCompact == false)
+			else
 			{
-				sOutJson += '\n';
-				sOutJson.PushRange(sIndent.Data(), sIndent.Size());
+				pCursor -= 2;
+				memcpy(pCursor, c_pDigitPairs + iValue * 2, 2);
 			}
-			sOutJson += ']';
+			size_t iLen = pTemp + sizeof(pTemp) - pCursor;
+			memcpy(pOut, pCursor, iLen);
+			return pOut + iLen;
 		}
-		else if (m_eType == E_TYPE_STRING)
+
+		// Write up to 21 chars
+		char* WriteInt64(char* pOut, int64_t iValue)
+		{
+			uint64_t iAbs = (uint64_t)iValue;
+			if (iValue < 0)
+			{
+				*pOut++ = '-';
+				iAbs = 0 - iAbs;
+			}
+			return WriteUInt64(pOut, iAbs);
+		}
+
+		// Grisu2 shortest round-trip double formatting (Florian Loitsch)
+		struct DiyFp
+		{
+			DiyFp() {}
+			DiyFp(uint64_t iF, int iE) : f(iF), e(iE) {}
+
+			DiyFp operator-(const DiyFp& oRight) const
+			{
+				return DiyFp(f - oRight.f, e);
+			}
+
+			DiyFp operator*(const DiyFp& oRight) const
+			{
+				uint64_t iHigh;
+				uint64_t iLow = Multiply128(f, oRight.f, iHigh);
+				if (iLow & ((uint64_t)1 << 63)) // Rounding
+					++iHigh;
+				return DiyFp(iHigh, e + oRight.e + 64);
+			}
+
+			DiyFp Normalize() const
+			{
+				int iShift = CountLeadingZeros(f);
+				return DiyFp(f << iShift, e - iShift);
+			}
+
+			uint64_t	f;
+			int			e;
+		};
+
+		const uint64_t c_iDoubleHiddenBit = 0x0010000000000000ULL;
+
+		void GrisuRound(char* pBuffer, int iLength, uint64_t iDelta, uint64_t iRest, uint64_t iTenKappa, uint64_t iDistance)
 		{
-			sOutJson += '\"';
-			WriteStringEscaped(sOutJson, m_oValue.String);
-			sOutJson += '\"';
+			while (iRest < iDistance && iDelta - iRest >= iTenKappa &&
+				(iRest + iTenKappa < iDistance || iDistance - iRest > iRest + iTenKappa - iDistance))
+			{
+				pBuffer[iLength - 1]--;
+				iRest += iTenKappa;
+			}
 		}
-		else if (m_eType == E_TYPE_BOOLEAN)
+
+		void GrisuDigitGen(const DiyFp& oW, const DiyFp& oMp, uint64_t iDelta, char* pBuffer, int& iLength, int& iK)
 		{
-			if (m_oValue.Boolean)
+			static const uint32_t c_pPow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+			const DiyFp oOne((uint64_t)1 << -oMp.e, oMp.e);
+			const uint64_t iDistance = (oMp - oW).f;
+			uint32_t iP1 = (uint32_t)(oMp.f >> -oOne.e);
+			uint64_t iP2 = oMp.f & (oOne.f - 1);
+
+			int iKappa = 1;
+			while (iKappa < 10 && iP1 >= c_pPow10[iKappa])
+				++iKappa;
+
+			iLength = 0;
+			while (iKappa > 0)
+			{
+				uint32_t iDiv = c_pPow10[iKappa - 1];
+				uint32_t iDigit = iP1 / iDiv;
+				iP1 %= iDiv;
+				if (iDigit != 0 || iLength != 0)
+					pBuffer[iLength++] = (char)('0' + iDigit);
+				--iKappa;
+				uint64_t iRest = ((uint64_t)iP1 << -oOne.e) + iP2;
+				if (iRest <= iDelta)
+				{
+					iK += iKappa;
+					GrisuRound(pBuffer, iLength, iDelta, iRest, (uint64_t)c_pPow10[iKappa] << -oOne.e, iDistance);
+					return;
+				}
+			}
+
+			uint64_t iUnit = 1;
+			for (;;)
 			{
-				sOutJson.PushRange("true", 4);
+				iP2 *= 10;
+				iDelta *= 10;
+				iUnit *= 10;
+				char iDigit = (char)(iP2 >> -oOne.e);
+				if (iDigit != 0 || iLength != 0)
+					pBuffer[iLength++] = (char)('0' + iDigit);
+				iP2 &= oOne.f - 1;
+				--iKappa;
+				if (iP2 < iDelta)
+				{
+					iK += iKappa;
+					GrisuRound(pBuffer, iLength, iDelta, iP2, oOne.f, iDistance * iUnit);
+					return;
+				}
 			}
+		}
+
+		// Digits of a positive finite double, value is pBuffer * 10^iK
+		void Grisu2(double fValue, char* pBuffer, int& iLength, int& iK)
+		{
+			uint64_t iBits;
+			memcpy(&iBits, &fValue, sizeof(double));
+			int iBiasedExp = (int)((iBits >> 52) & 0x7FF);
+			uint64_t iSignificand = iBits & (c_iDoubleHiddenBit - 1);
+
+			DiyFp oV;
+			if (iBiasedExp != 0)
+				oV = DiyFp(iSignificand + c_iDoubleHiddenBit, iBiasedExp - 1075);
 			else
+				oV = DiyFp(iSignificand, -1074);
+
+			// Boundaries m+ and m- normalized on the same exponent
+			DiyFp oPlus((oV.f << 1) + 1, oV.e - 1);
+			while ((oPlus.f & (c_iDoubleHiddenBit << 1)) == 0)
 			{
-				sOutJson.PushRange("false", 5);
+				oPlus.f <<= 1;
+				oPlus.e--;
 			}
+			oPlus.f <<= 10;
+			oPlus.e -= 10;
+			DiyFp oMinus = (oV.f == c_iDoubleHiddenBit) ? DiyFp((oV.f << 2) - 1, oV.e - 2) : DiyFp((oV.f << 1) - 1, oV.e - 1);
+			oMinus.f <<= oMinus.e - oPlus.e;
+			oMinus.e = oPlus.e;
+
+			// Cached power 10^-k with k multiple of 8, from the parser 128 bits table
+			double fK = (-61 - oPlus.e) * 0.30102999566398114 + 347;
+			int iIndexK = (int)fK;
+			if (fK - iIndexK > 0.0)
+				++iIndexK;
+			int iExp10 = c_iPowersOfTen128Min + (((iIndexK >> 3) + 1) << 3);
+			const uint64_t* pPower = c_pPowersOfTen128[iExp10 - c_iPowersOfTen128Min];
+			DiyFp oCached(pPower[1] + (pPower[0] >> 63), (int)((217706 * iExp10) >> 16) - 63);
+			iK = -iExp10;
+
+			DiyFp oW = oV.Normalize() * oCached;
+			DiyFp oWPlus = oPlus * oCached;
+			DiyFp oWMinus = oMinus * oCached;
+			++oWMinus.f;
+			--oWPlus.f;
+			GrisuDigitGen(oW, oWPlus, oWPlus.f - oWMinus.f, pBuffer, iLength, iK);
 		}
-		else if (m_eType == E_TYPE_INTEGER)
+
+		char* WriteExponent(char* pOut, int iExp)
 		{
-			char sBuffer[256];
-			snprintf(sBuffer, 256, "%jd", m_oValue.Integer);
-			size_t iLen = strlen(sBuffer);
-			sOutJson.PushRange(sBuffer, iLen);
+			if (iExp < 0)
+			{
+				*pOut++ = '-';
+				iExp = -iExp;
+			}
+			if (iExp >= 100)
+			{
+				*pOut++ = (char)('0' + iExp / 100);
+				iExp %= 100;
+				memcpy(pOut, c_pDigitPairs + iExp * 2, 2);
+				return pOut + 2;
+			}
+			if (iExp >= 10)
+			{
+				memcpy(pOut, c_pDigitPairs + iExp * 2, 2);
+				return pOut + 2;
+			}
+			*pOut++ = (char)('0' + iExp);
+			return pOut;
 		}
-		else if (m_eType == E_TYPE_FLOAT)
+
+		// Write shortest representation of a finite double that reads back to the same value,
+		// always with a fraction or an exponent to keep it a float, up to 25 chars
+		char* WriteDouble(char* pOut, double fValue)
+		{
+			if (fValue == 0.0)
+			{
+				if (1.0 / fValue < 0.0)
+					*pOut++ = '-';
+				memcpy(pOut, "0.0", 3);
+				return pOut + 3;
+			}
+
+			if (fValue < 0.0)
+			{
+				*pOut++ = '-';
+				fValue = -fValue;
+			}
+
+			int iLength, iK;
+			Grisu2(fValue, pOut, iLength, iK);
+
+			const int iPointPos = iLength + iK; // 10^(iPointPos - 1) <= value < 10^iPointPos
+			if (iK >= 0 && iPointPos <= 21)
+			{
+				// 1234e7 -> 12340000000.0
+				for (int i = iLength; i < iPointPos; ++i)
+					pOut[i] = '0';
+				pOut[iPointPos] = '.';
+				pOut[iPointPos + 1] = '0';
+				return pOut + iPointPos + 2;
+			}
+			else if (iPointPos > 0 && iPointPos <= 21)
+			{
+				// 1234e-2 -> 12.34
+				memmove(pOut + iPointPos + 1, pOut + iPointPos, iLength - iPointPos);
+				pOut[iPointPos] = '.';
+				return pOut + iLength + 1;
+			}
+			else if (iPointPos > -6 && iPointPos <= 0)
+			{
+				// 1234e-6 -> 0.001234
+				const int iOffset = 2 - iPointPos;
+				memmove(pOut + iOffset, pOut, iLength);
+				pOut[0] = '0';
+				pOut[1] = '.';
+				for (int i = 2; i < iOffset; ++i)
+					pOut[i] = '0';
+				return pOut + iLength + iOffset;
+			}
+			else if (iLength == 1)
+			{
+				// 1e30
+				pOut[1] = 'e';
+				return WriteExponent(pOut + 2, iPointPos - 1);
+			}
+
+			// 1234e30 -> 1.234e33
+			memmove(pOut + 2, pOut + 1, iLength - 1);
+			pOut[1] = '.';
+			pOut[iLength + 1] = 'e';
+			return WriteExponent(pOut + iLength + 2, iPointPos - 1);
+		}
+
+		void PushInteger(CharBuffer& sOutJson, int64_t iValue)
+		{
+			size_t iSize = sOutJson.Size();
+			sOutJson.Resize(iSize + 21);
+			char* pEnd = WriteInt64(sOutJson.Data() + iSize, iValue);
+			sOutJson.Resize(pEnd - sOutJson.Data());
+		}
+
+		void PushFloat(CharBuffer& sOutJson, double fValue)
 		{
-			if (Internal::IsNaN(m_oValue.Float))
+			if (IsNaN(fValue))
 			{
 				sOutJson.PushRange("NaN", 3);
 			}
-			else if (Internal::IsInfinite(m_oValue.Float))
+			else if (IsInfinite(fValue))
 			{
-				if (m_oValue.Float < 0.f)
+				if (fValue < 0.f)
 					sOutJson.PushRange("-Infinity", 9);
 				else
 					sOutJson.PushRange("Infinity", 8);
 			}
 			else
 			{
+#ifdef STTHM_WRITE_FLOAT_WITH_PRINTF
 				char sBuffer[256];
-				snprintf(sBuffer, 256, "%.17g", m_oValue.Float);
+				snprintf(sBuffer, 256, "%.17g", fValue);
 				size_t iLen = strlen(sBuffer);
+				// Same output as the default writer: '.' whatever the locale, and always a fraction or an exponent
+				char* pPoint = strchr(sBuffer, localeconv()->decimal_point[0]);
+				if (pPoint != NULL)
+					*pPoint = '.';
+				else if (strchr(sBuffer, 'e') == NULL)
+				{
+					memcpy(sBuffer + iLen, ".0", 3);
+					iLen += 2;
+				}
 				sOutJson.PushRange(sBuffer, iLen);
+#else //STTHM_WRITE_FLOAT_WITH_PRINTF
+				size_t iSize = sOutJson.Size();
+				sOutJson.Resize(iSize + 25);
+				char* pEnd = WriteDouble(sOutJson.Data() + iSize, fValue);
+				sOutJson.Resize(pEnd - sOutJson.Data());
+#endif // !STTHM_WRITE_FLOAT_WITH_PRINTF
 			}
 		}
-		else
+
+		// Appends \uXXXX
+		inline void PushUnicodeEscape(CharBuffer& sOutJson, uint32_t iCodeUnit)
 		{
-			sOutJson.PushRange("null", 4);
+			const char* const pHexa = "0123456789abcdef";
+			size_t iSize = sOutJson.Size();
+			sOutJson.Resize(iSize + 6);
+			char* pOut = sOutJson.Data() + iSize;
+			pOut[0] = '\\';
+			pOut[1] = 'u';
+			pOut[2] = pHexa[(iCodeUnit >> 12) & 0x0f];
+			pOut[3] = pHexa[(iCodeUnit >> 8) & 0x0f];
+			pOut[4] = pHexa[(iCodeUnit >> 4) & 0x0f];
+			pOut[5] = pHexa[(iCodeUnit >> 0) & 0x0f];
 		}
-	}
 
-#ifdef JsonStthmString
-	void JsonValue::WriteString(JsonStthmString& sOutJson, bool bCompact) const
-	{
-		Internal::CharBuffer oBuffer;
-		Write(oBuffer, 0, bCompact);
-		sOutJson.resize(oBuffer.Size());
-		oBuffer.WriteTo((char*)sOutJson.data());
-	}
-#endif //JsonStthmString
+#define STTHM_REPEAT_16(sString) sString sString sString sString sString sString sString sString sString sString sString sString sString sString sString sString
+		// New line followed by indent chars, sliced by JsonTextWriter
+		const size_t c_iIndentTableSize = 128;
+		const char c_pIndentTabs[] = "\n" STTHM_REPEAT_16("\t\t\t\t\t\t\t\t");
+		const char c_pIndentSpaces[] = "\n" STTHM_REPEAT_16("        ");
+#undef STTHM_REPEAT_16
 
-	char* JsonValue::WriteString(bool bCompact) const
-	{
-		Internal::CharBuffer oBuffer;
-		Write(oBuffer, 0, bCompact);
-		char* pString = (char*)JsonStthmMalloc(oBuffer.Size() + 1);
-		if (pString != NULL)
+		int CountLines(const char* pJson, const char* pEnd)
 		{
-			oBuffer.WriteTo(pString);
-			pString[oBuffer.Size()] = '\0';
+			int iLine = 1;
+			int iReturn = 1;
+			while (pJson != pEnd)
+			{
+				if (*pJson == '\n')
+					++iLine;
+				else if (*pJson == '\r')
+					++iReturn;
+				++pJson;
+			}
+			if (iReturn > iLine)
+				iLine = iReturn;
+			return iLine;
 		}
-		return pString;
-	}
 
-	bool JsonValue::WriteFile(const char* pFilename, bool bCompact) const
-	{
-		FILE* pFile = fopen(pFilename, "w");
-		if (NULL != pFile)
+		inline int CountTrailingZeros(uint64_t iValue)
 		{
-			Internal::CharBuffer sJson;
-			Write(sJson, 0, bCompact);
-			bool bRet = fwrite(sJson.Data(), sizeof(char), sJson.Size(), pFile) == (sizeof(char) * sJson.Size());
-			fclose(pFile);
-			return bRet;
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+			unsigned long iIndex;
+			_BitScanForward64(&iIndex, iValue);
+			return (int)iIndex;
+#elif defined(_MSC_VER)
+			unsigned long iIndex;
+			if (_BitScanForward(&iIndex, (unsigned long)iValue))
+				return (int)iIndex;
+			_BitScanForward(&iIndex, (unsigned long)(iValue >> 32));
+			return (int)iIndex + 32;
+#else
+			return __builtin_ctzll(iValue);
+#endif
 		}
-		return false;
-	}
 
-	int JsonValue::GetMemberCount() const
-	{
-		int iCount = 0;
-		if (m_eType == E_TYPE_OBJECT || m_eType == E_TYPE_ARRAY)
+		inline int PopCount(uint64_t iValue)
 		{
-			JsonValue* pChild = m_oValue.Childs.m_pFirst;
-			while (pChild != NULL)
+#if defined(_MSC_VER) && defined(_M_X64)
+			return (int)__popcnt64(iValue);
+#elif defined(_MSC_VER)
+			iValue = iValue - ((iValue >> 1) & 0x5555555555555555ULL);
+			iValue = (iValue & 0x3333333333333333ULL) + ((iValue >> 2) & 0x3333333333333333ULL);
+			iValue = (iValue + (iValue >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+			return (int)((iValue * 0x0101010101010101ULL) >> 56);
+#else
+			return __builtin_popcountll(iValue);
+#endif
+		}
+
+		// Returns pointer to the first '"', '\\' or null terminator
+		// Aligned loads never cross a page boundary, so reading past the null terminator is safe
+		STTHM_NO_SANITIZE_ADDRESS
+		inline const char* FindQuoteOrBackslash(const char* pString)
+		{
+#if defined(STTHM_AVX2) && defined(__AVX2__)
+			const __m256i vQuote = _mm256_set1_epi8('"');
+			const __m256i vBackslash = _mm256_set1_epi8('\\');
+			const __m256i vZero = _mm256_setzero_si256();
+			const char* pAligned = (const char*)((uintptr_t)pString & ~(uintptr_t)31);
+			__m256i vChars = _mm256_load_si256((const __m256i*)pAligned);
+			uint32_t iMask = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(
+				_mm256_cmpeq_epi8(vChars, vQuote), _mm256_cmpeq_epi8(vChars, vBackslash)), _mm256_cmpeq_epi8(vChars, vZero)));
+			iMask >>= (pString - pAligned);
+			if (iMask != 0)
+				return pString + CountTrailingZeros(iMask);
+			for (;;)
 			{
-				++iCount;
-				pChild = pChild->m_pNext;
+				pAligned += 32;
+				vChars = _mm256_load_si256((const __m256i*)pAligned);
+				iMask = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(
+					_mm256_cmpeq_epi8(vChars, vQuote), _mm256_cmpeq_epi8(vChars, vBackslash)), _mm256_cmpeq_epi8(vChars, vZero)));
+				if (iMask != 0)
+					return pAligned + CountTrailingZeros(iMask);
 			}
+#elif defined(STTHM_SSE2)
+			const __m128i vQuote = _mm_set1_epi8('"');
+			const __m128i vBackslash = _mm_set1_epi8('\\');
+			const __m128i vZero = _mm_setzero_si128();
+			const char* pAligned = (const char*)((uintptr_t)pString & ~(uintptr_t)15);
+			__m128i vChars = _mm_load_si128((const __m128i*)pAligned);
+			uint32_t iMask = (uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(
+				_mm_cmpeq_epi8(vChars, vQuote), _mm_cmpeq_epi8(vChars, vBackslash)), _mm_cmpeq_epi8(vChars, vZero)));
+			iMask >>= (pString - pAligned);
+			if (iMask != 0)
+				return pString + CountTrailingZeros(iMask);
+			for (;;)
+			{
+				pAligned += 16;
+				vChars = _mm_load_si128((const __m128i*)pAligned);
+				iMask = (uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(
+					_mm_cmpeq_epi8(vChars, vQuote), _mm_cmpeq_epi8(vChars, vBackslash)), _mm_cmpeq_epi8(vChars, vZero)));
+				if (iMask != 0)
+					return pAligned + CountTrailingZeros(iMask);
+			}
+#else
+			while (*pString != '"' && *pString != '\\' && *pString != 0)
+				++pString;
+			return pString;
+#endif
 		}
 
-		return iCount;
-	}
-
-	const char* JsonValue::ToString() const
-	{
-		if (m_eType == E_TYPE_STRING)
-			return m_oValue.String;
-		return NULL;
-	}
-
-	bool JsonValue::ToBoolean() const
-	{
-		if (m_eType == E_TYPE_BOOLEAN)
-			return m_oValue.Boolean;
-		return false;
-	}
+		// Returns pointer to the closing quote of a string, or to the null terminator
+		inline const char* FindClosingQuote(const char* pString)
+		{
+			for (;;)
+			{
+				pString = FindQuoteOrBackslash(pString);
+				if (*pString != '\\')
+					return pString;
+				if (pString[1] == 0)
+					return pString + 1;
+				pString += 2;
+			}
+		}
 
-	int64_t JsonValue::ToInteger() const
-	{
-		if (m_eType == E_TYPE_INTEGER)
-			return m_oValue.Integer;
-		else if (m_eType == E_TYPE_FLOAT)
-			return (int64_t)m_oValue.Float;
-		return 0;
-	}
+		// Returns pointer to the first '"', '{', '}', '[', ']' or null terminator
+		STTHM_NO_SANITIZE_ADDRESS
+		inline const char* FindQuoteOrBracket(const char* pString)
+		{
+			// '[' and ']' become '{' and '}' with the 0x20 bit set
+#if defined(STTHM_AVX2) && defined(__AVX2__)
+			const __m256i vQuote = _mm256_set1_epi8('"');
+			const __m256i vLowerBit = _mm256_set1_epi8(0x20);
+			const __m256i vOpenBrace = _mm256_set1_epi8('{');
+			const __m256i vCloseBrace = _mm256_set1_epi8('}');
+			const __m256i vZero = _mm256_setzero_si256();
+			const char* pAligned = (const char*)((uintptr_t)pString & ~(uintptr_t)31);
+			for (;;)
+			{
+				__m256i vChars = _mm256_load_si256((const __m256i*)pAligned);
+				__m256i vLower = _mm256_or_si256(vChars, vLowerBit);
+				uint32_t iMask = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(
+					_mm256_or_si256(_mm256_cmpeq_epi8(vChars, vQuote), _mm256_cmpeq_epi8(vChars, vZero)),
+					_mm256_or_si256(_mm256_cmpeq_epi8(vLower, vOpenBrace), _mm256_cmpeq_epi8(vLower, vCloseBrace))));
+				if (pAligned < pString)
+					iMask &= ~0u << (pString - pAligned);
+				if (iMask != 0)
+					return pAligned + CountTrailingZeros(iMask);
+				pAligned += 32;
+			}
+#elif defined(STTHM_SSE2)
+			const __m128i vQuote = _mm_set1_epi8('"');
+			const __m128i vLowerBit = _mm_set1_epi8(0x20);
+			const __m128i vOpenBrace = _mm_set1_epi8('{');
+			const __m128i vCloseBrace = _mm_set1_epi8('}');
+			const __m128i vZero = _mm_setzero_si128();
+			const char* pAligned = (const char*)((uintptr_t)pString & ~(uintptr_t)15);
+			for (;;)
+			{
+				__m128i vChars = _mm_load_si128((const __m128i*)pAligned);
+				__m128i vLower = _mm_or_si128(vChars, vLowerBit);
+				uint32_t iMask = (uint32_t)_mm_movemask_epi8(_mm_or_si128(
+					_mm_or_si128(_mm_cmpeq_epi8(vChars, vQuote), _mm_cmpeq_epi8(vChars, vZero)),
+					_mm_or_si128(_mm_cmpeq_epi8(vLower, vOpenBrace), _mm_cmpeq_epi8(vLower, vCloseBrace))));
+				if (pAligned < pString)
+					iMask &= ~0u << (pString - pAligned);
+				if (iMask != 0)
+					return pAligned + CountTrailingZeros(iMask);
+				pAligned += 16;
+			}
+#else
+			while (*pString != '"' && (*pString | 0x20) != '{' && (*pString | 0x20) != '}' && *pString != 0)
+				++pString;
+			return pString;
+#endif
+		}
 
-	double JsonValue::ToFloat() const
-	{
-		if (m_eType == E_TYPE_FLOAT)
-			return m_oValue.Float;
-		else if (m_eType == E_TYPE_INTEGER)
-			return (double)m_oValue.Integer;
-		return 0.0;
-	}
+		// Returns pointer to the first '"', '\\', control char, null terminator or, when bNonAscii is set, byte >= 0x80
+		STTHM_NO_SANITIZE_ADDRESS
+		inline const char* FindCharToEscape(const char* pString, bool bNonAscii)
+		{
+#if defined(STTHM_AVX2) && defined(__AVX2__)
+			const __m256i vQuote = _mm256_set1_epi8('"');
+			const __m256i vBackslash = _mm256_set1_epi8('\\');
+			const __m256i vLastControl = _mm256_set1_epi8(0x1F);
+			const uint32_t iNonAsciiMask = bNonAscii ? ~0u : 0u;
+			const char* pAligned = (const char*)((uintptr_t)pString & ~(uintptr_t)31);
+			for (;;)
+			{
+				__m256i vChars = _mm256_load_si256((const __m256i*)pAligned);
+				uint32_t iMask = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(
+					_mm256_or_si256(_mm256_cmpeq_epi8(vChars, vQuote), _mm256_cmpeq_epi8(vChars, vBackslash)),
+					_mm256_cmpeq_epi8(_mm256_max_epu8(vChars, vLastControl), vLastControl)));
+				iMask |= (uint32_t)_mm256_movemask_epi8(vChars) & iNonAsciiMask;
+				if (pAligned < pString)
+					iMask &= ~0u << (pString - pAligned);
+				if (iMask != 0)
+					return pAligned + CountTrailingZeros(iMask);
+				pAligned += 32;
+			}
+#elif defined(STTHM_SSE2)
+			const __m128i vQuote = _mm_set1_epi8('"');
+			const __m128i vBackslash = _mm_set1_epi8('\\');
+			const __m128i vLastControl = _mm_set1_epi8(0x1F);
+			const uint32_t iNonAsciiMask = bNonAscii ? ~0u : 0u;
+			const char* pAligned = (const char*)((uintptr_t)pString & ~(uintptr_t)15);
+			for (;;)
+			{
+				__m128i vChars = _mm_load_si128((const __m128i*)pAligned);
+				uint32_t iMask = (uint32_t)_mm_movemask_epi8(_mm_or_si128(
+					_mm_or_si128(_mm_cmpeq_epi8(vChars, vQuote), _mm_cmpeq_epi8(vChars, vBackslash)),
+					_mm_cmpeq_epi8(_mm_max_epu8(vChars, vLastControl), vLastControl)));
+				iMask |= (uint32_t)_mm_movemask_epi8(vChars) & iNonAsciiMask;
+				if (pAligned < pString)
+					iMask &= ~0u << (pString - pAligned);
+				if (iMask != 0)
+					return pAligned + CountTrailingZeros(iMask);
+				pAligned += 16;
+			}
+#else
+			for (;;)
+			{
+				unsigned char iChar = (unsigned char)*pString;
+				if (iChar == '"' || iChar == '\\' || iChar < 0x20 || (bNonAscii && iChar >= 0x80))
+					return pString;
+				++pString;
+			}
+#endif
+		}
 
-#ifdef STTHM_ENABLE_IMPLICIT_CAST
-	JsonValue::operator const char*() const
-	{
-		return ToString();
-	}
+		// Move pString after the value, only strings and brackets nesting are checked
+		bool SkipValue(const char*& pString)
+		{
+			char cChar = *pString;
+			if (cChar == '"')
+			{
+				const char* pEnd = FindClosingQuote(pString + 1);
+				if (*pEnd != '"')
+					return false;
+				pString = pEnd + 1;
+				return true;
+			}
+			else if (cChar != '{' && cChar != '[')
+			{
+				// Scalar, up to the next separator
+				if (cChar == 0 || cChar == ',' || cChar == ':' || cChar == '}' || cChar == ']')
+					return false;
+				while (*pString != 0 && *pString != ',' && *pString != '}' && *pString != ']' && IsSpace(*pString) == false)
+					++pString;
+				return true;
+			}
 
-	JsonValue::operator bool() const
-	{
-		return ToBoolean();
-	}
+			// Container, jump from bracket to bracket
+			int iDepth = 0;
+			for (;;)
+			{
+				pString = FindQuoteOrBracket(pString);
+				cChar = *pString;
+				if (cChar == '"')
+				{
+					const char* pEnd = FindClosingQuote(pString + 1);
+					if (*pEnd != '"')
+						return false;
+					pString = pEnd + 1;
+				}
+				else if (cChar == '{' || cChar == '[')
+				{
+					++iDepth;
+					++pString;
+				}
+				else if (cChar == '}' || cChar == ']')
+				{
+					++pString;
+					if (--iDepth == 0)
+						return true;
+				}
+				else
+				{
+					return false;
+				}
+			}
+		}
 
-	JsonValue::operator int64_t() const
-	{
-		return ToInteger();
-	}
+		//////////////////////////////
+		// Structural index, used by JsonLazyDoc and E_READ_PARALLEL_ARRAY
+		//////////////////////////////
 
-	JsonValue::operator double() const
-	{
-		return ToFloat();
-	}
-#endif //STTHM_ENABLE_IMPLICIT_CAST
+		// Bitmaps of one 64 bytes block, bit N is set when byte N is of the class
+		struct BlockMasks
+		{
+			uint64_t	iWhitespace;
+			uint64_t	iOperator;		// { } [ ] : ,
+			uint64_t	iQuote;
+			uint64_t	iBackslash;
+		};
 
-	void JsonValue::SetString(const char* pValue)
-	{
-		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
-		if (this == &JsonStthm::JsonValue::INVALID)
-			return;
+		typedef void (*ClassifyBlockFunc)(const char* pBlock, BlockMasks& oMasks);
 
-		if (NULL != pValue)
+		void ClassifyBlockScalar(const char* pBlock, BlockMasks& oMasks)
 		{
-			InitType(E_TYPE_STRING);
-			SetStringValue(pValue);
+			oMasks.iWhitespace = 0;
+			oMasks.iOperator = 0;
+			oMasks.iQuote = 0;
+			oMasks.iBackslash = 0;
+			for (int i = 0; i < 64; ++i)
+			{
+				const uint64_t iBit = (uint64_t)1 << i;
+				switch (pBlock[i])
+				{
+				case ' ': case '\t': case '\n': case '\v': case '\f': case '\r':
+					oMasks.iWhitespace |= iBit;
+					break;
+				case '{': case '}': case '[': case ']': case ':': case ',':
+					oMasks.iOperator |= iBit;
+					break;
+				case '"':
+					oMasks.iQuote |= iBit;
+					break;
+				case '\\':
+					oMasks.iBackslash |= iBit;
+					break;
+				default:
+					break;
+				}
+			}
+		}
+
+#if defined(STTHM_SSE2)
+		void ClassifyBlockSSE2(const char* pBlock, BlockMasks& oMasks)
+		{
+			const __m128i vLowerBit = _mm_set1_epi8(0x20);
+			const __m128i vOpenBrace = _mm_set1_epi8('{');	// '[' | 0x20 == '{'
+			const __m128i vCloseBrace = _mm_set1_epi8('}');	// ']' | 0x20 == '}'
+			const __m128i vColon = _mm_set1_epi8(':');
+			const __m128i vComma = _mm_set1_epi8(',');
+			const __m128i vSpace = _mm_set1_epi8(' ');
+			const __m128i vTab = _mm_set1_epi8('\t');
+			const __m128i vFour = _mm_set1_epi8(4);
+			const __m128i vQuote = _mm_set1_epi8('"');
+			const __m128i vBackslash = _mm_set1_epi8('\\');
+			const __m128i vZero = _mm_setzero_si128();
+
+			oMasks.iWhitespace = 0;
+			oMasks.iOperator = 0;
+			oMasks.iQuote = 0;
+			oMasks.iBackslash = 0;
+			for (int i = 0; i < 4; ++i)
+			{
+				__m128i vChars = _mm_loadu_si128((const __m128i*)(pBlock + i * 16));
+				__m128i vLower = _mm_or_si128(vChars, vLowerBit);
+				__m128i vOperator = _mm_or_si128(
+					_mm_or_si128(_mm_cmpeq_epi8(vLower, vOpenBrace), _mm_cmpeq_epi8(vLower, vCloseBrace)),
+					_mm_or_si128(_mm_cmpeq_epi8(vChars, vColon), _mm_cmpeq_epi8(vChars, vComma)));
+				// '\t' to '\r' range: (c - '\t') <= 4 as unsigned
+				__m128i vWhitespace = _mm_or_si128(_mm_cmpeq_epi8(vChars, vSpace),
+					_mm_cmpeq_epi8(_mm_subs_epu8(_mm_sub_epi8(vChars, vTab), vFour), vZero));
+
+				const int iShift = i * 16;
+				oMasks.iWhitespace |= (uint64_t)(uint32_t)_mm_movemask_epi8(vWhitespace) << iShift;
+				oMasks.iOperator |= (uint64_t)(uint32_t)_mm_movemask_epi8(vOperator) << iShift;
+				oMasks.iQuote |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(vChars, vQuote)) << iShift;
+				oMasks.iBackslash |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(vChars, vBackslash)) << iShift;
+			}
+		}
+#endif //STTHM_SSE2
+
+#if defined(STTHM_AVX2)
+		STTHM_TARGET_AVX2
+		void ClassifyBlockAVX2(const char* pBlock, BlockMasks& oMasks)
+		{
+			const __m256i vLowerBit = _mm256_set1_epi8(0x20);
+			const __m256i vOpenBrace = _mm256_set1_epi8('{');
+			const __m256i vCloseBrace = _mm256_set1_epi8('}');
+			const __m256i vColon = _mm256_set1_epi8(':');
+			const __m256i vComma = _mm256_set1_epi8(',');
+			const __m256i vSpace = _mm256_set1_epi8(' ');
+			const __m256i vTab = _mm256_set1_epi8('\t');
+			const __m256i vFour = _mm256_set1_epi8(4);
+			const __m256i vQuote = _mm256_set1_epi8('"');
+			const __m256i vBackslash = _mm256_set1_epi8('\\');
+			const __m256i vZero = _mm256_setzero_si256();
+
+			oMasks.iWhitespace = 0;
+			oMasks.iOperator = 0;
+			oMasks.iQuote = 0;
+			oMasks.iBackslash = 0;
+			for (int i = 0; i < 2; ++i)
+			{
+				__m256i vChars = _mm256_loadu_si256((const __m256i*)(pBlock + i * 32));
+				__m256i vLower = _mm256_or_si256(vChars, vLowerBit);
+				__m256i vOperator = _mm256_or_si256(
+					_mm256_or_si256(_mm256_cmpeq_epi8(vLower, vOpenBrace), _mm256_cmpeq_epi8(vLower, vCloseBrace)),
+					_mm256_or_si256(_mm256_cmpeq_epi8(vChars, vColon), _mm256_cmpeq_epi8(vChars, vComma)));
+				__m256i vWhitespace = _mm256_or_si256(_mm256_cmpeq_epi8(vChars, vSpace),
+					_mm256_cmpeq_epi8(_mm256_subs_epu8(_mm256_sub_epi8(vChars, vTab), vFour), vZero));
+
+				const int iShift = i * 32;
+				oMasks.iWhitespace |= (uint64_t)(uint32_t)_mm256_movemask_epi8(vWhitespace) << iShift;
+				oMasks.iOperator |= (uint64_t)(uint32_t)_mm256_movemask_epi8(vOperator) << iShift;
+				oMasks.iQuote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(vChars, vQuote)) << iShift;
+				oMasks.iBackslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(vChars, vBackslash)) << iShift;
+			}
+		}
+
+		bool HasAVX2()
+		{
+#if defined(_MSC_VER)
+			int pInfo[4];
+			__cpuid(pInfo, 0);
+			if (pInfo[0] < 7)
+				return false;
+			__cpuid(pInfo, 1);
+			const int c_iOSXSave = 1 << 27;
+			const int c_iAVX = 1 << 28;
+			if ((pInfo[2] & c_iOSXSave) == 0 || (pInfo[2] & c_iAVX) == 0)
+				return false;
+			if ((_xgetbv(0) & 6) != 6) // OS saves YMM registers
+				return false;
+			__cpuidex(pInfo, 7, 0);
+			return (pInfo[1] & (1 << 5)) != 0;
+#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2") != 0;
+#endif
+		}
+#endif //STTHM_AVX2
+
+		ClassifyBlockFunc GetClassifyBlockFunc()
+		{
+#if defined(STTHM_AVX2)
+			if (HasAVX2())
+				return ClassifyBlockAVX2;
+#endif //STTHM_AVX2
+#if defined(STTHM_SSE2)
+			return ClassifyBlockSSE2;
+#else
+			return ClassifyBlockScalar;
+#endif //STTHM_SSE2
+		}
+
+		// Returns length of the UTF-8 sequence at pString and its code point, 0 when invalid.
+		// Bytes are checked in order, so a null terminator stops the sequence.
+		inline int DecodeUtf8(const char* pString, uint32_t& iChar)
+		{
+			const unsigned char* pBytes = (const unsigned char*)pString;
+			uint32_t iLead = pBytes[0];
+			int iLength;
+			unsigned char iMin = 0x80;
+			unsigned char iMax = 0xBF;
+			if (iLead < 0x80)
+			{
+				iChar = iLead;
+				return 1;
+			}
+			else if (iLead >= 0xC2 && iLead <= 0xDF)
+			{
+				iLength = 2;
+				iChar = iLead & 0x1F;
+			}
+			else if (iLead >= 0xE0 && iLead <= 0xEF)
+			{
+				iLength = 3;
+				iChar = iLead & 0x0F;
+				if (iLead == 0xE0) iMin = 0xA0; // Overlong
+				else if (iLead == 0xED) iMax = 0x9F; // Surrogate
+			}
+			else if (iLead >= 0xF0 && iLead <= 0xF4)
+			{
+				iLength = 4;
+				iChar = iLead & 0x07;
+				if (iLead == 0xF0) iMin = 0x90; // Overlong
+				else if (iLead == 0xF4) iMax = 0x8F; // Above U+10FFFF
+			}
+			else
+			{
+				return 0;
+			}
+
+			if (pBytes[1] < iMin || pBytes[1] > iMax)
+				return 0;
+			iChar = (iChar << 6) | (pBytes[1] & 0x3F);
+			for (int i = 2; i < iLength; ++i)
+			{
+				if ((pBytes[i] & 0xC0) != 0x80)
+					return 0;
+				iChar = (iChar << 6) | (pBytes[i] & 0x3F);
+			}
+			return iLength;
+		}
+
+		typedef const char* (*FindInvalidUtf8Func)(const char* pString, const char* pEnd);
+
+		// Returns pointer to the first invalid UTF-8 sequence, or pEnd
+		const char* FindInvalidUtf8Scalar(const char* pString, const char* pEnd)
+		{
+			while (pString != pEnd)
+			{
+				// ASCII runs 8 bytes at a time
+				if (pEnd - pString >= 8)
+				{
+					uint64_t iBytes;
+					memcpy(&iBytes, pString, 8);
+					if ((iBytes & 0x8080808080808080ULL) == 0)
+					{
+						pString += 8;
+						continue;
+					}
+				}
+
+				if ((unsigned char)*pString < 0x80)
+				{
+					++pString;
+					continue;
+				}
+
+				// Sequence near the end is decoded from a null padded copy
+				uint32_t iChar;
+				int iLength;
+				if (pEnd - pString >= 4)
+				{
+					iLength = DecodeUtf8(pString, iChar);
+				}
+				else
+				{
+					char pTail[5] = { 0, 0, 0, 0, 0 };
+					memcpy(pTail, pString, pEnd - pString);
+					iLength = DecodeUtf8(pTail, iChar);
+				}
+				if (iLength == 0)
+					return pString;
+				pString += iLength;
+			}
+			return pEnd;
+		}
+
+#if defined(STTHM_SSE2)
+		// For CPUs without SSSE3: ASCII blocks are skipped 16 bytes at a time, others are decoded by the scalar path
+		const char* FindInvalidUtf8SSE2(const char* pString, const char* pEnd)
+		{
+			while (pEnd - pString >= 16)
+			{
+				__m128i vChars = _mm_loadu_si128((const __m128i*)pString);
+				if (_mm_movemask_epi8(vChars) == 0)
+				{
+					pString += 16;
+					continue;
+				}
+
+				// Sequences may end past the block, the next block starts after them
+				const char* pBlockEnd = pString + 16;
+				while (pString < pBlockEnd)
+				{
+					if (pEnd - pString < 4)
+						return FindInvalidUtf8Scalar(pString, pEnd);
+					uint32_t iChar;
+					int iLength = DecodeUtf8(pString, iChar);
+					if (iLength == 0)
+						return pString;
+					pString += iLength;
+				}
+			}
+			return FindInvalidUtf8Scalar(pString, pEnd);
+		}
+#endif //STTHM_SSE2
+
+#if defined(STTHM_SSSE3)
+		// Error flags of two consecutive bytes, looked up from the high nibble of the first byte,
+		// the low nibble of the first byte and the high nibble of the second byte.
+		// The three lookups are and'ed, any bit left set is an error.
+		// (Keiser & Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte")
+		const char c_iUtf8TooShort		= 1 << 0; // Lead byte not followed by a continuation
+		const char c_iUtf8TooLong		= 1 << 1; // ASCII followed by a continuation
+		const char c_iUtf8Overlong3		= 1 << 2;
+		const char c_iUtf8TooLarge		= 1 << 3;
+		const char c_iUtf8Surrogate		= 1 << 4;
+		const char c_iUtf8Overlong2		= 1 << 5;
+		const char c_iUtf8TooLarge1000	= 1 << 6;
+		const char c_iUtf8Overlong4		= 1 << 6;
+		const char c_iUtf8TwoConts		= (char)(1 << 7);
+		const char c_iUtf8Carry			= c_iUtf8TooShort | c_iUtf8TooLong | c_iUtf8TwoConts;
+
+		// Error flags indexed by a nibble
+		const char c_pUtf8Byte1High[16] = {
+			c_iUtf8TooLong, c_iUtf8TooLong, c_iUtf8TooLong, c_iUtf8TooLong,
+			c_iUtf8TooLong, c_iUtf8TooLong, c_iUtf8TooLong, c_iUtf8TooLong,
+			c_iUtf8TwoConts, c_iUtf8TwoConts, c_iUtf8TwoConts, c_iUtf8TwoConts,
+			c_iUtf8TooShort | c_iUtf8Overlong2,
+			c_iUtf8TooShort,
+			c_iUtf8TooShort | c_iUtf8Overlong3 | c_iUtf8Surrogate,
+			c_iUtf8TooShort | c_iUtf8TooLarge | c_iUtf8TooLarge1000 | c_iUtf8Overlong4
+		};
+		const char c_pUtf8Byte1Low[16] = {
+			c_iUtf8Carry | c_iUtf8Overlong3 | c_iUtf8Overlong2 | c_iUtf8Overlong4,
+			c_iUtf8Carry | c_iUtf8Overlong2,
+			c_iUtf8Carry,
+			c_iUtf8Carry,
+			c_iUtf8Carry | c_iUtf8TooLarge,
+			c_iUtf8Carry | c_iUtf8TooLarge | c_iUtf8TooLarge1000,
+			c_iUtf8Carry | c_iUtf8TooLarge | c_iUtf8TooLarge1000,
+			c_iUtf8Carry | c_iUtf8TooLarge | c_iUtf8TooLarge1000,
+			c_iUtf8Carry | c_iUtf8TooLarge | c_iUtf8TooLarge1000,
+			c_iUtf8Carry | c_iUtf8TooLarge | c_iUtf8TooLarge1000,
+			c_iUtf8Carry | c_iUtf8TooLarge | c_iUtf8TooLarge1000,
+			c_iUtf8Carry | c_iUtf8TooLarge | c_iUtf8TooLarge1000,
+			c_iUtf8Carry | c_iUtf8TooLarge | c_iUtf8TooLarge1000,
+			c_iUtf8Carry | c_iUtf8TooLarge | c_iUtf8TooLarge1000 | c_iUtf8Surrogate,
+			c_iUtf8Carry | c_iUtf8TooLarge | c_iUtf8TooLarge1000,
+			c_iUtf8Carry | c_iUtf8TooLarge | c_iUtf8TooLarge1000
+		};
+		const char c_pUtf8Byte2High[16] = {
+			c_iUtf8TooShort, c_iUtf8TooShort, c_iUtf8TooShort, c_iUtf8TooShort,
+			c_iUtf8TooShort, c_iUtf8TooShort, c_iUtf8TooShort, c_iUtf8TooShort,
+			c_iUtf8TooLong | c_iUtf8Overlong2 | c_iUtf8TwoConts | c_iUtf8Overlong3 | c_iUtf8TooLarge1000 | c_iUtf8Overlong4,
+			c_iUtf8TooLong | c_iUtf8Overlong2 | c_iUtf8TwoConts | c_iUtf8Overlong3 | c_iUtf8TooLarge,
+			c_iUtf8TooLong | c_iUtf8Overlong2 | c_iUtf8TwoConts | c_iUtf8Surrogate | c_iUtf8TooLarge,
+			c_iUtf8TooLong | c_iUtf8Overlong2 | c_iUtf8TwoConts | c_iUtf8Surrogate | c_iUtf8TooLarge,
+			c_iUtf8TooShort, c_iUtf8TooShort, c_iUtf8TooShort, c_iUtf8TooShort
+		};
+
+		bool HasSSSE3()
+		{
+#if defined(_MSC_VER)
+			int pInfo[4];
+			__cpuid(pInfo, 1);
+			return (pInfo[2] & (1 << 9)) != 0;
+#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("ssse3") != 0;
+#endif
+		}
+
+		STTHM_TARGET_SSSE3
+		inline __m128i Utf8Lookup16(__m128i vIndex, __m128i vTable)
+		{
+			return _mm_shuffle_epi8(vTable, vIndex);
+		}
+
+		// Last N bytes of vPrev followed by vChars
+		template <int N>
+		STTHM_TARGET_SSSE3
+		inline __m128i Utf8Previous(__m128i vChars, __m128i vPrev)
+		{
+			return _mm_alignr_epi8(vChars, vPrev, 16 - N);
+		}
+
+		STTHM_TARGET_SSSE3
+		inline __m128i Utf8CheckBlock(__m128i vChars, __m128i vPrev)
+		{
+			const __m128i vLowNibble = _mm_set1_epi8(0x0F);
+			__m128i vPrev1 = Utf8Previous<1>(vChars, vPrev);
+			__m128i vSpecialCases = _mm_and_si128(_mm_and_si128(
+				Utf8Lookup16(_mm_and_si128(_mm_srli_epi16(vPrev1, 4), vLowNibble), _mm_loadu_si128((const __m128i*)c_pUtf8Byte1High)),
+				Utf8Lookup16(_mm_and_si128(vPrev1, vLowNibble), _mm_loadu_si128((const __m128i*)c_pUtf8Byte1Low))),
+				Utf8Lookup16(_mm_and_si128(_mm_srli_epi16(vChars, 4), vLowNibble), _mm_loadu_si128((const __m128i*)c_pUtf8Byte2High)));
+
+			// Third and fourth bytes of 3 and 4 bytes sequences must be continuations,
+			// which the two bytes lookup reports as TwoConts
+			__m128i vIsThird = _mm_subs_epu8(Utf8Previous<2>(vChars, vPrev), _mm_set1_epi8((char)(0xE0 - 0x80)));
+			__m128i vIsFourth = _mm_subs_epu8(Utf8Previous<3>(vChars, vPrev), _mm_set1_epi8((char)(0xF0 - 0x80)));
+			__m128i vMust23 = _mm_and_si128(_mm_or_si128(vIsThird, vIsFourth), _mm_set1_epi8((char)0x80));
+			return _mm_xor_si128(vMust23, vSpecialCases);
+		}
+
+		STTHM_TARGET_SSSE3
+		const char* FindInvalidUtf8SSSE3(const char* pString, const char* pEnd)
+		{
+			// Bytes that start a sequence not complete at the end of a block
+			const __m128i vMaxComplete = _mm_setr_epi8(
+				-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				(char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+
+			const char* pStart = pString;
+			__m128i vPrev = _mm_setzero_si128();
+			__m128i vPrevIncomplete = _mm_setzero_si128();
+			__m128i vError = _mm_setzero_si128();
+			while (pEnd - pString >= 16)
+			{
+				__m128i vChars = _mm_loadu_si128((const __m128i*)pString);
+				if (_mm_movemask_epi8(vChars) == 0)
+				{
+					vError = _mm_or_si128(vError, vPrevIncomplete);
+					vPrevIncomplete = _mm_setzero_si128();
+				}
+				else
+				{
+					vError = _mm_or_si128(vError, Utf8CheckBlock(vChars, vPrev));
+					vPrevIncomplete = _mm_subs_epu8(vChars, vMaxComplete);
+				}
+				if (_mm_movemask_epi8(_mm_cmpeq_epi8(vError, _mm_setzero_si128())) != 0xFFFF)
+					break;
+				vPrev = vChars;
+				pString += 16;
+			}
+
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(vError, _mm_setzero_si128())) == 0xFFFF)
+			{
+				// Tail is checked from a null padded copy, nulls fail incomplete sequences
+				char pTail[16];
+				memset(pTail, 0, sizeof(pTail));
+				memcpy(pTail, pString, pEnd - pString);
+				__m128i vChars = _mm_loadu_si128((const __m128i*)pTail);
+				vError = Utf8CheckBlock(vChars, vPrev);
+				if (_mm_movemask_epi8(_mm_cmpeq_epi8(vError, _mm_setzero_si128())) == 0xFFFF)
+					return pEnd;
+			}
+
+			// Locate the error with the scalar path, from the start of the last sequence of the previous block
+			const char* pFrom = pString - pStart >= 3 ? pString - 3 : pStart;
+			while (pFrom != pStart && ((unsigned char)*pFrom & 0xC0) == 0x80)
+				--pFrom;
+			return FindInvalidUtf8Scalar(pFrom, pEnd);
+		}
+#endif //STTHM_SSSE3
+
+#if defined(STTHM_AVX2)
+		STTHM_TARGET_AVX2
+		inline __m256i Utf8Lookup16(__m256i vIndex, __m256i vTable)
+		{
+			return _mm256_shuffle_epi8(vTable, vIndex);
+		}
+
+		// Last N bytes of vPrev followed by vChars
+		template <int N>
+		STTHM_TARGET_AVX2
+		inline __m256i Utf8Previous(__m256i vChars, __m256i vPrev)
+		{
+			return _mm256_alignr_epi8(vChars, _mm256_permute2x128_si256(vPrev, vChars, 0x21), 16 - N);
+		}
+
+		STTHM_TARGET_AVX2
+		inline __m256i Utf8CheckBlock(__m256i vChars, __m256i vPrev)
+		{
+			const __m256i vLowNibble = _mm256_set1_epi8(0x0F);
+			const __m256i vByte1HighTable = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)c_pUtf8Byte1High));
+			const __m256i vByte1LowTable = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)c_pUtf8Byte1Low));
+			const __m256i vByte2HighTable = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)c_pUtf8Byte2High));
+
+			__m256i vPrev1 = Utf8Previous<1>(vChars, vPrev);
+			__m256i vSpecialCases = _mm256_and_si256(_mm256_and_si256(
+				Utf8Lookup16(_mm256_and_si256(_mm256_srli_epi16(vPrev1, 4), vLowNibble), vByte1HighTable),
+				Utf8Lookup16(_mm256_and_si256(vPrev1, vLowNibble), vByte1LowTable)),
+				Utf8Lookup16(_mm256_and_si256(_mm256_srli_epi16(vChars, 4), vLowNibble), vByte2HighTable));
+
+			// Third and fourth bytes of 3 and 4 bytes sequences must be continuations,
+			// which the two bytes lookup reports as TwoConts
+			__m256i vIsThird = _mm256_subs_epu8(Utf8Previous<2>(vChars, vPrev), _mm256_set1_epi8((char)(0xE0 - 0x80)));
+			__m256i vIsFourth = _mm256_subs_epu8(Utf8Previous<3>(vChars, vPrev), _mm256_set1_epi8((char)(0xF0 - 0x80)));
+			__m256i vMust23 = _mm256_and_si256(_mm256_or_si256(vIsThird, vIsFourth), _mm256_set1_epi8((char)0x80));
+			return _mm256_xor_si256(vMust23, vSpecialCases);
+		}
+
+		STTHM_TARGET_AVX2
+		const char* FindInvalidUtf8AVX2(const char* pString, const char* pEnd)
+		{
+			// Bytes that start a sequence not complete at the end of a block
+			const __m256i vMaxComplete = _mm256_setr_epi8(
+				-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				(char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+
+			const char* pStart = pString;
+			__m256i vPrev = _mm256_setzero_si256();
+			__m256i vPrevIncomplete = _mm256_setzero_si256();
+			__m256i vError = _mm256_setzero_si256();
+			while (pEnd - pString >= 32)
+			{
+				__m256i vChars = _mm256_loadu_si256((const __m256i*)pString);
+				if (_mm256_movemask_epi8(vChars) == 0)
+				{
+					vError = _mm256_or_si256(vError, vPrevIncomplete);
+					vPrevIncomplete = _mm256_setzero_si256();
+				}
+				else
+				{
+					vError = _mm256_or_si256(vError, Utf8CheckBlock(vChars, vPrev));
+					vPrevIncomplete = _mm256_subs_epu8(vChars, vMaxComplete);
+				}
+				if (_mm256_testz_si256(vError, vError) == 0)
+					break;
+				vPrev = vChars;
+				pString += 32;
+			}
+
+			if (_mm256_testz_si256(vError, vError) != 0)
+			{
+				// Tail is checked from a null padded copy, nulls fail incomplete sequences
+				char pTail[32];
+				memset(pTail, 0, sizeof(pTail));
+				memcpy(pTail, pString, pEnd - pString);
+				__m256i vChars = _mm256_loadu_si256((const __m256i*)pTail);
+				vError = Utf8CheckBlock(vChars, vPrev);
+				if (_mm256_testz_si256(vError, vError) != 0)
+					return pEnd;
+			}
+
+			// Locate the error with the scalar path, from the start of the last sequence of the previous block
+			const char* pFrom = pString - pStart >= 3 ? pString - 3 : pStart;
+			while (pFrom != pStart && ((unsigned char)*pFrom & 0xC0) == 0x80)
+				--pFrom;
+			return FindInvalidUtf8Scalar(pFrom, pEnd);
+		}
+#endif //STTHM_AVX2
+
+		FindInvalidUtf8Func GetFindInvalidUtf8Func()
+		{
+#if defined(STTHM_AVX2)
+			if (HasAVX2())
+				return FindInvalidUtf8AVX2;
+#endif //STTHM_AVX2
+#if defined(STTHM_SSSE3)
+			if (HasSSSE3())
+				return FindInvalidUtf8SSSE3;
+#endif //STTHM_SSSE3
+#if defined(STTHM_SSE2)
+			return FindInvalidUtf8SSE2;
+#else
+			return FindInvalidUtf8Scalar;
+#endif //STTHM_SSE2
+		}
+
+		// Returns pointer to the first invalid UTF-8 sequence of [pString, pString + iLength), or NULL
+		const char* FindInvalidUtf8(const char* pString, size_t iLength)
+		{
+			static const FindInvalidUtf8Func s_pFindInvalidUtf8 = GetFindInvalidUtf8Func();
+			const char* pEnd = pString + iLength;
+			const char* pInvalid = s_pFindInvalidUtf8(pString, pEnd);
+			return pInvalid != pEnd ? pInvalid : NULL;
+		}
+
+		// Returns mask of characters escaped by a backslash, iPrevEscaped carries over to next block
+		inline uint64_t FindEscaped(uint64_t iBackslash, uint64_t& iPrevEscaped)
+		{
+			const uint64_t c_iEvenBits = 0x5555555555555555ULL;
+			iBackslash &= ~iPrevEscaped;
+			uint64_t iFollowsEscape = (iBackslash << 1) | iPrevEscaped;
+			uint64_t iOddSequenceStarts = iBackslash & ~c_iEvenBits & ~iFollowsEscape;
+			uint64_t iSequencesStartingOnEvenBits = iOddSequenceStarts + iBackslash;
+			iPrevEscaped = (iSequencesStartingOnEvenBits < iOddSequenceStarts) ? 1 : 0;
+			uint64_t iInvertMask = iSequencesStartingOnEvenBits << 1;
+			return (c_iEvenBits ^ iInvertMask) & iFollowsEscape;
+		}
+
+		inline uint64_t PrefixXor(uint64_t iMask)
+		{
+			iMask ^= iMask << 1;
+			iMask ^= iMask << 2;
+			iMask ^= iMask << 4;
+			iMask ^= iMask << 8;
+			iMask ^= iMask << 16;
+			iMask ^= iMask << 32;
+			return iMask;
+		}
+
+		// Fill oIndex with offsets of operators, opening quotes and scalar starts,
+		// followed by a sentinel offset equal to iLength
+		bool BuildStructuralIndex(const char* pJson, size_t iLength, Buffer<uint32_t>& oIndex)
+		{
+			if (iLength >= 0xFFFFFFFF)
+				return false;
+
+			static const ClassifyBlockFunc s_pClassifyBlock = GetClassifyBlockFunc();
+
+			uint64_t iPrevEscaped = 0;
+			uint64_t iPrevInString = 0;
+			uint64_t iPrevScalar = 0;
+			char pTail[64];
+
+			// Every block can write 64 offsets, capacity is kept ahead so the output is never resized in the loop
+			oIndex.Clear();
+			if (oIndex.Capacity() < iLength / 2 + 128)
+				oIndex.Reserve(iLength / 2 + 128);
+			uint32_t* pOut = oIndex.Data();
+			uint32_t* pOutEnd = pOut + oIndex.Capacity() - 64;
+			for (size_t iBlock = 0; iBlock < iLength; iBlock += 64)
+			{
+				const char* pBlock = pJson + iBlock;
+				if (iLength - iBlock < 64)
+				{
+					memset(pTail, ' ', 64);
+					memcpy(pTail, pBlock, iLength - iBlock);
+					pBlock = pTail;
+				}
+
+				BlockMasks oMasks;
+				s_pClassifyBlock(pBlock, oMasks);
+
+				uint64_t iEscaped = FindEscaped(oMasks.iBackslash, iPrevEscaped);
+				uint64_t iQuote = oMasks.iQuote & ~iEscaped;
+				uint64_t iInString = PrefixXor(iQuote) ^ iPrevInString;
+				iPrevInString = (uint64_t)((int64_t)iInString >> 63);
+
+				uint64_t iScalar = ~(oMasks.iOperator | oMasks.iWhitespace);
+				uint64_t iNonQuoteScalar = iScalar & ~iQuote;
+				uint64_t iFollowsNonQuoteScalar = (iNonQuoteScalar << 1) | iPrevScalar;
+				iPrevScalar = iNonQuoteScalar >> 63;
+
+				uint64_t iStructurals = (oMasks.iOperator | (iScalar & ~iFollowsNonQuoteScalar)) & ~(iInString ^ iQuote);
+
+				if (pOut > pOutEnd)
+				{
+					oIndex.Resize(pOut - oIndex.Data());
+					oIndex.Reserve(oIndex.Capacity() * 2);
+					pOut = oIndex.Data() + oIndex.Size();
+					pOutEnd = oIndex.Data() + oIndex.Capacity() - 64;
+				}
+
+				// Four offsets per iteration without a branch between them, extra ones are
+				// overwritten by the next block. The high guard bit keeps the count defined on 0.
+				const uint64_t c_iGuard = (uint64_t)1 << 63;
+				const uint32_t iBase = (uint32_t)iBlock;
+				uint32_t* pBlockEnd = pOut + PopCount(iStructurals);
+				while (iStructurals != 0)
+				{
+					pOut[0] = iBase + CountTrailingZeros(iStructurals | c_iGuard);
+					iStructurals &= iStructurals - 1;
+					pOut[1] = iBase + CountTrailingZeros(iStructurals | c_iGuard);
+					iStructurals &= iStructurals - 1;
+					pOut[2] = iBase + CountTrailingZeros(iStructurals | c_iGuard);
+					iStructurals &= iStructurals - 1;
+					pOut[3] = iBase + CountTrailingZeros(iStructurals | c_iGuard);
+					iStructurals &= iStructurals - 1;
+					pOut += 4;
+				}
+				pOut = pBlockEnd;
+			}
+			oIndex.Resize(pOut - oIndex.Data());
+			oIndex.Push((uint32_t)iLength);
+			return true;
+		}
+
+		// Whole content of a file followed by a null terminator, mapped in memory when possible
+		class FileContent
+		{
+		public:
+			FileContent()
+				: m_pData(NULL)
+				, m_iSize(0)
+				, m_bMapped(false)
+			{
+			}
+
+			~FileContent()
+			{
+				Release();
+			}
+
+			// Returns 0 on success, -1 when the file can't be opened or -2 when memory can't be allocated
+			int Load(const char* pFilename, bool bAllowMapping)
+			{
+				Release();
+#ifdef STTHM_FILE_MAPPING
+				if (bAllowMapping)
+				{
+					int iFile = open(pFilename, O_RDONLY);
+					if (iFile < 0)
+						return -1;
+
+					struct stat oStat;
+					if (fstat(iFile, &oStat) == 0 && oStat.st_size > 0 && (uint64_t)oStat.st_size < (uint64_t)(size_t)-1)
+					{
+						// The end of the last page is zero filled and acts as null terminator,
+						// a file filling exactly its pages has none and is read instead
+						size_t iSize = (size_t)oStat.st_size;
+						size_t iPageSize = (size_t)sysconf(_SC_PAGESIZE);
+						if ((iSize % iPageSize) != 0)
+						{
+							void* pMapping = mmap(NULL, iSize, PROT_READ, MAP_PRIVATE, iFile, 0);
+							if (pMapping != MAP_FAILED)
+							{
+#ifdef MADV_SEQUENTIAL
+								madvise(pMapping, iSize, MADV_SEQUENTIAL);
+#endif
+								close(iFile);
+								m_pData = (char*)pMapping;
+								m_iSize = iSize;
+								m_bMapped = true;
+								return 0;
+							}
+						}
+					}
+					close(iFile);
+				}
+#else
+				(void)bAllowMapping;
+#endif //STTHM_FILE_MAPPING
+
+				FILE* pFile = fopen(pFilename, "rb");
+				if (NULL == pFile)
+					return -1;
+
+#if defined(_MSC_VER)
+				_fseeki64(pFile, 0, SEEK_END);
+				int64_t iSize = _ftelli64(pFile);
+				_fseeki64(pFile, 0, SEEK_SET);
+#elif defined(__unix__) || defined(__APPLE__)
+				fseeko(pFile, 0, SEEK_END);
+				int64_t iSize = (int64_t)ftello(pFile);
+				fseeko(pFile, 0, SEEK_SET);
+#else
+				fseek(pFile, 0, SEEK_END);
+				int64_t iSize = ftell(pFile);
+				fseek(pFile, 0, SEEK_SET);
+#endif
+				if (iSize < 0 || (uint64_t)iSize >= (uint64_t)(size_t)-1)
+				{
+					fclose(pFile);
+					return -2;
+				}
+
+				m_pData = (char*)JsonStthmMalloc((size_t)iSize + 1);
+				if (m_pData == NULL)
+				{
+					fclose(pFile);
+					return -2;
+				}
+
+				m_iSize = fread(m_pData, 1, (size_t)iSize, pFile);
+				fclose(pFile);
+				m_pData[m_iSize] = 0;
+				return 0;
+			}
+
+			void Release()
+			{
+				if (m_pData != NULL)
+				{
+#ifdef STTHM_FILE_MAPPING
+					if (m_bMapped)
+						munmap(m_pData, m_iSize);
+					else
+#endif //STTHM_FILE_MAPPING
+						JsonStthmFree(m_pData);
+				}
+				m_pData = NULL;
+				m_iSize = 0;
+				m_bMapped = false;
+			}
+
+			const char* Data() const { return m_pData; }
+			size_t Size() const { return m_iSize; }
+		protected:
+			char*	m_pData;
+			size_t	m_iSize;
+			bool	m_bMapped;
+		};
+
+		// Chars of numbers and literals
+		inline bool IsScalarChar(char cChar)
+		{
+			return (cChar >= '0' && cChar <= '9') || (cChar >= 'a' && cChar <= 'z') || (cChar >= 'A' && cChar <= 'Z')
+				|| cChar == '-' || cChar == '+' || cChar == '.';
+		}
+
+		// Number or literal read by ReadScalar
+		struct Scalar
+		{
+			JsonValue::EType	eType;
+			bool				bBoolean;
+			int64_t				iInteger;
+			double				fFloat;
+		};
+
+		// Read a number, true, false, null, NaN or Infinity, returns false when there is none at pString
+		bool ReadScalar(const char*& pString, Scalar& oScalar)
+		{
+			switch (*pString)
+			{
+			case 't':
+				oScalar.eType = JsonValue::E_TYPE_BOOLEAN;
+				oScalar.bBoolean = true;
+				return MatchLiteral(pString, "true", 4);
+			case 'f':
+				oScalar.eType = JsonValue::E_TYPE_BOOLEAN;
+				oScalar.bBoolean = false;
+				return MatchLiteral(pString, "false", 5);
+			case 'n':
+				oScalar.eType = JsonValue::E_TYPE_NULL;
+				return MatchLiteral(pString, "null", 4);
+			case 'N':
+				oScalar.eType = JsonValue::E_TYPE_FLOAT;
+				oScalar.fFloat = c_fNaN;
+				return MatchLiteral(pString, "NaN", 3);
+			case 'I':
+				oScalar.eType = JsonValue::E_TYPE_FLOAT;
+				oScalar.fFloat = c_fInfinity;
+				return MatchLiteral(pString, "Infinity", 8);
+			case '-':
+				if (pString[1] == 'I')
+				{
+					oScalar.eType = JsonValue::E_TYPE_FLOAT;
+					oScalar.fFloat = c_fNegativeInfinity;
+					return MatchLiteral(pString, "-Infinity", 9);
+				}
+				break;
+			default:
+				break;
+			}
+
+			switch (ParseNumber(pString, oScalar.iInteger, oScalar.fFloat))
+			{
+			case E_NUMBER_INTEGER:
+				oScalar.eType = JsonValue::E_TYPE_INTEGER;
+				return true;
+			case E_NUMBER_FLOAT:
+				oScalar.eType = JsonValue::E_TYPE_FLOAT;
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		// Read a scalar which must not run into other scalar chars, as scalar bounds are not known by JsonLazyDoc
+		bool ReadScalarToken(const char* pString, Scalar& oScalar)
+		{
+			return ReadScalar(pString, oScalar) && IsScalarChar(*pString) == false;
+		}
+
+		// First char of a value in a structural index
+		inline bool IsValueStart(char cChar)
+		{
+			return cChar != 0 && cChar != ',' && cChar != ':' && cChar != ']' && cChar != '}';
+		}
+
+		JsonSaxHandler::EAction SendScalar(const Scalar& oScalar, JsonSaxHandler& oHandler)
+		{
+			switch (oScalar.eType)
+			{
+			case JsonValue::E_TYPE_BOOLEAN:
+				return oHandler.Boolean(oScalar.bBoolean);
+			case JsonValue::E_TYPE_INTEGER:
+				return oHandler.Integer(oScalar.iInteger);
+			case JsonValue::E_TYPE_FLOAT:
+				return oHandler.Float(oScalar.fFloat);
+			default:
+				return oHandler.Null();
+			}
+		}
+
+		// FNV-1a
+		uint32_t HashMemberName(const char* pName)
+		{
+			uint32_t iHash = 2166136261u;
+			while (*pName != 0)
+			{
+				iHash ^= (uint8_t)*pName++;
+				iHash *= 16777619u;
+			}
+			return iHash;
+		}
+	}
+
+	//////////////////////////////
+	// JsonPathSet
+	//////////////////////////////
+
+	JsonPathSet::JsonPathSet()
+	{
+		Clear();
+	}
+
+	bool JsonPathSet::Add(const char* pPath)
+	{
+		if (pPath == NULL || (*pPath != 0 && *pPath != '/'))
+			return false;
+
+		// Check escapes first to never leave a partial path
+		for (const char* pChar = pPath; *pChar != 0; ++pChar)
+		{
+			if (*pChar == '~' && pChar[1] != '0' && pChar[1] != '1')
+				return false;
+		}
+
+		uint32_t iNode = 0;
+		while (*pPath == '/')
+		{
+			const char* pToken = ++pPath;
+			while (*pPath != 0 && *pPath != '/')
+				++pPath;
+			iNode = AddChild(iNode, pToken, pPath - pToken);
+		}
+		m_oNodes.Data()[iNode].m_bLeaf = true;
+		return true;
+	}
+
+	void JsonPathSet::Clear()
+	{
+		m_oNodes.Clear();
+		m_oNames.Clear();
+		m_oNames.Push('\0');
+
+		Node oRoot;
+		memset(&oRoot, 0, sizeof(Node));
+		oRoot.m_iIndex = -1;
+		m_oNodes.Push(oRoot);
+	}
+
+	uint32_t JsonPathSet::AddChild(uint32_t iParent, const char* pToken, size_t iLength)
+	{
+		Node oNode;
+		memset(&oNode, 0, sizeof(Node));
+		oNode.m_iName = (uint32_t)m_oNames.Size();
+		oNode.m_iIndex = -1;
+		oNode.m_bWildcard = iLength == 1 && *pToken == '*';
+
+		for (size_t i = 0; i < iLength; ++i)
+		{
+			if (pToken[i] == '~')
+				m_oNames.Push(pToken[++i] == '0' ? '~' : '/');
+			else
+				m_oNames.Push(pToken[i]);
+		}
+		m_oNames.Push('\0');
+
+		const char* pName = GetName(oNode);
+		for (uint32_t iChild = m_oNodes.Data()[iParent].m_iFirstChild; iChild != 0; iChild = m_oNodes.Data()[iChild].m_iNextSibling)
+		{
+			const Node& oChild = m_oNodes.Data()[iChild];
+			if (oChild.m_bWildcard == oNode.m_bWildcard && strcmp(GetName(oChild), pName) == 0)
+			{
+				m_oNames.Resize(oNode.m_iName);
+				return iChild;
+			}
+		}
+
+		// Decimal without leading zero also matches an array index
+		if (iLength > 0 && iLength <= 18 && (pName[0] != '0' || iLength == 1))
+		{
+			int64_t iIndex = 0;
+			size_t i = 0;
+			while (i < iLength && pName[i] >= '0' && pName[i] <= '9')
+				iIndex = iIndex * 10 + (pName[i++] - '0');
+			if (i == iLength)
+				oNode.m_iIndex = iIndex;
+		}
+
+		uint32_t iNode = (uint32_t)m_oNodes.Size();
+		oNode.m_iNextSibling = m_oNodes.Data()[iParent].m_iFirstChild;
+		m_oNodes.Push(oNode);
+		m_oNodes.Data()[iParent].m_iFirstChild = iNode;
+		return iNode;
+	}
+
+	//////////////////////////////
+	// JsonPath
+	//////////////////////////////
+
+	JsonPath::JsonPath()
+		: m_bValid(false)
+		, m_bSingle(true)
+	{
+	}
+
+	JsonPath::JsonPath(const char* pPath)
+		: m_bValid(false)
+		, m_bSingle(true)
+	{
+		Compile(pPath);
+	}
+
+	bool JsonPath::Compile(const char* pPath)
+	{
+		m_oSegments.Clear();
+		m_oNames.Clear();
+		m_bValid = false;
+		m_bSingle = true;
+		if (pPath == NULL || (*pPath != 0 && *pPath != '/'))
+			return false;
+
+		while (*pPath == '/')
+		{
+			const char* pToken = ++pPath;
+			while (*pPath != 0 && *pPath != '/')
+				++pPath;
+
+			Segment oSegment;
+			memset(&oSegment, 0, sizeof(Segment));
+			oSegment.m_iIndex = -1;
+			if (pPath - pToken == 1 && *pToken == '*')
+			{
+				oSegment.m_eType = E_SEGMENT_WILDCARD;
+				m_bSingle = false;
+			}
+			else if (*pToken == '?')
+			{
+				const char* pEqual = pToken + 1;
+				while (pEqual != pPath && *pEqual != '=')
+					++pEqual;
+				if (pEqual == pPath || PushToken(pToken + 1, pEqual, oSegment.m_iName) == false || PushToken(pEqual + 1, pPath, oSegment.m_iString) == false)
+					return false;
+
+				oSegment.m_eType = E_SEGMENT_FILTER;
+				oSegment.m_iHash = Internal::HashMemberName(GetName(oSegment.m_iName));
+
+				// A string unless the whole value is a scalar literal
+				Internal::Scalar oScalar;
+				memset(&oScalar, 0, sizeof(oScalar));
+				const char* pValue = GetName(oSegment.m_iString);
+				oSegment.m_eValueType = JsonValue::E_TYPE_STRING;
+				if (Internal::ReadScalar(pValue, oScalar) && *pValue == 0)
+				{
+					oSegment.m_eValueType = oScalar.eType;
+					oSegment.m_bBoolean = oScalar.bBoolean;
+					oSegment.m_iInteger = oScalar.iInteger;
+					oSegment.m_fFloat = oScalar.fFloat;
+				}
+				m_bSingle = false;
+			}
+			else
+			{
+				if (PushToken(pToken, pPath, oSegment.m_iName) == false)
+					return false;
+
+				oSegment.m_eType = E_SEGMENT_NAME;
+				const char* pName = GetName(oSegment.m_iName);
+				oSegment.m_iHash = Internal::HashMemberName(pName);
+
+				// Decimal without leading zero also matches an array index
+				size_t iLength = strlen(pName);
+				if (iLength > 0 && iLength <= 9 && (pName[0] != '0' || iLength == 1))
+				{
+					int iIndex = 0;
+					size_t i = 0;
+					while (i < iLength && pName[i] >= '0' && pName[i] <= '9')
+						iIndex = iIndex * 10 + (pName[i++] - '0');
+					if (i == iLength)
+						oSegment.m_iIndex = iIndex;
+				}
+			}
+			m_oSegments.Push(oSegment);
+		}
+
+		m_bValid = true;
+		return true;
+	}
+
+	const JsonValue& JsonPath::Find(const JsonValue& oRoot) const
+	{
+		if (m_bValid == false)
+			return JsonValue::INVALID;
+
+		if (m_bSingle)
+		{
+			const JsonValue* pValue = &oRoot;
+			for (size_t i = 0; i < m_oSegments.Size() && pValue != NULL; ++i)
+				pValue = Step(pValue, m_oSegments.Data()[i]);
+			return pValue != NULL ? *pValue : JsonValue::INVALID;
+		}
+
+		const JsonValue* pFound = &JsonValue::INVALID;
+		int iCount = 0;
+		Walk(oRoot, 0, &JsonPath::StoreFirst, &pFound, iCount);
+		return *pFound;
+	}
+
+	const JsonValue& JsonPath::Find(const JsonDoc& oDoc) const
+	{
+		return Find(oDoc.GetRoot());
+	}
+
+	int JsonPath::FindAll(const JsonValue& oRoot, MatchCallback pCallback, void* pUserData) const
+	{
+		int iCount = 0;
+		if (m_bValid)
+			Walk(oRoot, 0, pCallback, pUserData, iCount);
+		return iCount;
+	}
+
+	void JsonPath::FindBatch(const JsonValue* const* pRoots, size_t iCount, const JsonValue** pResults) const
+	{
+		if (m_bValid == false || m_bSingle == false)
+		{
+			for (size_t i = 0; i < iCount; ++i)
+				pResults[i] = &Find(*pRoots[i]);
+			return;
+		}
+
+		// Documents are walked by small groups, one segment at a time for the whole group,
+		// so the cache misses of independent documents overlap
+		const size_t c_iGroupSize = 8;
+		for (size_t iGroup = 0; iGroup < iCount; iGroup += c_iGroupSize)
+		{
+			const size_t iGroupEnd = (iGroup + c_iGroupSize < iCount) ? iGroup + c_iGroupSize : iCount;
+			for (size_t i = iGroup; i < iGroupEnd; ++i)
+			{
+				pResults[i] = pRoots[i];
+				if (i + c_iGroupSize < iCount)
+					STTHM_PREFETCH(pRoots[i + c_iGroupSize]);
+			}
+
+			for (size_t iSegment = 0; iSegment < m_oSegments.Size(); ++iSegment)
+			{
+				const Segment& oSegment = m_oSegments.Data()[iSegment];
+				for (size_t i = iGroup; i < iGroupEnd; ++i)
+				{
+					if (pResults[i] != NULL)
+						pResults[i] = Step(pResults[i], oSegment);
+				}
+			}
+		}
+
+		for (size_t i = 0; i < iCount; ++i)
+		{
+			if (pResults[i] == NULL)
+				pResults[i] = &JsonValue::INVALID;
+		}
+	}
+
+	bool JsonPath::PushToken(const char* pBegin, const char* pEnd, uint32_t& iOffset)
+	{
+		iOffset = (uint32_t)m_oNames.Size();
+		for (const char* pChar = pBegin; pChar != pEnd; ++pChar)
+		{
+			if (*pChar == '~')
+			{
+				if (pChar + 1 == pEnd || (pChar[1] != '0' && pChar[1] != '1'))
+					return false;
+				m_oNames.Push(*++pChar == '0' ? '~' : '/');
+			}
+			else
+			{
+				m_oNames.Push(*pChar);
+			}
+		}
+		m_oNames.Push('\0');
+		return true;
+	}
+
+	const JsonValue* JsonPath::Step(const JsonValue* pValue, const Segment& oSegment) const
+	{
+		if (pValue->m_eType == JsonValue::E_TYPE_OBJECT)
+			return pValue->FindMember(GetName(oSegment.m_iName), oSegment.m_iHash);
+		if (pValue->m_eType == JsonValue::E_TYPE_ARRAY)
+			return pValue->FindChild(oSegment.m_iIndex);
+		return NULL;
+	}
+
+	bool JsonPath::MatchFilter(const JsonValue& oValue, const Segment& oSegment) const
+	{
+		if (oValue.m_eType != JsonValue::E_TYPE_OBJECT)
+			return false;
+
+		const JsonValue* pMember = oValue.FindMember(GetName(oSegment.m_iName), oSegment.m_iHash);
+		if (pMember == NULL)
+			return false;
+
+		switch (oSegment.m_eValueType)
+		{
+		case JsonValue::E_TYPE_STRING:
+			return pMember->IsString() && strcmp(pMember->m_oValue.String, GetName(oSegment.m_iString)) == 0;
+		case JsonValue::E_TYPE_BOOLEAN:
+			return pMember->IsBoolean() && pMember->m_oValue.Boolean == oSegment.m_bBoolean;
+		case JsonValue::E_TYPE_INTEGER:
+			if (pMember->IsInteger())
+				return pMember->m_oValue.Integer == oSegment.m_iInteger;
+			return pMember->IsFloat() && pMember->m_oValue.Float == (double)oSegment.m_iInteger;
+		case JsonValue::E_TYPE_FLOAT:
+			return pMember->IsNumeric() && pMember->ToFloat() == oSegment.m_fFloat;
+		default:
+			return pMember->IsNull();
+		}
+	}
+
+	bool JsonPath::Walk(const JsonValue& oValue, size_t iSegment, MatchCallback pCallback, void* pUserData, int& iCount) const
+	{
+		if (iSegment == m_oSegments.Size())
+		{
+			++iCount;
+			return pCallback == NULL || pCallback(oValue, pUserData);
+		}
+
+		const Segment& oSegment = m_oSegments.Data()[iSegment];
+		if (oSegment.m_eType == E_SEGMENT_NAME)
+		{
+			const JsonValue* pChild = Step(&oValue, oSegment);
+			return pChild == NULL || Walk(*pChild, iSegment + 1, pCallback, pUserData, iCount);
+		}
+
+		if (oValue.IsContainer() == false)
+			return true;
+
+		for (const JsonValue* pChild = oValue.m_oValue.Childs.m_pFirst; pChild != NULL; pChild = pChild->m_pNext)
+		{
+			if (oSegment.m_eType == E_SEGMENT_WILDCARD || MatchFilter(*pChild, oSegment))
+			{
+				if (Walk(*pChild, iSegment + 1, pCallback, pUserData, iCount) == false)
+					return false;
+			}
+		}
+		return true;
+	}
+
+	bool JsonPath::StoreFirst(const JsonValue& oValue, void* pUserData)
+	{
+		*(const JsonValue**)pUserData = &oValue;
+		return false;
+	}
+
+	//////////////////////////////
+	// JsonValue::ChildIndex
+	//////////////////////////////
+
+	// Open addressing table of members, slots are stored right after the header
+	struct JsonValue::ChildIndex
+	{
+		struct Slot
+		{
+			uint32_t		m_iHash;
+			JsonValue*		m_pValue;
+		};
+
+		uint32_t			m_iCapacity; // Power of two
+		uint32_t			m_iCount;
+
+		Slot*				Slots() { return (Slot*)(this + 1); }
+
+		static ChildIndex*	Create(Allocator* pAllocator, uint32_t iCapacity)
+		{
+			ChildIndex* pIndex = (ChildIndex*)pAllocator->AllocMemory(sizeof(ChildIndex) + iCapacity * sizeof(Slot), pAllocator->pUserData);
+			pIndex->m_iCapacity = iCapacity;
+			pIndex->m_iCount = 0;
+			memset(pIndex->Slots(), 0, iCapacity * sizeof(Slot));
+			return pIndex;
+		}
+
+		JsonValue*			Find(const char* pName, uint32_t iHash)
+		{
+			Slot* pSlots = Slots();
+			uint32_t iMask = m_iCapacity - 1;
+			for (uint32_t iPos = iHash & iMask; pSlots[iPos].m_pValue != NULL; iPos = (iPos + 1) & iMask)
+			{
+				if (pSlots[iPos].m_iHash == iHash && strcmp(pSlots[iPos].m_pValue->m_pName, pName) == 0)
+					return pSlots[iPos].m_pValue;
+			}
+			return NULL;
+		}
+
+		// Keep the first member when names are duplicated, like the linear lookup
+		void				Insert(JsonValue* pValue, uint32_t iHash)
+		{
+			Slot* pSlots = Slots();
+			uint32_t iMask = m_iCapacity - 1;
+			uint32_t iPos = iHash & iMask;
+			for (; pSlots[iPos].m_pValue != NULL; iPos = (iPos + 1) & iMask)
+			{
+				if (pSlots[iPos].m_iHash == iHash && strcmp(pSlots[iPos].m_pValue->m_pName, pValue->m_pName) == 0)
+					return;
+			}
+			pSlots[iPos].m_iHash = iHash;
+			pSlots[iPos].m_pValue = pValue;
+			++m_iCount;
+		}
+
+		// Backward shift deletion, following slots are moved into the hole when their probe went past it
+		void				Remove(JsonValue* pValue, uint32_t iHash)
+		{
+			Slot* pSlots = Slots();
+			uint32_t iMask = m_iCapacity - 1;
+			uint32_t iHole = iHash & iMask;
+			for (; pSlots[iHole].m_pValue != pValue; iHole = (iHole + 1) & iMask)
+			{
+				if (pSlots[iHole].m_pValue == NULL)
+					return;
+			}
+
+			for (uint32_t iPos = (iHole + 1) & iMask; pSlots[iPos].m_pValue != NULL; iPos = (iPos + 1) & iMask)
+			{
+				uint32_t iHome = pSlots[iPos].m_iHash & iMask;
+				if (((iPos - iHome) & iMask) >= ((iPos - iHole) & iMask))
+				{
+					pSlots[iHole] = pSlots[iPos];
+					iHole = iPos;
+				}
+			}
+			pSlots[iHole].m_pValue = NULL;
+			--m_iCount;
+		}
+	};
+
+	//////////////////////////////
+	// JsonValue::ChildArray
+	//////////////////////////////
+
+	// Vector of childs of an array, pointers are stored right after the header
+	struct JsonValue::ChildArray
+	{
+		size_t				m_iCapacity;
+
+		JsonValue**			Values() { return (JsonValue**)(this + 1); }
+
+		static ChildArray*	Create(Allocator* pAllocator, size_t iCapacity)
+		{
+			ChildArray* pArray = (ChildArray*)pAllocator->AllocMemory(sizeof(ChildArray) + iCapacity * sizeof(JsonValue*), pAllocator->pUserData);
+			pArray->m_iCapacity = iCapacity;
+			return pArray;
+		}
+	};
+
+	//////////////////////////////
+	// JsonValue::Iterator
+	//////////////////////////////
+
+	JsonValue::Iterator::Iterator(const JsonValue* pJson)
+	{
+		if (pJson != NULL && pJson->IsContainer())
+		{
+			m_pChild = pJson->m_oValue.Childs.m_pFirst;
+		}
+		else
+		{
+			m_pChild = NULL;
+		}
+	}
+
+	JsonValue::Iterator::Iterator(const Iterator& oIt)
+	{
+		m_pChild = oIt.m_pChild;
+	}
+
+	bool JsonValue::Iterator::IsValid() const
+	{
+		return m_pChild != NULL;
+	}
+
+	bool JsonValue::Iterator::operator!=(const Iterator& oIte) const
+	{
+		return m_pChild != oIte.m_pChild;
+	}
+
+	void JsonValue::Iterator::operator++()
+	{
+		if (m_pChild != NULL)
+			m_pChild = m_pChild->m_pNext;
+	}
+
+	JsonValue& JsonValue::Iterator::operator*() const
+	{
+		return m_pChild != NULL ? *m_pChild : INVALID;
+	}
+
+	JsonValue* JsonValue::Iterator::operator->() const
+	{
+		return m_pChild;
+	}
+
+	//////////////////////////////
+	// JsonValue
+	//////////////////////////////
+
+	JsonValue JsonValue::INVALID;
+
+	Allocator JsonValue::s_oDefaultAllocator = {
+		JsonValue::DefaultAllocatorCreateJsonValue,
+		JsonValue::DefaultAllocatorDeleteJsonValue,
+		JsonValue::DefaultAllocatorAllocString,
+		JsonValue::DefaultAllocatorFreeString,
+		NULL,
+		JsonValue::DefaultAllocatorAllocMemory,
+		JsonValue::DefaultAllocatorFreeMemory
+	};
+
+	JsonValue::JsonValue(Allocator* pAllocator)
+		: m_pAllocator(pAllocator)
+		, m_eType(E_TYPE_NULL)
+		, m_pName(NULL)
+		, m_pNext(NULL)
+	{
+		JsonStthmAssert(m_pAllocator != NULL);
+	}
+
+	JsonValue::JsonValue()
+		: m_pAllocator(&s_oDefaultAllocator)
+		, m_eType(E_TYPE_NULL)
+		, m_pName(NULL)
+		, m_pNext(NULL)
+	{
+	}
+
+	JsonValue::JsonValue(const JsonValue& oSource)
+		: m_pAllocator(&s_oDefaultAllocator)
+		, m_eType(E_TYPE_NULL)
+		, m_pName(NULL)
+		, m_pNext(NULL)
+	{
+		*this = oSource;
+	}
+
+	JsonValue::JsonValue(JsonValue&& oSource) noexcept
+		: m_pAllocator(&s_oDefaultAllocator)
+		, m_eType(E_TYPE_NULL)
+		, m_pName(NULL)
+		, m_pNext(NULL)
+	{
+		*this = std::move(oSource);
+	}
+
+	JsonValue::JsonValue(bool bValue)
+		: m_pAllocator(&s_oDefaultAllocator)
+		, m_eType(E_TYPE_NULL)
+		, m_pName(NULL)
+		, m_pNext(NULL)
+	{
+		*this = bValue;
+	}
+
+#ifdef JsonStthmString
+	JsonValue::JsonValue(const JsonStthmString& sValue)
+		: m_pAllocator(&s_oDefaultAllocator)
+		, m_eType(E_TYPE_NULL)
+		, m_pName(NULL)
+		, m_pNext(NULL)
+	{
+		*this = sValue;
+	}
+#endif //JsonStthmString
+
+	JsonValue::JsonValue(const char* pValue)
+		: m_pAllocator(&s_oDefaultAllocator)
+		, m_eType(E_TYPE_NULL)
+		, m_pName(NULL)
+		, m_pNext(NULL)
+	{
+		*this = pValue;
+	}
+
+	JsonValue::JsonValue(int64_t iValue)
+		: m_pAllocator(&s_oDefaultAllocator)
+		, m_eType(E_TYPE_NULL)
+		, m_pName(NULL)
+		, m_pNext(NULL)
+	{
+		*this = iValue;
+	}
+
+	JsonValue::JsonValue(double fValue)
+		: m_pAllocator(&s_oDefaultAllocator)
+		, m_eType(E_TYPE_NULL)
+		, m_pName(NULL)
+		, m_pNext(NULL)
+	{
+		*this = fValue;
+	}
+
+	JsonValue::~JsonValue()
+	{
+		if (m_pName != NULL)
+		{
+			m_pAllocator->FreeString(m_pName, m_pAllocator->pUserData);
+			m_pName = NULL;
+		}
+		Reset();
+	}
+
+	void JsonValue::InitType(EType eType)
+	{
+		if (m_eType == E_TYPE_OBJECT || m_eType == E_TYPE_ARRAY || m_eType == E_TYPE_STRING)
+			Reset();
+
+		if (m_eType != eType)
+		{
+			m_eType = eType;
+			switch (eType)
+			{
+			case E_TYPE_OBJECT:
+			case E_TYPE_ARRAY:
+				m_iChildCount = 0;
+				m_oValue.Childs.m_pFirst = NULL;
+				m_oValue.Childs.m_pLast = NULL;
+				m_oValue.Childs.m_pIndex = NULL;
+				break;
+			case E_TYPE_STRING:
+				m_oValue.String = NULL;
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	void JsonValue::Reset()
+	{
+		switch (m_eType)
+		{
+		case E_TYPE_OBJECT:
+		case E_TYPE_ARRAY:
+		{
+			JsonValue* pChild = m_oValue.Childs.m_pFirst;
+			while (pChild != NULL)
+			{
+				JsonValue* pTemp = pChild->m_pNext;
+				m_pAllocator->DeleteJsonValue(pChild, m_pAllocator->pUserData);
+				pChild = pTemp;
+			}
+			m_iChildCount = 0;
+			m_oValue.Childs.m_pFirst = NULL;
+			m_oValue.Childs.m_pLast = NULL;
+			if (m_oValue.Childs.m_pIndex != NULL) // Or m_pArray
+			{
+				m_pAllocator->FreeMemory(m_oValue.Childs.m_pIndex, m_pAllocator->pUserData);
+				m_oValue.Childs.m_pIndex = NULL;
+			}
+			break;
+		}
+		case E_TYPE_STRING:
+		{
+			m_pAllocator->FreeString(m_oValue.String, m_pAllocator->pUserData);
+			m_oValue.String = NULL;
+			break;
+		}
+		default:
+			break;
+		}
+		m_eType = E_TYPE_NULL;
+	}
+
+	JsonValue::EType JsonValue::GetType() const
+	{
+		return m_eType;
+	}
+
+	void JsonValue::SetStringValue(const char* pString)
+	{
+		JsonStthmAssert(IsString());
+		m_pAllocator->FreeString(m_oValue.String, m_pAllocator->pUserData);
+		m_oValue.String = NULL;
+		if (NULL != pString)
+		{
+			size_t iLen  = 1 + strlen(pString);
+			char* pNewString = m_pAllocator->AllocString(iLen, m_pAllocator->pUserData);
+			memcpy(pNewString, pString, iLen);
+			m_oValue.String = pNewString;
+		}
+	}
+
+	int JsonValue::ReadString(const char* pJson, int iFlags)
+	{
+		if (pJson != NULL)
+		{
+			return Read(pJson, strlen(pJson), iFlags, false);
+		}
+		return -1;
+	}
+
+	int JsonValue::ReadFile(const char* pFilename, int iFlags)
+	{
+		Internal::FileContent oContent;
+		int iResult = oContent.Load(pFilename, (iFlags & E_READ_NO_FILE_MAPPING) == 0);
+		if (iResult != 0)
+			return iResult;
+
+		return Read(oContent.Data(), oContent.Size(), iFlags, false);
+	}
+
+	int JsonValue::ReadString(const char* pJson, const JsonPathSet& oPaths)
+	{
+		if (pJson != NULL)
+		{
+			return ReadProjected(pJson, oPaths);
+		}
+		return -1;
+	}
+
+	int JsonValue::ReadFile(const char* pFilename, const JsonPathSet& oPaths, int iFlags)
+	{
+		Internal::FileContent oContent;
+		int iResult = oContent.Load(pFilename, (iFlags & E_READ_NO_FILE_MAPPING) == 0);
+		if (iResult != 0)
+			return iResult;
+
+		return ReadProjected(oContent.Data(), oPaths);
+	}
+
+	void JsonValue::Write(Internal::CharBuffer& sOutJson, size_t iIndent, bool bCompact, int iFlags) const
+	{
+		JsonTextWriter oWriter(sOutJson, bCompact ? iFlags : (iFlags | E_WRITE_PRETTY));
+		oWriter.m_iBaseIndent = iIndent;
+		oWriter.Value(*this);
+	}
+
+#ifdef JsonStthmString
+	void JsonValue::WriteString(JsonStthmString& sOutJson, bool bCompact, int iFlags) const
+	{
+		Internal::CharBuffer oBuffer;
+		Write(oBuffer, 0, bCompact, iFlags);
+		sOutJson.resize(oBuffer.Size());
+		oBuffer.WriteTo((char*)sOutJson.data());
+	}
+#endif //JsonStthmString
+
+	char* JsonValue::WriteString(bool bCompact, int iFlags) const
+	{
+		Internal::CharBuffer oBuffer;
+		Write(oBuffer, 0, bCompact, iFlags);
+		char* pString = (char*)JsonStthmMalloc(oBuffer.Size() + 1);
+		if (pString != NULL)
+		{
+			oBuffer.WriteTo(pString);
+			pString[oBuffer.Size()] = '\0';
+		}
+		return pString;
+	}
+
+	bool JsonValue::WriteFile(const char* pFilename, bool bCompact, int iFlags) const
+	{
+		FILE* pFile = fopen(pFilename, "w");
+		if (NULL != pFile)
+		{
+			// Streamed through a bounded buffer, the whole text is never in memory
+			bool bRet;
+			{
+				JsonTextWriter oWriter(JsonTextWriter::FileSink, pFile, bCompact ? iFlags : (iFlags | E_WRITE_PRETTY));
+				oWriter.Value(*this);
+				bRet = oWriter.Flush();
+			}
+			bRet = fclose(pFile) == 0 && bRet;
+			return bRet;
+		}
+		return false;
+	}
+
+	int JsonValue::GetMemberCount() const
+	{
+		if (m_eType == E_TYPE_OBJECT || m_eType == E_TYPE_ARRAY)
+			return m_iChildCount;
+		return 0;
+	}
+
+	const char* JsonValue::ToString() const
+	{
+		if (m_eType == E_TYPE_STRING)
+			return m_oValue.String;
+		return NULL;
+	}
+
+	bool JsonValue::ToBoolean() const
+	{
+		if (m_eType == E_TYPE_BOOLEAN)
+			return m_oValue.Boolean;
+		return false;
+	}
+
+	int64_t JsonValue::ToInteger() const
+	{
+		if (m_eType == E_TYPE_INTEGER)
+			return m_oValue.Integer;
+		else if (m_eType == E_TYPE_FLOAT)
+			return (int64_t)m_oValue.Float;
+		return 0;
+	}
+
+	double JsonValue::ToFloat() const
+	{
+		if (m_eType == E_TYPE_FLOAT)
+			return m_oValue.Float;
+		else if (m_eType == E_TYPE_INTEGER)
+			return (double)m_oValue.Integer;
+		return 0.0;
+	}
+
+#ifdef STTHM_ENABLE_IMPLICIT_CAST
+	JsonValue::operator const char*() const
+	{
+		return ToString();
+	}
+
+	JsonValue::operator bool() const
+	{
+		return ToBoolean();
+	}
+
+	JsonValue::operator int64_t() const
+	{
+		return ToInteger();
+	}
+
+	JsonValue::operator double() const
+	{
+		return ToFloat();
+	}
+#endif //STTHM_ENABLE_IMPLICIT_CAST
+
+	void JsonValue::SetString(const char* pValue)
+	{
+		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
+		if (this == &JsonStthm::JsonValue::INVALID)
+			return;
+
+		if (NULL != pValue)
+		{
+			InitType(E_TYPE_STRING);
+			SetStringValue(pValue);
+		}
+		else
+		{
+			InitType(E_TYPE_NULL);
+		}
+	}
+
+	void JsonValue::SetBoolean(bool bValue)
+	{
+		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
+		if (this == &JsonStthm::JsonValue::INVALID)
+			return;
+
+		InitType(E_TYPE_BOOLEAN);
+		m_oValue.Boolean = bValue;
+	}
+
+	void JsonValue::SetInteger(int64_t iValue)
+	{
+		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
+		if (this == &JsonStthm::JsonValue::INVALID)
+			return;
+
+		InitType(E_TYPE_INTEGER);
+		m_oValue.Integer = iValue;
+	}
+
+	void JsonValue::SetFloat(double fValue)
+	{
+		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
+		if (this == &JsonStthm::JsonValue::INVALID)
+			return;
+
+		InitType(E_TYPE_FLOAT);
+		m_oValue.Float = fValue;
+	}
+
+	JsonValue& JsonValue::Append()
+	{
+		JsonStthmAssert(this != &INVALID);
+		if (this == &INVALID)
+			return INVALID;
+
+		if (m_eType == E_TYPE_NULL)
+			InitType(E_TYPE_ARRAY);
+
+		if (m_eType != E_TYPE_ARRAY)
+			return INVALID;
+
+		// Append new element
+		JsonValue* pNewChild = m_pAllocator->CreateJsonValue(m_pAllocator, m_pAllocator->pUserData);
+		AppendChild(pNewChild);
+
+		return *m_oValue.Childs.m_pLast;
+	}
+
+	void JsonValue::Swap(JsonValue& oOther)
+	{
+		JsonStthmAssert(this != &INVALID && &oOther != &INVALID);
+		if (this == &INVALID || &oOther == &INVALID || this == &oOther)
+			return;
+
+		if (m_pAllocator == oOther.m_pAllocator)
+		{
+			JsonValue oTemp(m_pAllocator);
+			oTemp.StealValue(*this);
+			StealValue(oOther);
+			oOther.StealValue(oTemp);
+		}
+		else
+		{
+			JsonValue oTemp;
+			oTemp = *this;
+			*this = oOther;
+			oOther = oTemp;
+		}
+	}
+
+	bool JsonValue::Detach(const char* pName, JsonValue& oOut)
+	{
+		JsonValue* pChild = UnlinkMember(pName);
+		if (pChild == NULL)
+			return false;
+
+		oOut = std::move(*pChild);
+		m_pAllocator->DeleteJsonValue(pChild, m_pAllocator->pUserData);
+		return true;
+	}
+
+	bool JsonValue::Detach(int iIndex, JsonValue& oOut)
+	{
+		JsonValue* pChild = UnlinkChild(iIndex);
+		if (pChild == NULL)
+			return false;
+
+		oOut = std::move(*pChild);
+		m_pAllocator->DeleteJsonValue(pChild, m_pAllocator->pUserData);
+		return true;
+	}
+
+	bool JsonValue::Remove(const char* pName)
+	{
+		JsonValue* pChild = UnlinkMember(pName);
+		if (pChild == NULL)
+			return false;
+
+		m_pAllocator->DeleteJsonValue(pChild, m_pAllocator->pUserData);
+		return true;
+	}
+
+	bool JsonValue::Remove(int iIndex)
+	{
+		JsonValue* pChild = UnlinkChild(iIndex);
+		if (pChild == NULL)
+			return false;
+
+		m_pAllocator->DeleteJsonValue(pChild, m_pAllocator->pUserData);
+		return true;
+	}
+
+	JsonValue& JsonValue::Adopt(const char* pName, JsonValue& oValue)
+	{
+		JsonValue& oMember = (*this)[pName];
+		if (oMember.IsValid())
+			oMember = std::move(oValue);
+		return oMember;
+	}
+
+	JsonValue& JsonValue::Adopt(JsonValue& oValue)
+	{
+		JsonValue& oChild = Append();
+		if (oChild.IsValid())
+			oChild = std::move(oValue);
+		return oChild;
+	}
+
+	void JsonValue::AppendChild(JsonValue* pChild)
+	{
+		if (NULL != m_oValue.Childs.m_pLast)
+			m_oValue.Childs.m_pLast->m_pNext = pChild;
+		else
+			m_oValue.Childs.m_pFirst = pChild;
+
+		m_oValue.Childs.m_pLast = pChild;
+
+		if (m_oValue.Childs.m_pIndex != NULL)
+		{
+			if (m_eType == E_TYPE_OBJECT)
+				InsertMemberIndex(pChild);
+			else
+				InsertChildArray(pChild);
+		}
+
+		++m_iChildCount;
+	}
+
+	void JsonValue::RemoveChild(JsonValue* pChild, JsonValue* pPrevious, int iPosition)
+	{
+		if (pPrevious != NULL)
+			pPrevious->m_pNext = pChild->m_pNext;
+		else
+			m_oValue.Childs.m_pFirst = pChild->m_pNext;
+
+		if (m_oValue.Childs.m_pLast == pChild)
+			m_oValue.Childs.m_pLast = pPrevious;
+
+		if (m_oValue.Childs.m_pIndex != NULL)
+		{
+			if (m_eType == E_TYPE_OBJECT)
+			{
+				m_oValue.Childs.m_pIndex->Remove(pChild, Internal::HashMemberName(pChild->m_pName));
+
+				// A later member with the same name was hidden by this one
+				for (JsonValue* pNext = pChild->m_pNext; pNext != NULL; pNext = pNext->m_pNext)
+				{
+					if (strcmp(pNext->m_pName, pChild->m_pName) == 0)
+					{
+						m_oValue.Childs.m_pIndex->Insert(pNext, Internal::HashMemberName(pNext->m_pName));
+						break;
+					}
+				}
+			}
+			else
+			{
+				JsonValue** pValues = m_oValue.Childs.m_pArray->Values();
+				memmove(pValues + iPosition, pValues + iPosition + 1, (size_t)(m_iChildCount - iPosition - 1) * sizeof(JsonValue*));
+			}
+		}
+
+		pChild->m_pNext = NULL;
+		--m_iChildCount;
+	}
+
+	JsonValue* JsonValue::UnlinkMember(const char* pName)
+	{
+		if (m_eType != E_TYPE_OBJECT || pName == NULL)
+			return NULL;
+
+		JsonValue* pPrevious = NULL;
+		int iPosition = 0;
+		for (JsonValue* pChild = m_oValue.Childs.m_pFirst; pChild != NULL; pPrevious = pChild, pChild = pChild->m_pNext, ++iPosition)
+		{
+			if (strcmp(pChild->m_pName, pName) == 0)
+			{
+				RemoveChild(pChild, pPrevious, iPosition);
+				return pChild;
+			}
+		}
+		return NULL;
+	}
+
+	JsonValue* JsonValue::UnlinkChild(int iIndex)
+	{
+		if (IsContainer() == false)
+			return NULL;
+
+		JsonValue* pChild = FindChild(iIndex);
+		if (pChild != NULL)
+			RemoveChild(pChild, iIndex > 0 ? FindChild(iIndex - 1) : NULL, iIndex);
+		return pChild;
+	}
+
+	void JsonValue::StealValue(JsonValue& oSource)
+	{
+		JsonStthmAssert(m_eType == E_TYPE_NULL);
+		m_eType = oSource.m_eType;
+		m_iChildCount = oSource.m_iChildCount;
+		m_oValue = oSource.m_oValue;
+		oSource.m_eType = E_TYPE_NULL;
+	}
+
+	JsonValue* JsonValue::FindMember(const char* pName) const
+	{
+		if (m_oValue.Childs.m_pIndex != NULL)
+			return m_oValue.Childs.m_pIndex->Find(pName, Internal::HashMemberName(pName));
+
+		JsonValue* pChild = m_oValue.Childs.m_pFirst;
+		while (pChild != NULL)
+		{
+			if (strcmp(pChild->m_pName, pName) == 0)
+				return pChild;
+			pChild = pChild->m_pNext;
+		}
+		return NULL;
+	}
+
+	JsonValue* JsonValue::FindMember(const char* pName, uint32_t iHash) const
+	{
+		if (m_oValue.Childs.m_pIndex != NULL)
+			return m_oValue.Childs.m_pIndex->Find(pName, iHash);
+
+		JsonValue* pChild = m_oValue.Childs.m_pFirst;
+		while (pChild != NULL)
+		{
+			if (pChild->m_pName[0] == pName[0] && strcmp(pChild->m_pName, pName) == 0)
+				return pChild;
+			pChild = pChild->m_pNext;
+		}
+		return NULL;
+	}
+
+	JsonValue* JsonValue::FindChild(int iIndex) const
+	{
+		if (iIndex < 0 || iIndex >= m_iChildCount)
+			return NULL;
+
+		if (m_eType == E_TYPE_ARRAY && m_oValue.Childs.m_pArray != NULL)
+			return m_oValue.Childs.m_pArray->Values()[iIndex];
+
+		JsonValue* pChild = m_oValue.Childs.m_pFirst;
+		while (iIndex-- > 0)
+			pChild = pChild->m_pNext;
+		return pChild;
+	}
+
+	void JsonValue::BuildMemberIndex()
+	{
+		JsonStthmAssert(m_eType == E_TYPE_OBJECT && m_oValue.Childs.m_pIndex == NULL);
+		if (m_pAllocator->AllocMemory == NULL) // Allocator without generic memory support
+			return;
+
+		uint32_t iCapacity = 32;
+		while (iCapacity < (uint32_t)m_iChildCount * 2)
+			iCapacity *= 2;
+
+		ChildIndex* pIndex = ChildIndex::Create(m_pAllocator, iCapacity);
+		for (JsonValue* pChild = m_oValue.Childs.m_pFirst; pChild != NULL; pChild = pChild->m_pNext)
+			pIndex->Insert(pChild, Internal::HashMemberName(pChild->m_pName));
+		m_oValue.Childs.m_pIndex = pIndex;
+	}
+
+	void JsonValue::InsertMemberIndex(JsonValue* pMember)
+	{
+		ChildIndex* pIndex = m_oValue.Childs.m_pIndex;
+		if ((pIndex->m_iCount + 1) * 2 > pIndex->m_iCapacity)
+		{
+			// Keep load factor under 0.5
+			ChildIndex* pNewIndex = ChildIndex::Create(m_pAllocator, pIndex->m_iCapacity * 2);
+			ChildIndex::Slot* pSlots = pIndex->Slots();
+			for (uint32_t iSlot = 0; iSlot < pIndex->m_iCapacity; ++iSlot)
+			{
+				if (pSlots[iSlot].m_pValue != NULL)
+					pNewIndex->Insert(pSlots[iSlot].m_pValue, pSlots[iSlot].m_iHash);
+			}
+			m_pAllocator->FreeMemory(pIndex, m_pAllocator->pUserData);
+			m_oValue.Childs.m_pIndex = pIndex = pNewIndex;
+		}
+		pIndex->Insert(pMember, Internal::HashMemberName(pMember->m_pName));
+	}
+
+	void JsonValue::BuildChildArray()
+	{
+		JsonStthmAssert(m_eType == E_TYPE_ARRAY && m_oValue.Childs.m_pArray == NULL);
+		if (m_pAllocator->AllocMemory == NULL) // Allocator without generic memory support
+			return;
+
+		ChildArray* pArray = ChildArray::Create(m_pAllocator, (size_t)m_iChildCount);
+		JsonValue** pValues = pArray->Values();
+		for (JsonValue* pChild = m_oValue.Childs.m_pFirst; pChild != NULL; pChild = pChild->m_pNext)
+			*pValues++ = pChild;
+		m_oValue.Childs.m_pArray = pArray;
+	}
+
+	void JsonValue::InsertChildArray(JsonValue* pChild)
+	{
+		ChildArray* pArray = m_oValue.Childs.m_pArray;
+		if ((size_t)m_iChildCount == pArray->m_iCapacity)
+		{
+			ChildArray* pNewArray = ChildArray::Create(m_pAllocator, pArray->m_iCapacity * 2);
+			memcpy(pNewArray->Values(), pArray->Values(), pArray->m_iCapacity * sizeof(JsonValue*));
+			m_pAllocator->FreeMemory(pArray, m_pAllocator->pUserData);
+			m_oValue.Childs.m_pArray = pArray = pNewArray;
+		}
+		pArray->Values()[m_iChildCount] = pChild;
+	}
+
+	bool JsonValue::Combine(const JsonValue& oRight, bool bMergeSubMembers)
+	{
+		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
+		if (this == &JsonStthm::JsonValue::INVALID)
+			return false;
+
+		if (m_eType != oRight.m_eType)
+			return false;
+
+		switch(m_eType)
+		{
+		case E_TYPE_NULL:
+			// Nothing to do
+			break;
+		case E_TYPE_OBJECT:
+		{
+			// Replace value or try to add recursively values of sub objects
+			for (const JsonValue* pChild =  oRight.m_oValue.Childs.m_pFirst; pChild != NULL; pChild = pChild->m_pNext)
+			{
+				JsonValue& oLeftChild = (*this)[pChild->m_pName];
+				if (bMergeSubMembers && oLeftChild.m_eType == pChild->m_eType) // Combine again is the childrens's type is the same otherwise replace it
+				{
+					(*this)[pChild->m_pName].Combine(*pChild, true);
+				}
+				else
+				{
+					(*this)[pChild->m_pName] = *pChild;
+				}
+			}
+			break;
+		}
+		case E_TYPE_ARRAY:
+		{
+			// Append to array
+			for (const JsonValue* pChild = oRight.m_oValue.Childs.m_pFirst; pChild != NULL; pChild = pChild->m_pNext)
+			{
+				Append() = *pChild;
+			}
+			break;
+		}
+		case E_TYPE_STRING:
+		{
+			// Concatenate strings
+			size_t iLenLeft = strlen(m_oValue.String);
+			size_t iLenRight = strlen(oRight.m_oValue.String);
+			size_t iLenNew = iLenLeft + iLenRight;
+			char* pNewString = m_pAllocator->AllocString(iLenNew + 1, m_pAllocator->pUserData);
+			memcpy(pNewString, m_oValue.String, iLenLeft);
+			memcpy(pNewString + iLenLeft, oRight.m_oValue.String, iLenRight);
+			pNewString[iLenNew] = 0;
+			m_pAllocator->FreeString(m_oValue.String, m_pAllocator->pUserData);
+			m_oValue.String = pNewString;
+			break;
+		}
+		case E_TYPE_BOOLEAN:
+			m_oValue.Boolean = m_oValue.Boolean || oRight.m_oValue.Boolean;
+			break;
+		case E_TYPE_INTEGER:
+			m_oValue.Integer += oRight.m_oValue.Integer;
+			break;
+		case E_TYPE_FLOAT:
+			m_oValue.Float += oRight.m_oValue.Float;
+			break;
+		}
+
+		return true;
+	}
+
+	bool JsonValue::operator ==(const JsonValue& oRight) const
+	{
+		if (m_eType != oRight.m_eType)
+			return false;
+
+		switch (m_eType)
+		{
+		case E_TYPE_NULL:
+			break;
+		case E_TYPE_OBJECT:
+		{
+			// We don't care if members order is not the same
+			const JsonValue* pChildLeft = m_oValue.Childs.m_pFirst;
+			while (pChildLeft != NULL)
+			{
+				if (*pChildLeft != oRight[pChildLeft->m_pName])
+					return false;
+
+				pChildLeft = pChildLeft->m_pNext;
+			}
+			break;
+		}
+		case E_TYPE_ARRAY:
+		{
+			JsonValue* pChildLeft = m_oValue.Childs.m_pFirst;
+			JsonValue* pChildRight = oRight.m_oValue.Childs.m_pFirst;
+			while (pChildLeft != NULL && pChildRight != NULL)
+			{
+				if (*pChildLeft != *pChildRight)
+					return false;
+
+				pChildLeft = pChildLeft->m_pNext;
+				pChildRight = pChildRight->m_pNext;
+			}
+
+			if (pChildLeft != NULL || pChildRight != NULL)
+				return false;
+			break;
+		}
+		case E_TYPE_STRING:
+			if (strcmp(m_oValue.String, oRight.m_oValue.String) != 0)
+				return false;
+			break;
+		case E_TYPE_BOOLEAN:
+			if (memcmp(&m_oValue.Boolean, &oRight.m_oValue.Boolean, sizeof(m_oValue.Boolean)) != 0)
+				return false;
+			break;
+		case E_TYPE_INTEGER:
+			if (memcmp(&m_oValue.Integer, &oRight.m_oValue.Integer, sizeof(m_oValue.Integer)) != 0)
+				return false;
+			break;
+		case E_TYPE_FLOAT:
+			if (memcmp(&m_oValue.Float, &oRight.m_oValue.Float, sizeof(m_oValue.Float)) != 0)
+				return false;
+			break;
+		}
+
+		return true;
+	}
+
+	bool JsonValue::operator !=(const JsonValue& oRight) const
+	{
+		return (*this == oRight) == false;
+	}
+
+	const JsonValue& JsonValue::operator[](const char* pName) const
+	{
+		if (m_eType == E_TYPE_OBJECT)
+		{
+			JsonValue* pChild = FindMember(pName);
+			if (pChild != NULL)
+				return *pChild;
+		}
+		return JsonValue::INVALID;
+	}
+
+	JsonValue& JsonValue::operator[](const char* pName)
+	{
+		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
+		if (this == &JsonStthm::JsonValue::INVALID)
+			return JsonValue::INVALID;
+
+		if (pName == NULL || pName[0] == 0)
+			return JsonValue::INVALID;
+
+		if (m_eType == E_TYPE_NULL)
+			InitType(E_TYPE_OBJECT);
+		if (m_eType == E_TYPE_OBJECT)
+		{
+			if (m_oValue.Childs.m_pIndex != NULL)
+			{
+				JsonValue* pChild = m_oValue.Childs.m_pIndex->Find(pName, Internal::HashMemberName(pName));
+				if (pChild != NULL)
+					return *pChild;
+			}
+			else
+			{
+				JsonValue* pChild = m_oValue.Childs.m_pFirst;
+				while (pChild != NULL)
+				{
+					if (strcmp(pChild->m_pName, pName) == 0)
+						return *pChild;
+					pChild = pChild->m_pNext;
+				}
+
+				// Object grew large through the API, index it before adding the new member
+				if (m_iChildCount >= STTHM_MEMBER_INDEX_THRESHOLD)
+					BuildMemberIndex();
+			}
+
+			JsonValue* pNewMember = m_pAllocator->CreateJsonValue(m_pAllocator, m_pAllocator->pUserData);
+
+			size_t iNameLen = strlen(pName) + 1;
+			void* pNewString = m_pAllocator->AllocString(iNameLen, m_pAllocator->pUserData);
+			memcpy(pNewString, (const void*)pName, iNameLen);
+			pNewMember->m_pName = (char*)pNewString;
+
+			AppendChild(pNewMember);
+			return *pNewMember;
+		}
+		return JsonValue::INVALID;
+	}
+
+	const JsonValue& JsonValue::operator[](char* pName) const
+	{
+		return (*this)[(const char*)pName];
+	}
+
+	JsonValue& JsonValue::operator[](char* pName)
+	{
+		return (*this)[(const char*)pName];
+	}
+
+	const JsonValue& JsonValue::operator [](int iIndex) const
+	{
+		if (m_eType == E_TYPE_OBJECT || m_eType == E_TYPE_ARRAY)
+		{
+			JsonValue* pChild = FindChild(iIndex);
+			if (pChild != NULL)
+				return *pChild;
+		}
+		return JsonValue::INVALID;
+	}
+
+	JsonValue& JsonValue::operator[](int iIndex)
+	{
+		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
+		if (this == &JsonStthm::JsonValue::INVALID)
+			return JsonValue::INVALID;
+
+		if (iIndex < 0)
+			return JsonValue::INVALID;
+
+		if (m_eType == E_TYPE_NULL)
+			InitType(E_TYPE_ARRAY);
+		if (m_eType == E_TYPE_OBJECT || m_eType == E_TYPE_ARRAY)
+		{
+			if (iIndex < m_iChildCount)
+			{
+				// Array grew large through the API, index it
+				if (m_eType == E_TYPE_ARRAY && m_oValue.Childs.m_pArray == NULL && m_iChildCount > STTHM_ARRAY_INDEX_THRESHOLD)
+					BuildChildArray();
+				return *FindChild(iIndex);
+			}
+
+			if (m_eType == E_TYPE_ARRAY)
+			{
+				do
+				{
+					JsonValue* pNewChild = m_pAllocator->CreateJsonValue(m_pAllocator, m_pAllocator->pUserData);
+					AppendChild(pNewChild);
+				}
+				while (m_iChildCount <= iIndex);
+				return *m_oValue.Childs.m_pLast;
+			}
+		}
+		return JsonValue::INVALID;
+	}
+
+	JsonValue& JsonValue::operator =(const JsonValue& oValue)
+	{
+		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
+		if (this == &JsonStthm::JsonValue::INVALID)
+			return JsonValue::INVALID;
+
+		if (this == &oValue)
+			return *this;
+
+		if (oValue.m_eType == E_TYPE_OBJECT)
+		{
+			InitType(E_TYPE_OBJECT);
+
+			JsonValue* pSourceChild = oValue.m_oValue.Childs.m_pFirst;
+			while (pSourceChild != NULL)
+			{
+				JsonValue* pNewChild = m_pAllocator->CreateJsonValue(m_pAllocator, m_pAllocator->pUserData);
+				*pNewChild = *pSourceChild;
+
+				if (pSourceChild->m_pName != NULL)
+				{
+					size_t iNameLen = strlen(pSourceChild->m_pName) + 1;
+					char* pNewString = m_pAllocator->AllocString(iNameLen, m_pAllocator->pUserData);
+					memcpy(pNewString, pSourceChild->m_pName, iNameLen);
+					pNewChild->m_pName = pNewString;
+				}
+
+				AppendChild(pNewChild);
+
+				pSourceChild = pSourceChild->m_pNext;
+			}
+
+			if (m_iChildCount > STTHM_MEMBER_INDEX_THRESHOLD)
+				BuildMemberIndex();
+		}
+		else if (oValue.m_eType == E_TYPE_ARRAY)
+		{
+			InitType(E_TYPE_ARRAY);
+
+			JsonValue* pSourceChild = oValue.m_oValue.Childs.m_pFirst;
+			while (pSourceChild != NULL)
+			{
+				JsonValue* pNewChild = m_pAllocator->CreateJsonValue(m_pAllocator, m_pAllocator->pUserData);
+				*pNewChild = *pSourceChild;
+				AppendChild(pNewChild);
+
+				pSourceChild = pSourceChild->m_pNext;
+			}
+
+			if (m_iChildCount > STTHM_ARRAY_INDEX_THRESHOLD)
+				BuildChildArray();
+		}
+		else if (oValue.m_eType == E_TYPE_BOOLEAN)
+		{
+			*this = oValue.ToBoolean();
+		}
+		else if (oValue.m_eType == E_TYPE_STRING)
+		{
+			*this = oValue.ToString();
+		}
+		else if (oValue.m_eType == E_TYPE_INTEGER)
+		{
+			*this = oValue.ToInteger();
+		}
+		else if (oValue.m_eType == E_TYPE_FLOAT)
+		{
+			*this = oValue.ToFloat();
+		}
+		return *this;
+	}
+
+	JsonValue& JsonValue::operator =(JsonValue&& oValue) noexcept
+	{
+		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
+		if (this == &JsonStthm::JsonValue::INVALID)
+			return JsonValue::INVALID;
+
+		if (this == &oValue)
+			return *this;
+
+		if (m_pAllocator == oValue.m_pAllocator)
+		{
+			// Taken before the reset, oValue can be a child of this value
+			JsonValue oTemp(m_pAllocator);
+			oTemp.StealValue(oValue);
+			Reset();
+			StealValue(oTemp);
+		}
+		else
+		{
+			*this = (const JsonValue&)oValue;
+			oValue.Reset();
+		}
+		return *this;
+	}
+
+#ifdef JsonStthmString
+	JsonValue& JsonValue::operator =(const JsonStthmString& sValue)
+	{
+		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
+		if (this == &JsonStthm::JsonValue::INVALID)
+			return JsonValue::INVALID;
+
+		InitType(E_TYPE_STRING);
+		SetStringValue(sValue.c_str());
+
+		return *this;
+	}
+#endif //JsonStthmString
+
+	JsonValue& JsonValue::operator =(const char* pValue)
+	{
+		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
+		if (this == &JsonStthm::JsonValue::INVALID)
+			return JsonValue::INVALID;
+
+		SetString(pValue);
+		return *this;
+	}
+
+	JsonValue& JsonValue::operator =(bool bValue)
+	{
+		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
+		if (this == &JsonStthm::JsonValue::INVALID)
+			return JsonValue::INVALID;
+
+		SetBoolean(bValue);
+		return *this;
+	}
+
+	JsonValue& JsonValue::operator =(int64_t iValue)
+	{
+		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
+		if (this == &JsonStthm::JsonValue::INVALID)
+			return JsonValue::INVALID;
+
+		SetInteger(iValue);
+		return *this;
+	}
+
+	JsonValue& JsonValue::operator =(double fValue)
+	{
+		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
+		if (this == &JsonStthm::JsonValue::INVALID)
+			return JsonValue::INVALID;
+
+		SetFloat(fValue);
+		return *this;
+	}
+
+	JsonValue& JsonValue::operator +=(const JsonValue& oValue)
+	{
+		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
+		if (this == &JsonStthm::JsonValue::INVALID)
+			return JsonValue::INVALID;
+
+		if (m_eType == E_TYPE_ARRAY)
+		{
+			JsonValue* pNewValue = m_pAllocator->CreateJsonValue(m_pAllocator, m_pAllocator->pUserData);
+			*pNewValue = oValue;
+			AppendChild(pNewValue);
+		}
+		else if (m_eType == E_TYPE_STRING)
+		{
+			if (oValue.IsString())
+			{
+				Internal::CharBuffer oNewStr;
+				const char* pAddString = oValue.ToString();
+				size_t iLen1 = strlen(m_oValue.String);
+				size_t iLen2 = strlen(pAddString);
+				oNewStr.Reserve(iLen1 + iLen2 + 1);
+				oNewStr.PushRange(m_oValue.String, iLen1);
+				oNewStr.PushRange(pAddString, iLen2);
+				oNewStr.Push(0);
+				SetStringValue(oNewStr.Data());
+			}
+		}
+		return *this;
+	}
+
+	bool JsonValue::Parse(const char*& pString, bool bInSitu)
+	{
+		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
+		if (this == &JsonStthm::JsonValue::INVALID || pString == NULL)
+			return false;
+
+		// Containers being read, children are appended before being parsed so they are always owned
+		Internal::Buffer<JsonValue*, 64> oParents;
+		JsonValue* pValue = this;
+		for (;;)
+		{
+			Internal::SkipSpaces(pString);
+			const char cChar = *pString;
+			if (cChar == '{' || cChar == '[')
+			{
+				if (oParents.Size() >= STTHM_MAX_DEPTH)
+					return false;
+
+				// '{' + 2 == '}', '[' + 2 == ']'
+				++pString;
+				pValue->InitType(cChar == '{' ? E_TYPE_OBJECT : E_TYPE_ARRAY);
+				Internal::SkipSpaces(pString);
+				if (*pString != cChar + 2)
+				{
+					oParents.Push(pValue);
+					pValue = pValue->ParseNewChild(pString, bInSitu);
+					if (pValue == NULL)
+						return false;
+					continue;
+				}
+				++pString;
+			}
+			else if (cChar == 0 && oParents.Size() == 0)
+			{
+				// Empty document
+				return true;
+			}
+			else if (pValue->ParseLeaf(pString, bInSitu) == false)
+			{
+				return false;
+			}
+
+			// Next value of the current container, closing finished ones
+			for (;;)
+			{
+				if (oParents.Size() == 0)
+					return true;
+
+				JsonValue* pParent = oParents.Data()[oParents.Size() - 1];
+				Internal::SkipSpaces(pString);
+				if (*pString == ',')
+				{
+					++pString;
+					pValue = pParent->ParseNewChild(pString, bInSitu);
+					if (pValue == NULL)
+						return false;
+					break;
+				}
+
+				if (pParent->m_eType == E_TYPE_OBJECT)
+				{
+					if (*pString != '}')
+						return false;
+					if (pParent->m_iChildCount > STTHM_MEMBER_INDEX_THRESHOLD)
+						pParent->BuildMemberIndex();
+				}
+				else
+				{
+					if (*pString != ']')
+						return false;
+					if (pParent->m_iChildCount > STTHM_ARRAY_INDEX_THRESHOLD)
+						pParent->BuildChildArray();
+				}
+				++pString;
+				pValue = pParent;
+				oParents.Resize(oParents.Size() - 1);
+			}
+		}
+	}
+
+	JsonValue* JsonValue::ParseNewChild(const char*& pString, bool bInSitu)
+	{
+		char* pName = NULL;
+		if (m_eType == E_TYPE_OBJECT)
+		{
+			Internal::SkipSpaces(pString);
+			if (*pString != '"')
+				return NULL;
+
+			pName = ReadStringValue(++pString, m_pAllocator, bInSitu);
+			if (pName == NULL)
+				return NULL;
+
+			Internal::SkipSpaces(pString);
+			if (*pString != ':')
+			{
+				if (bInSitu == false)
+					m_pAllocator->FreeString(pName, m_pAllocator->pUserData);
+				return NULL;
+			}
+			++pString;
+		}
+
+		JsonValue* pNewChild = m_pAllocator->CreateJsonValue(m_pAllocator, m_pAllocator->pUserData);
+		pNewChild->m_pName = pName;
+		AppendChild(pNewChild);
+		return pNewChild;
+	}
+
+	bool JsonValue::ParseLeaf(const char*& pString, bool bInSitu)
+	{
+		switch (*pString)
+		{
+		case '"':
+		{
+			char* pValue = ReadStringValue(++pString, m_pAllocator, bInSitu);
+			if (pValue == NULL)
+			{
+				return false;
+			}
+
+			InitType(E_TYPE_STRING);
+			m_oValue.String = pValue;
+			return true;
+		}
+		case 'N':
+			if (Internal::MatchLiteral(pString, "NaN", 3))
+			{
+				InitType(E_TYPE_FLOAT);
+				m_oValue.Float = Internal::c_fNaN;
+				return true;
+			}
+			break;
+		case 'I':
+			if (Internal::MatchLiteral(pString, "Infinity", 8))
+			{
+				InitType(E_TYPE_FLOAT);
+				m_oValue.Float = Internal::c_fInfinity;
+				return true;
+			}
+			break;
+		case '-':
+			if (pString[1] == 'I')
+			{
+				if (Internal::MatchLiteral(pString, "-Infinity", 9))
+				{
+					InitType(E_TYPE_FLOAT);
+					m_oValue.Float = -Internal::c_fInfinity;
+					return true;
+				}
+				break;
+			}
+			return ReadNumericValue(pString, *this);
+		case '0': case '1': case '2': case '3': case '4':
+		case '5': case '6': case '7': case '8': case '9':
+			return ReadNumericValue(pString, *this);
+		case 't':
+			if (Internal::MatchLiteral(pString, "true", 4))
+			{
+				InitType(E_TYPE_BOOLEAN);
+				m_oValue.Boolean = true;
+				return true;
+			}
+			break;
+		case 'f':
+			if (Internal::MatchLiteral(pString, "false", 5))
+			{
+				InitType(E_TYPE_BOOLEAN);
+				m_oValue.Boolean = false;
+				return true;
+			}
+			break;
+		case 'n':
+			if (Internal::MatchLiteral(pString, "null", 4))
+			{
+				InitType(E_TYPE_NULL);
+				return true;
+			}
+			break;
+		default:
+			break;
+		}
+
+		// Error
+		return false;
+	}
+
+	int JsonValue::Read(const char* pJson, size_t iLength, int iFlags, bool bInSitu)
+	{
+		Reset();
+		if ((iFlags & E_READ_VALIDATE_UTF8) != 0)
+		{
+			const char* pInvalid = Internal::FindInvalidUtf8(pJson, iLength);
+			if (pInvalid != NULL)
+				return Internal::CountLines(pJson, pInvalid);
+		}
+
+		const char* pEnd = pJson;
+		if (Parse(pEnd, bInSitu) == false)
+		{
+			return Internal::CountLines(pJson, pEnd);
+		}
+		return 0;
+	}
+
+	int JsonValue::Validate(const char* pJson, size_t iLength)
+	{
+		if (pJson == NULL)
+			return -1;
+		JsonStthmAssert(pJson[iLength] == 0);
+
+		const char* pInvalid = Internal::FindInvalidUtf8(pJson, iLength);
+		if (pInvalid != NULL)
+			return Internal::CountLines(pJson, pInvalid);
+
+		// Closing chars of open containers
+		Internal::Buffer<char, 256> oClosers;
+		const char* pString = pJson;
+		for (;;)
+		{
+			Internal::SkipSpaces(pString);
+			const char cChar = *pString;
+			if (cChar == '{' || cChar == '[')
+			{
+				// '{' + 2 == '}', '[' + 2 == ']'
+				const char cClose = cChar + 2;
+				++pString;
+				Internal::SkipSpaces(pString);
+				if (*pString != cClose)
+				{
+					oClosers.Push(cClose);
+					if (cChar == '{' && ValidateMemberName(pString) == false)
+						return Internal::CountLines(pJson, pString);
+					continue;
+				}
+				++pString;
+			}
+			else if (cChar == '"')
+			{
+				if (ValidateStringValue(++pString) == false)
+					return Internal::CountLines(pJson, pString);
+			}
+			else
+			{
+				Internal::Scalar oScalar;
+				if (Internal::ReadScalar(pString, oScalar) == false || Internal::IsScalarChar(*pString))
+					return Internal::CountLines(pJson, pString);
+			}
+
+			// Close finished containers, then move to the next value
+			while (oClosers.Size() != 0)
+			{
+				Internal::SkipSpaces(pString);
+				const char cClose = oClosers.Data()[oClosers.Size() - 1];
+				if (*pString == cClose)
+				{
+					++pString;
+					oClosers.Resize(oClosers.Size() - 1);
+					continue;
+				}
+
+				if (*pString != ',')
+					return Internal::CountLines(pJson, pString);
+				++pString;
+				if (cClose == '}' && ValidateMemberName(pString) == false)
+					return Internal::CountLines(pJson, pString);
+				break;
+			}
+
+			if (oClosers.Size() == 0)
+				break;
+		}
+
+		// Nothing but spaces after the root value, a null char before the end is an error too
+		Internal::SkipSpaces(pString);
+		if (pString != pJson + iLength)
+			return Internal::CountLines(pJson, pString);
+		return 0;
+	}
+
+	bool JsonValue::ValidateStringValue(const char*& pString)
+	{
+		char pChar[4];
+		for (;;)
+		{
+			// Control chars must be escaped
+			pString = Internal::FindCharToEscape(pString, false);
+			if (*pString == '"')
+			{
+				++pString;
+				return true;
+			}
+			if (*pString != '\\' || ReadSpecialChar(++pString, pChar) == 0)
+				return false;
+			++pString;
+		}
+	}
+
+	bool JsonValue::ValidateMemberName(const char*& pString)
+	{
+		Internal::SkipSpaces(pString);
+		if (*pString != '"' || ValidateStringValue(++pString) == false)
+			return false;
+		Internal::SkipSpaces(pString);
+		if (*pString != ':')
+			return false;
+		++pString;
+		return true;
+	}
+
+	int JsonValue::ReadProjected(const char* pJson, const JsonPathSet& oPaths)
+	{
+		Reset();
+		const uint32_t iRoot = 0;
+		const char* pEnd = pJson;
+		if (ParseProjected(pEnd, oPaths, &iRoot, 1) == false)
+		{
+			return Internal::CountLines(pJson, pEnd);
+		}
+		return 0;
+	}
+
+	bool JsonValue::ParseProjected(const char*& pString, const JsonPathSet& oPaths, const uint32_t* pNodes, size_t iNodeCount)
+	{
+		const JsonPathSet::Node* pPathNodes = oPaths.m_oNodes.Data();
+		for (size_t i = 0; i < iNodeCount; ++i)
+		{
+			if (pPathNodes[pNodes[i]].m_bLeaf)
+				return Parse(pString, false);
+		}
+
+		// Paths go deeper, only containers are built
+		Internal::SkipSpaces(pString);
+		const bool bObject = *pString == '{';
+		if (bObject == false && *pString != '[')
+			return *pString == 0 || Internal::SkipValue(pString);
+
+		InitType(bObject ? E_TYPE_OBJECT : E_TYPE_ARRAY);
+		const char cClose = bObject ? '}' : ']';
+		++pString;
+		Internal::SkipSpaces(pString);
+		if (*pString == cClose)
+		{
+			++pString;
+			return true;
+		}
+
+		Internal::Buffer<uint32_t, 16> oMatches;
+		int64_t iIndex = 0;
+		int64_t iSkipped = 0; // Array values skipped since the last built one
+		for (;;)
+		{
+			Internal::SkipSpaces(pString);
+
+			const char* pName = NULL;
+			if (bObject)
+			{
+				// Member name is only read when the member is built
+				if (*pString != '"')
+					return false;
+				pName = ++pString;
+				const char* pEnd = Internal::FindClosingQuote(pName);
+				if (*pEnd != '"')
+					return false;
+				pString = pEnd + 1;
+
+				Internal::SkipSpaces(pString);
+				if (*pString != ':')
+					return false;
+				++pString;
+				Internal::SkipSpaces(pString);
+			}
+
+			oMatches.Clear();
+			bool bLeaf = false;
+			for (size_t i = 0; i < iNodeCount; ++i)
+			{
+				for (uint32_t iChild = pPathNodes[pNodes[i]].m_iFirstChild; iChild != 0; iChild = pPathNodes[iChild].m_iNextSibling)
+				{
+					const JsonPathSet::Node& oChild = pPathNodes[iChild];
+					if (oChild.m_bWildcard || (bObject ? MatchStringValue(pName, oPaths.GetName(oChild)) : oChild.m_iIndex == iIndex))
+					{
+						oMatches.Push(iChild);
+						bLeaf |= oChild.m_bLeaf;
+					}
+				}
+			}
+
+			if (oMatches.Size() == 0 || (bLeaf == false && *pString != '{' && *pString != '['))
+			{
+				if (Internal::SkipValue(pString) == false)
+					return false;
+				++iSkipped;
+			}
+			else
+			{
+				for (; bObject == false && iSkipped > 0; --iSkipped)
+					AppendChild(m_pAllocator->CreateJsonValue(m_pAllocator, m_pAllocator->pUserData));
+
+				JsonValue* pNewValue = m_pAllocator->CreateJsonValue(m_pAllocator, m_pAllocator->pUserData);
+				if (bObject)
+				{
+					pNewValue->m_pName = ReadStringValue(pName, m_pAllocator, false);
+					if (pNewValue->m_pName == NULL)
+					{
+						m_pAllocator->DeleteJsonValue(pNewValue, m_pAllocator->pUserData);
+						return false;
+					}
+				}
+
+				if (pNewValue->ParseProjected(pString, oPaths, oMatches.Data(), oMatches.Size()) == false)
+				{
+					m_pAllocator->DeleteJsonValue(pNewValue, m_pAllocator->pUserData);
+					return false;
+				}
+				AppendChild(pNewValue);
+			}
+			++iIndex;
+
+			Internal::SkipSpaces(pString);
+			if (*pString == cClose)
+			{
+				++pString;
+				if (bObject && m_iChildCount > STTHM_MEMBER_INDEX_THRESHOLD)
+					BuildMemberIndex();
+				else if (bObject == false && m_iChildCount > STTHM_ARRAY_INDEX_THRESHOLD)
+					BuildChildArray();
+				return true;
+			}
+			else if (*pString != ',')
+			{
+				return false;
+			}
+			++pString;
+		}
+	}
+
+	// Static functions
+
+	int JsonValue::ReadSpecialChar(const char*& pString, char* pOut)
+	{
+		if (*pString == 'n')		{ pOut[0] = '\n';	return 1; }
+		else if (*pString == 'r')	{ pOut[0] = '\r';	return 1; }
+		else if (*pString == 't')	{ pOut[0] = '\t';	return 1; }
+		else if (*pString == 'b')	{ pOut[0] = '\b';	return 1; }
+		else if (*pString == 'f')	{ pOut[0] = '\f';	return 1; }
+		else if (*pString == '"')	{ pOut[0] = '"';	return 1; }
+		else if (*pString == '\\')	{ pOut[0] = '\\';	return 1; }
+		else if (*pString == '/')	{ pOut[0] = '/';	return 1; }
+		else if (*pString == 'u')
+		{
+			uint32_t iChar = 0;
+			for (int i = 0; i < 4; ++i)
+			{
+				uint8_t iXDigit = Internal::XDigitToUInt8(*++pString);
+				if (iXDigit != 255)
+					iChar = iChar * 16 + iXDigit;
+				else
+					return 0;
+			}
+
+			if (iChar >= 0xD800 && iChar <= 0xDFFF) // UTF16 Surrogate pair
+			{
+				if ((iChar & 0xFC00) != 0xD800)
+					return 0; //Invalid first pair code
+
+				if (*++pString != '\\' || *++pString != 'u')
+					return 0; //Not a valid pair
+
+				uint32_t iChar2 = 0;
+				for (int i = 0; i < 4; ++i)
+				{
+					uint8_t iXDigit = Internal::XDigitToUInt8(*++pString);
+					if (iXDigit != 255)
+						iChar2 = iChar2 * 16 + iXDigit;
+					else
+						return 0;
+				}
+
+				if ((iChar2 & 0xFC00) != 0xDC00)
+					return 0; //Invalid second pair code
+
+				iChar = 0x10000 + (((iChar & 0x3FF) << 10) | (iChar2 & 0x3FF));
+			}
+
+			if (iChar < 0x80)
+			{
+				pOut[0] = (char)iChar;
+				return 1;
+			}
+			if (iChar >= 0x80 && iChar <= 0x7FF)
+			{
+				pOut[0] = (char)(0xC0 | ((iChar >> 6)));
+				pOut[1] = (char)(0x80 | ((iChar >> 0) & 0x3F));
+				return 2;
+			}
+			if (iChar >= 0x800 && iChar <= 0xFFFF)
+			{
+				pOut[0] = (char)(0xE0 | ((iChar >> 12)));
+				pOut[1] = (char)(0x80 | ((iChar >> 6) & 0x3F));
+				pOut[2] = (char)(0x80 | ((iChar >> 0) & 0x3F));
+				return 3;
+			}
+			if (iChar >= 0x10000 && iChar <= 0x10FFFF)
+			{
+				pOut[0] = (char)(0xF0 | ((iChar >> 18)));
+				pOut[1] = (char)(0x80 | ((iChar >> 12) & 0x3F));
+				pOut[2] = (char)(0x80 | ((iChar >> 6) & 0x3F));
+				pOut[3] = (char)(0x80 | ((iChar >> 0) & 0x3F));
+				return 4;
+			}
+		}
+
+		return 0;
+	}
+
+	char* JsonValue::ReadStringValue(const char*& pString, Allocator* pAllocator, bool bInSitu)
+	{
+		const char* pStart = pString;
+		const char* pCursor = Internal::FindQuoteOrBackslash(pStart);
+
+		if (*pCursor == '"')
+		{
+			pString = pCursor + 1;
+			if (bInSitu)
+			{
+				// Closing quote becomes the terminator
+				*const_cast<char*>(pCursor) = '\0';
+				return const_cast<char*>(pStart);
+			}
+
+			// No escaped char, just copy
+			size_t iLen = pCursor - pStart;
+			char* pNewString = pAllocator->AllocString(iLen + 1, pAllocator->pUserData);
+			memcpy(pNewString, pStart, iLen);
+			pNewString[iLen] = '\0';
+			return pNewString;
+		}
+		else if (*pCursor == 0)
+		{
+			return NULL;
+		}
+
+		// Unescaped string is never longer than the escaped one, so the raw length is an upper bound
+		const char* pEnd = Internal::FindClosingQuote(pCursor);
+		if (*pEnd != '"')
+			return NULL;
+
+		// In situ, unescaped chars are written behind the read cursor
+		char* pNewString;
+		if (bInSitu)
+		{
+			pNewString = const_cast<char*>(pStart);
+		}
+		else
+		{
+			pNewString = pAllocator->AllocString(pEnd - pStart + 1, pAllocator->pUserData);
+			memcpy(pNewString, pStart, pCursor - pStart);
+		}
+		char* pNewStringCursor = pNewString + (pCursor - pStart);
+
+		while (pCursor != pEnd)
+		{
+			if (*pCursor == '\\')
+			{
+				int iCharLen = ReadSpecialChar(++pCursor, pNewStringCursor);
+				if (iCharLen == 0)
+				{
+					if (bInSitu == false)
+					{
+						*pNewStringCursor = '\0'; // JsonDoc measures freed strings
+						pAllocator->FreeString(pNewString, pAllocator->pUserData);
+					}
+					return NULL;
+				}
+				pNewStringCursor += iCharLen;
+				++pCursor;
+			}
+			else
+			{
+				// Copy clean run up to next backslash or closing quote
+				const char* pNext = Internal::FindQuoteOrBackslash(pCursor);
+				memmove(pNewStringCursor, pCursor, pNext - pCursor);
+				pNewStringCursor += pNext - pCursor;
+				pCursor = pNext;
+			}
+		}
+
+		*pNewStringCursor = '\0';
+		pString = pEnd + 1;
+		return pNewString;
+	}
+
+	bool JsonValue::ReadNumericValue(const char*& pString, JsonValue& oValue)
+	{
+		int64_t iValue;
+		double fValue;
+		switch (Internal::ParseNumber(pString, iValue, fValue))
+		{
+		case Internal::E_NUMBER_INTEGER:
+			oValue.InitType(E_TYPE_INTEGER);
+			oValue.m_oValue.Integer = iValue;
+			return true;
+		case Internal::E_NUMBER_FLOAT:
+			oValue.InitType(E_TYPE_FLOAT);
+			oValue.m_oValue.Float = fValue;
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	bool JsonValue::MatchStringValue(const char* pString, const char* pName)
+	{
+		for (;;)
+		{
+			if (*pString == '"')
+			{
+				return *pName == 0;
+			}
+			else if (*pString == '\\')
+			{
+				char pChar[4];
+				int iCharLen = ReadSpecialChar(++pString, pChar);
+				if (iCharLen == 0)
+					return false;
+				for (int i = 0; i < iCharLen; ++i)
+				{
+					if (*pName == 0 || *pName++ != pChar[i])
+						return false;
+				}
+				++pString;
+			}
+			else if (*pString == 0 || *pString++ != *pName++)
+			{
+				return false;
+			}
+		}
+	}
+
+	void JsonValue::WriteStringEscaped(Internal::CharBuffer& sOutJson, const char* pInput, bool bRawUtf8)
+	{
+		for (;;)
+		{
+			// Clean runs are copied at once
+			const char* pStop = Internal::FindCharToEscape(pInput, bRawUtf8 == false);
+			if (pStop != pInput)
+			{
+				if (bRawUtf8)
+				{
+					// A valid sequence never contains ASCII, so it never spans pStop
+					const char* pInvalid = Internal::FindInvalidUtf8(pInput, pStop - pInput);
+					if (pInvalid != NULL)
+					{
+						sOutJson.PushRange(pInput, pInvalid - pInput);
+						sOutJson.PushRange("\\ufffd", 6);
+						pInput = pInvalid + 1;
+						continue;
+					}
+				}
+				sOutJson.PushRange(pInput, pStop - pInput);
+				pInput = pStop;
+			}
+
+			const unsigned char iChar = (unsigned char)*pInput;
+			switch (iChar)
+			{
+			case 0:
+				return;
+			case '"':
+				sOutJson.PushRange("\\\"", 2);
+				break;
+			case '\\':
+				sOutJson.PushRange("\\\\", 2);
+				break;
+			case '\n':
+				sOutJson.PushRange("\\n", 2);
+				break;
+			case '\r':
+				sOutJson.PushRange("\\r", 2);
+				break;
+			case '\t':
+				sOutJson.PushRange("\\t", 2);
+				break;
+			case '\b':
+				sOutJson.PushRange("\\b", 2);
+				break;
+			case '\f':
+				sOutJson.PushRange("\\f", 2);
+				break;
+			default:
+				if (iChar < 0x80)
+				{
+					// Other control chars
+					Internal::PushUnicodeEscape(sOutJson, iChar);
+				}
+				else
+				{
+					// Invalid sequences are replaced by U+FFFD, one per byte
+					uint32_t iCodePoint;
+					int iLength = Internal::DecodeUtf8(pInput, iCodePoint);
+					if (iLength == 0)
+					{
+						iCodePoint = 0xFFFD;
+						iLength = 1;
+					}
+					pInput += iLength - 1;
+
+					if (iCodePoint <= 0xFFFF)
+					{
+						Internal::PushUnicodeEscape(sOutJson, iCodePoint);
+					}
+					else
+					{
+						//UTF-16 pair surrogate
+						uint32_t iCodePointBis = iCodePoint - 0x10000;
+						Internal::PushUnicodeEscape(sOutJson, 0xD800 | ((iCodePointBis >> 10) & 0x3FF));
+						Internal::PushUnicodeEscape(sOutJson, 0xDC00 | (iCodePointBis & 0x3FF));
+					}
+				}
+				break;
+			}
+			++pInput;
+		}
+	}
+
+	JsonValue* JsonValue::DefaultAllocatorCreateJsonValue(Allocator* pAllocator, void* /*pUserData*/)
+	{
+		return new JsonValue(pAllocator);
+	}
+
+	void JsonValue::DefaultAllocatorDeleteJsonValue(JsonValue* pValue, void* /*pUserData*/)
+	{
+		delete pValue;
+	}
+
+	char* JsonValue::DefaultAllocatorAllocString(size_t iSize, void* /*pUserData*/)
+	{
+		return (char*)JsonStthmMalloc(iSize);
+	}
+
+	void JsonValue::DefaultAllocatorFreeString(char* pString, void* /*pUserData*/)
+	{
+		JsonStthmFree(pString);
+	}
+
+	void* JsonValue::DefaultAllocatorAllocMemory(size_t iSize, void* /*pUserData*/)
+	{
+		return JsonStthmMalloc(iSize);
+	}
+
+	void JsonValue::DefaultAllocatorFreeMemory(void* pMemory, void* /*pUserData*/)
+	{
+		JsonStthmFree(pMemory);
+	}
+
+	//////////////////////////////
+	// JsonDoc
+	//////////////////////////////
+
+	JsonDoc::JsonDoc(size_t iBlockSize)
+		: m_oRoot(&m_oAllocator)
+		, m_iBlockSize(iBlockSize)
+		, m_pLastBlock(NULL)
+		, m_pRetainedBlocks(NULL)
+		, m_eRetainMode(E_RETAIN_NONE)
+		, m_iHighWater(0)
+		, m_iReserved(0)
+		, m_iPeak(0)
+		, m_iDead(0)
+		, m_bInSitu(false)
+	{
+		m_oAllocator.CreateJsonValue	= &JsonDoc::CreateJsonValue;
+		m_oAllocator.DeleteJsonValue	= &JsonDoc::DeleteJsonValue;
+		m_oAllocator.AllocString		= &JsonDoc::AllocString;
+		m_oAllocator.FreeString			= &JsonDoc::FreeString;
+		m_oAllocator.pUserData			= this;
+		m_oAllocator.AllocMemory		= &JsonDoc::AllocMemory;
+		m_oAllocator.FreeMemory			= &JsonDoc::FreeMemory;
+	}
+
+	JsonDoc::~JsonDoc()
+	{
+		m_oRoot.m_eType = JsonValue::E_TYPE_NULL;
+		FreeBlocks();
+	}
+
+	void JsonDoc::Clear()
+	{
+		m_oRoot.m_eType = JsonValue::E_TYPE_NULL;
+		m_iDead = 0;
+		m_bInSitu = false;
+		if (m_eRetainMode == E_RETAIN_NONE)
+		{
+			FreeBlocks();
+			return;
+		}
+
+		// Sort used and retained blocks together, largest first
+		Block* pSorted = NULL;
+		Block* pLists[2] = { m_pLastBlock, m_pRetainedBlocks };
+		for (int iList = 0; iList < 2; ++iList)
+		{
+			Block* pBlock = pLists[iList];
+			while (pBlock != NULL)
+			{
+				Block* pPrevious = pBlock->m_pPrevious;
+				Block** pInsert = &pSorted;
+				while (*pInsert != NULL && (*pInsert)->m_iSize >= pBlock->m_iSize)
+					pInsert = &(*pInsert)->m_pPrevious;
+				pBlock->m_pPrevious = *pInsert;
+				*pInsert = pBlock;
+				pBlock = pPrevious;
+			}
+		}
+		m_pLastBlock = NULL;
+		m_pRetainedBlocks = NULL;
+
+		// Keep the largest blocks fitting in the budget, rewound
+		size_t iBudget = (m_eRetainMode == E_RETAIN_HIGH_WATER) ? m_iHighWater : (pSorted != NULL ? pSorted->m_iSize : 0);
+		size_t iKept = 0;
+		Block** pLastKept = &m_pRetainedBlocks;
+		while (pSorted != NULL)
+		{
+			Block* pNext = pSorted->m_pPrevious;
+			if (iKept + pSorted->m_iSize <= iBudget)
+			{
+				iKept += pSorted->m_iSize;
+				pSorted->m_iUsed = sizeof(Block);
+				pSorted->m_pPrevious = NULL;
+				*pLastKept = pSorted;
+				pLastKept = &pSorted->m_pPrevious;
+			}
+			else
+			{
+				m_iReserved -= pSorted->m_iSize;
+				JsonStthmFree(pSorted);
+			}
+			pSorted = pNext;
+		}
+	}
+
+	void JsonDoc::Compact()
+	{
+		// Old tree stays readable in the old blocks while it is copied
+		Block* pOldBlocks = m_pLastBlock;
+		JsonValue oOldRoot(&m_oAllocator);
+		oOldRoot.StealValue(m_oRoot);
+		size_t iLive = 0;
+		for (Block* pBlock = pOldBlocks; pBlock != NULL; pBlock = pBlock->m_pPrevious)
+			iLive += pBlock->m_iUsed - sizeof(Block);
+		iLive -= (m_iDead < iLive) ? m_iDead : iLive;
+
+		// One block sized for the live bytes. Padding of dead values is counted as live, so the copy
+		// usually fits, else it continues in new blocks (in situ strings are not in the estimate).
+		m_pLastBlock = NULL;
+		if (iLive > 0)
+		{
+			m_pLastBlock = NewBlock(this, sizeof(Block) + iLive);
+			m_pLastBlock->m_pPrevious = NULL;
+		}
+
+		m_oRoot = oOldRoot;
+		oOldRoot.m_eType = JsonValue::E_TYPE_NULL;
+
+		while (pOldBlocks != NULL)
+		{
+			Block* pPrevious = pOldBlocks->m_pPrevious;
+			m_iReserved -= pOldBlocks->m_iSize;
+			JsonStthmFree(pOldBlocks);
+			pOldBlocks = pPrevious;
+		}
+		m_iDead = 0;
+		m_bInSitu = false;
+	}
+
+	void JsonDoc::SetRetainMode(ERetainMode eMode, size_t iHighWater)
+	{
+		m_eRetainMode = eMode;
+		m_iHighWater = iHighWater;
+	}
+
+	void JsonDoc::FreeBlocks()
+	{
+		Block* pLists[2] = { m_pLastBlock, m_pRetainedBlocks };
+		for (int iList = 0; iList < 2; ++iList)
+		{
+			Block* pBlock = pLists[iList];
+			while (pBlock != NULL)
+			{
+				Block* pPrevious = pBlock->m_pPrevious;
+				JsonStthmFree(pBlock);
+				pBlock = pPrevious;
+			}
+		}
+		m_pLastBlock = NULL;
+		m_pRetainedBlocks = NULL;
+		m_iReserved = 0;
+	}
+
+	int JsonDoc::ReadString(const char* pJson, int iFlags)
+	{
+		Clear();
+		if (pJson != NULL)
+		{
+			return Read(pJson, strlen(pJson), iFlags, false);
+		}
+		return -1;
+	}
+
+	int JsonDoc::ReadFile(const char* pFilename, int iFlags)
+	{
+		Clear();
+		Internal::FileContent oContent;
+		int iResult = oContent.Load(pFilename, (iFlags & JsonValue::E_READ_NO_FILE_MAPPING) == 0);
+		if (iResult != 0)
+			return iResult;
+
+		return Read(oContent.Data(), oContent.Size(), iFlags, false);
+	}
+
+	int JsonDoc::ReadString(const char* pJson, const JsonPathSet& oPaths)
+	{
+		Clear();
+		if (pJson != NULL)
+		{
+			return m_oRoot.ReadProjected(pJson, oPaths);
+		}
+		return -1;
+	}
+
+	int JsonDoc::ReadFile(const char* pFilename, const JsonPathSet& oPaths, int iFlags)
+	{
+		Clear();
+		Internal::FileContent oContent;
+		int iResult = oContent.Load(pFilename, (iFlags & JsonValue::E_READ_NO_FILE_MAPPING) == 0);
+		if (iResult != 0)
+			return iResult;
+
+		return m_oRoot.ReadProjected(oContent.Data(), oPaths);
+	}
+
+	int JsonDoc::ReadInSitu(char* pJson, size_t iLength, int iFlags)
+	{
+		Clear();
+		if (pJson != NULL)
+		{
+			m_bInSitu = true;
+			JsonStthmAssert(pJson[iLength] == 0);
+			return Read(pJson, iLength, iFlags, true);
+		}
+		return -1;
+	}
+
+	int JsonDoc::Read(const char* pJson, size_t iLength, int iFlags, bool bInSitu)
+	{
+		// In situ writes of a thread could race with SIMD loads overlapping the range of another one
+		if ((iFlags & JsonValue::E_READ_VALIDATE_UTF8) != 0)
+		{
+			const char* pInvalid = Internal::FindInvalidUtf8(pJson, iLength);
+			if (pInvalid != NULL)
+				return Internal::CountLines(pJson, pInvalid);
+			iFlags &= ~JsonValue::E_READ_VALIDATE_UTF8;
+		}
+
+		int iResult;
+		if ((iFlags & JsonValue::E_READ_PARALLEL_ARRAY) != 0 && bInSitu == false && ReadParallelArray(pJson, iLength, iResult))
+			return iResult;
+
+		return m_oRoot.Read(pJson, iLength, iFlags, bInSitu);
+	}
+
+	// Values of a top level array parsed by one thread in its own arena
+	struct JsonDoc::ParallelRange
+	{
+		const char*			m_pJson;
+		const uint32_t*		m_pBegin;		// Offsets of the values
+		const uint32_t*		m_pEnd;
+
+		JsonDoc*			m_pArena;
+		Allocator*			m_pAllocator;	// Lives in the main JsonDoc, referenced by the values
+
+		JsonValue*			m_pFirst;
+		JsonValue*			m_pLast;
+		size_t				m_iCount;		// Values linked from m_pFirst, fewer than the range on error
+		const char*			m_pError;		// NULL on success
+	};
+
+	bool JsonDoc::ReadParallelArray(const char* pJson, size_t iLength, int& iResult)
+	{
+		// Checked before indexing, a single thread parses faster without the index
+		size_t iThreadCount = (STTHM_PARALLEL_THREAD_COUNT > 0) ? (size_t)STTHM_PARALLEL_THREAD_COUNT : (size_t)std::thread::hardware_concurrency();
+		if (iThreadCount < 2)
+			return false;
+
+		Internal::Buffer<uint32_t> oIndex;
+		if (Internal::BuildStructuralIndex(pJson, iLength, oIndex) == false)
+			return false;
+
+		const uint32_t* pIndex = oIndex.Data();
+		if (pJson[*pIndex] != '[')
+			return false;
+
+		// Offsets of the top level values, nesting is only counted here, values validate themselves when parsed
+		Internal::Buffer<uint32_t> oValues;
+		int iDepth = 0;
+		bool bExpectValue = true;
+		for (++pIndex;; ++pIndex)
+		{
+			if (*pIndex == iLength)
+				return false;
+
+			char cChar = pJson[*pIndex];
+			if (iDepth == 0)
+			{
+				if (cChar == ']')
+				{
+					if (bExpectValue && oValues.Size() > 0)
+						return false;
+					break;
+				}
+				else if (cChar == ',')
+				{
+					if (bExpectValue)
+						return false;
+					bExpectValue = true;
+					continue;
+				}
+				else if (bExpectValue == false)
+				{
+					return false;
+				}
+				oValues.Push(*pIndex);
+				bExpectValue = false;
+			}
+
+			if (cChar == '{' || cChar == '[')
+				++iDepth;
+			else if (cChar == '}' || cChar == ']')
+				--iDepth;
+		}
+
+		size_t iValueCount = oValues.Size();
+		if (iValueCount < iThreadCount * 16)
+			return false;
+
+		// Ranges of about the same size in bytes
+		ParallelRange* pRanges = new ParallelRange[iThreadCount];
+		const uint32_t* pValues = oValues.Data();
+		size_t iRangeBytes = (pValues[iValueCount - 1] - pValues[0]) / iThreadCount + 1;
+		size_t iValue = 0;
+		for (size_t i = 0; i < iThreadCount; ++i)
+		{
+			ParallelRange& oRange = pRanges[i];
+			oRange.m_pJson = pJson;
+			oRange.m_pBegin = pValues + iValue;
+			uint32_t iRangeEnd = pValues[0] + (uint32_t)(iRangeBytes * (i + 1));
+			while (iValue < iValueCount && (pValues[iValue] < iRangeEnd || i == iThreadCount - 1))
+				++iValue;
+			oRange.m_pEnd = pValues + iValue;
+
+			oRange.m_pArena = new JsonDoc(m_iBlockSize);
+			oRange.m_pAllocator = (Allocator*)Allocate(this, sizeof(Allocator), alignof(Allocator));
+			*oRange.m_pAllocator = oRange.m_pArena->m_oAllocator;
+			oRange.m_pFirst = NULL;
+			oRange.m_pLast = NULL;
+			oRange.m_iCount = 0;
+			oRange.m_pError = NULL;
+		}
+
+		// Current thread parses the first range
+		std::thread* pThreads = new std::thread[iThreadCount - 1];
+		for (size_t i = 1; i < iThreadCount; ++i)
+			pThreads[i - 1] = std::thread(&JsonDoc::ParseParallelRange, &pRanges[i]);
+		ParseParallelRange(&pRanges[0]);
+		for (size_t i = 0; i < iThreadCount - 1; ++i)
+			pThreads[i].join();
+		delete[] pThreads;
+
+		// Move arenas blocks in this JsonDoc and chain the values
+		const char* pError = NULL;
+		size_t iLinkedCount = 0;
+		m_oRoot.InitType(JsonValue::E_TYPE_ARRAY);
+		for (size_t i = 0; i < iThreadCount; ++i)
+		{
+			ParallelRange& oRange = pRanges[i];
+			if (pError == NULL)
+				pError = oRange.m_pError;
+
+			Block* pOldest = oRange.m_pArena->m_pLastBlock;
+			if (pOldest != NULL)
+			{
+				while (pOldest->m_pPrevious != NULL)
+					pOldest = pOldest->m_pPrevious;
+				pOldest->m_pPrevious = m_pLastBlock;
+				m_pLastBlock = oRange.m_pArena->m_pLastBlock;
+				oRange.m_pArena->m_pLastBlock = NULL;
+				m_iReserved += oRange.m_pArena->m_iReserved;
+				oRange.m_pArena->m_iReserved = 0;
+				if (m_iReserved > m_iPeak)
+					m_iPeak = m_iReserved;
+			}
+			delete oRange.m_pArena;
+			oRange.m_pAllocator->pUserData = this;
+
+			if (oRange.m_pFirst != NULL)
+			{
+				if (m_oRoot.m_oValue.Childs.m_pLast != NULL)
+					m_oRoot.m_oValue.Childs.m_pLast->m_pNext = oRange.m_pFirst;
+				else
+					m_oRoot.m_oValue.Childs.m_pFirst = oRange.m_pFirst;
+				m_oRoot.m_oValue.Childs.m_pLast = oRange.m_pLast;
+				iLinkedCount += oRange.m_iCount;
+			}
+		}
+		delete[] pRanges;
+
+		// On error the root keeps the values parsed so far, as the sequential path does
+		m_oRoot.m_iChildCount = (int)iLinkedCount;
+		if (pError != NULL)
+		{
+			iResult = Internal::CountLines(pJson, pError);
+			return true;
+		}
+
+		if (m_oRoot.m_iChildCount > STTHM_ARRAY_INDEX_THRESHOLD)
+			m_oRoot.BuildChildArray();
+		iResult = 0;
+		return true;
+	}
+
+	void JsonDoc::ParseParallelRange(ParallelRange* pRange)
+	{
+		Allocator* pAllocator = pRange->m_pAllocator;
+		for (const uint32_t* pValue = pRange->m_pBegin; pValue != pRange->m_pEnd; ++pValue)
+		{
+			JsonValue* pNewValue = pAllocator->CreateJsonValue(pAllocator, pAllocator->pUserData);
+			const char* pString = pRange->m_pJson + *pValue;
+			bool bValid = pNewValue->Parse(pString, false);
+
+			// Value must end right before the next separator
+			if (bValid)
+				Internal::SkipSpaces(pString);
+			if (bValid == false || (*pString != ',' && *pString != ']'))
+			{
+				pRange->m_pError = pString;
+				return;
+			}
+
+			if (pRange->m_pLast != NULL)
+				pRange->m_pLast->m_pNext = pNewValue;
+			else
+				pRange->m_pFirst = pNewValue;
+			pRange->m_pLast = pNewValue;
+			++pRange->m_iCount;
+		}
+	}
+
+	JsonDoc::Block* JsonDoc::NewBlock(JsonDoc* pDoc, size_t iMinSize)
+	{
+		// Retained blocks are sorted, the first one is the largest
+		Block* pBlock = pDoc->m_pRetainedBlocks;
+		if (pBlock != NULL && pBlock->m_iSize >= iMinSize)
+		{
+			pDoc->m_pRetainedBlocks = pBlock->m_pPrevious;
+			return pBlock;
+		}
+
+		// Twice the current block, at least iMinSize
+		size_t iBlockSize = pDoc->m_iBlockSize;
+		if (pDoc->m_pLastBlock != NULL)
+		{
+			size_t iGrownSize = pDoc->m_pLastBlock->m_iSize * 2;
+			if (iGrownSize > (size_t)STTHM_DOC_MAX_BLOCK_SIZE)
+				iGrownSize = (size_t)STTHM_DOC_MAX_BLOCK_SIZE;
+			if (iGrownSize > iBlockSize)
+				iBlockSize = iGrownSize;
+		}
+		if (iBlockSize < iMinSize)
+			iBlockSize = iMinSize;
+
+		pBlock = (Block*)JsonStthmMalloc(iBlockSize);
+		pBlock->m_iSize = iBlockSize;
+		pBlock->m_iUsed = sizeof(Block);
+		pDoc->m_iReserved += iBlockSize;
+		if (pDoc->m_iReserved > pDoc->m_iPeak)
+			pDoc->m_iPeak = pDoc->m_iReserved;
+		return pBlock;
+	}
+
+	void* JsonDoc::Allocate(JsonDoc* pDoc, size_t iSize, size_t iAlign)
+	{
+		Block* pHead = pDoc->m_pLastBlock;
+		if (pHead != NULL && (iSize + iAlign + pHead->m_iUsed) <= pHead->m_iSize)
+		{
+			char* pMem = ((char*)pHead) + pHead->m_iUsed;
+			size_t iAlignOffset = (iAlign - ((intptr_t)pMem % iAlign)) % iAlign;
+			pMem += iAlignOffset;
+
+			JsonStthmAssert((intptr_t)pMem % iAlign == 0);
+
+			pHead->m_iUsed += iSize + iAlignOffset;
+			return pMem;
+		}
+
+		Block* pBlock = NewBlock(pDoc, sizeof(Block) + iSize + iAlign);
+
+		char* pMem = (char*)(pBlock + 1);
+		size_t iAlignOffset = (iAlign - ((intptr_t)pMem % iAlign)) % iAlign;
+		pMem += iAlignOffset;
+
+		pBlock->m_iUsed = sizeof(Block) + iSize + iAlignOffset;
+
+		// A block with less room left than the head, like one sized for a big string, goes behind it
+		if (pHead == NULL || pBlock->m_iSize - pBlock->m_iUsed >= pHead->m_iSize - pHead->m_iUsed)
+		{
+			pBlock->m_pPrevious = pHead;
+			pDoc->m_pLastBlock = pBlock;
+		}
+		else
+		{
+			pBlock->m_pPrevious = pHead->m_pPrevious;
+			pHead->m_pPrevious = pBlock;
+		}
+
+		JsonStthmAssert((intptr_t)pMem % iAlign == 0);
+
+		return pMem;
+	}
+
+	JsonValue* JsonDoc::CreateJsonValue(Allocator* pAllocator, void* pUserData)
+	{
+		JsonValue* pValue = (JsonValue*)Allocate((JsonDoc*)pUserData, sizeof(JsonValue), alignof(JsonValue));
+		if (pValue != NULL)
+		{
+			memset(pValue, 0, sizeof(JsonValue));
+			pValue->m_pAllocator = pAllocator;
+			return pValue;
+		}
+		return NULL;
+	}
+
+	// Memory is only released by Clear(), the value and what it owns become dead bytes
+	void JsonDoc::DeleteJsonValue(JsonValue* pValue, void* pUserData)
+	{
+		pValue->~JsonValue();
+		((JsonDoc*)pUserData)->m_iDead += sizeof(JsonValue);
+	}
+
+	char* JsonDoc::AllocString(size_t iSize, void* pUserData)
+	{
+		return (char*)Allocate((JsonDoc*)pUserData, iSize, 1);
+	}
+
+	void JsonDoc::FreeString(char* pString, void* pUserData)
+	{
+		JsonDoc* pDoc = (JsonDoc*)pUserData;
+		if (pString != NULL && (pDoc->m_bInSitu == false || pDoc->IsInBlocks(pString)))
+			pDoc->m_iDead += strlen(pString) + 1;
+	}
+
+	// Size is stored before the memory, for the dead bytes count
+	void* JsonDoc::AllocMemory(size_t iSize, void* pUserData)
+	{
+		const size_t iAlign = alignof(void*) > alignof(int64_t) ? alignof(void*) : alignof(int64_t);
+		char* pMemory = (char*)Allocate((JsonDoc*)pUserData, iAlign + iSize, iAlign);
+		*(size_t*)pMemory = iSize;
+		return pMemory + iAlign;
+	}
+
+	void JsonDoc::FreeMemory(void* pMemory, void* pUserData)
+	{
+		const size_t iAlign = alignof(void*) > alignof(int64_t) ? alignof(void*) : alignof(int64_t);
+		if (pMemory != NULL)
+			((JsonDoc*)pUserData)->m_iDead += iAlign + *(size_t*)((char*)pMemory - iAlign);
+	}
+
+	bool JsonDoc::IsInBlocks(const void* pMemory) const
+	{
+		for (Block* pBlock = m_pLastBlock; pBlock != NULL; pBlock = pBlock->m_pPrevious)
+		{
+			if ((const char*)pMemory >= (const char*)pBlock && (const char*)pMemory < (const char*)pBlock + pBlock->m_iSize)
+				return true;
+		}
+		return false;
+	}
+
+	size_t JsonDoc::MemoryUsage() const
+	{
+		return m_iReserved;
+	}
+
+	void JsonDoc::GetMemoryStats(MemoryStats& oStats) const
+	{
+		oStats.m_iReserved = m_iReserved;
+		oStats.m_iUsed = 0;
+		oStats.m_iWasted = 0;
+		oStats.m_iRetained = 0;
+		oStats.m_iDead = m_iDead;
+		oStats.m_iPeak = m_iPeak;
+		oStats.m_iBlockCount = 0;
+		for (Block* pBlock = m_pLastBlock; pBlock != NULL; pBlock = pBlock->m_pPrevious)
+		{
+			oStats.m_iUsed += pBlock->m_iUsed - sizeof(Block);
+			if (pBlock != m_pLastBlock)
+				oStats.m_iWasted += pBlock->m_iSize - pBlock->m_iUsed;
+			++oStats.m_iBlockCount;
+		}
+		for (Block* pBlock = m_pRetainedBlocks; pBlock != NULL; pBlock = pBlock->m_pPrevious)
+		{
+			oStats.m_iRetained += pBlock->m_iSize;
+			++oStats.m_iBlockCount;
+		}
+	}
+
+	//////////////////////////////
+	// JsonTapeValue::Iterator
+	//////////////////////////////
+
+	JsonTapeValue::Iterator::Iterator(const JsonTapeValue& oValue)
+		: m_bObject(false)
+	{
+		if (oValue.IsContainer())
+		{
+			m_oChild.m_pTape = oValue.m_pTape;
+			m_bObject = oValue.IsObject();
+			SetChild(oValue.m_iIndex + 1);
+		}
+	}
+
+	JsonTapeValue::Iterator::Iterator(const Iterator& oIt)
+		: m_oChild(oIt.m_oChild)
+		, m_bObject(oIt.m_bObject)
+	{
+	}
+
+	bool JsonTapeValue::Iterator::IsValid() const
+	{
+		return m_oChild.IsValid();
+	}
+
+	bool JsonTapeValue::Iterator::operator!=(const Iterator& oIte) const
+	{
+		return m_oChild.m_pTape != oIte.m_oChild.m_pTape || m_oChild.m_iIndex != oIte.m_oChild.m_iIndex;
+	}
+
+	void JsonTapeValue::Iterator::operator++()
+	{
+		if (m_oChild.m_pTape != NULL)
+			SetChild(m_oChild.m_pTape->GetNext(m_oChild.m_iIndex));
+	}
+
+	const JsonTapeValue& JsonTapeValue::Iterator::operator*() const
+	{
+		return m_oChild;
+	}
+
+	const JsonTapeValue* JsonTapeValue::Iterator::operator->() const
+	{
+		return &m_oChild;
+	}
+
+	void JsonTapeValue::Iterator::SetChild(uint32_t iIndex)
+	{
+		const JsonTape* pTape = m_oChild.m_pTape;
+		if (pTape->GetTag(iIndex) == JsonTape::E_TAG_END)
+		{
+			m_oChild = JsonTapeValue();
+		}
+		else if (m_bObject)
+		{
+			// Member value follows its key
+			m_oChild = JsonTapeValue(pTape, iIndex + 1, pTape->GetString(iIndex));
 		}
 		else
 		{
-			InitType(E_TYPE_NULL);
+			m_oChild = JsonTapeValue(pTape, iIndex, NULL);
+		}
+	}
+
+	//////////////////////////////
+	// JsonTapeValue
+	//////////////////////////////
+
+	JsonTapeValue::JsonTapeValue()
+		: m_pTape(NULL)
+		, m_iIndex(0)
+		, m_pName(NULL)
+	{
+	}
+
+	JsonTapeValue::JsonTapeValue(const JsonTape* pTape, uint32_t iIndex, const char* pName)
+		: m_pTape(pTape)
+		, m_iIndex(iIndex)
+		, m_pName(pName)
+	{
+	}
+
+	JsonValue::EType JsonTapeValue::GetType() const
+	{
+		if (m_pTape == NULL)
+			return JsonValue::E_TYPE_NULL;
+
+		switch (m_pTape->GetTag(m_iIndex))
+		{
+		case JsonTape::E_TAG_TRUE:
+		case JsonTape::E_TAG_FALSE:
+			return JsonValue::E_TYPE_BOOLEAN;
+		case JsonTape::E_TAG_INTEGER:
+			return JsonValue::E_TYPE_INTEGER;
+		case JsonTape::E_TAG_FLOAT:
+			return JsonValue::E_TYPE_FLOAT;
+		case JsonTape::E_TAG_STRING:
+			return JsonValue::E_TYPE_STRING;
+		case JsonTape::E_TAG_OBJECT:
+			return JsonValue::E_TYPE_OBJECT;
+		case JsonTape::E_TAG_ARRAY:
+			return JsonValue::E_TYPE_ARRAY;
+		default:
+			return JsonValue::E_TYPE_NULL;
+		}
+	}
+
+	int JsonTapeValue::GetMemberCount() const
+	{
+		if (IsContainer() == false)
+			return 0;
+
+		int iCount = (int)(m_pTape->GetPayload(m_iIndex) >> 32);
+		if (iCount < 0xFFFFFF)
+			return iCount;
+
+		// Saturated count, walk the childs
+		iCount = 0;
+		for (Iterator oIt(*this); oIt.IsValid(); ++oIt)
+			++iCount;
+		return iCount;
+	}
+
+	const char* JsonTapeValue::ToString() const
+	{
+		if (IsString())
+			return m_pTape->GetString(m_iIndex);
+		return NULL;
+	}
+
+	bool JsonTapeValue::ToBoolean() const
+	{
+		if (m_pTape != NULL)
+			return m_pTape->GetTag(m_iIndex) == JsonTape::E_TAG_TRUE;
+		return false;
+	}
+
+	int64_t JsonTapeValue::ToInteger() const
+	{
+		if (m_pTape != NULL)
+		{
+			// The payload word only follows number tags
+			switch (m_pTape->GetTag(m_iIndex))
+			{
+			case JsonTape::E_TAG_INTEGER:
+				return (int64_t)m_pTape->m_oTape.Data()[m_iIndex + 1];
+			case JsonTape::E_TAG_FLOAT:
+			{
+				double fValue;
+				memcpy(&fValue, &m_pTape->m_oTape.Data()[m_iIndex + 1], sizeof(double));
+				return (int64_t)fValue;
+			}
+			default:
+				break;
+			}
+		}
+		return 0;
+	}
+
+	double JsonTapeValue::ToFloat() const
+	{
+		if (m_pTape != NULL)
+		{
+			switch (m_pTape->GetTag(m_iIndex))
+			{
+			case JsonTape::E_TAG_INTEGER:
+				return (double)(int64_t)m_pTape->m_oTape.Data()[m_iIndex + 1];
+			case JsonTape::E_TAG_FLOAT:
+			{
+				double fValue;
+				memcpy(&fValue, &m_pTape->m_oTape.Data()[m_iIndex + 1], sizeof(double));
+				return fValue;
+			}
+			default:
+				break;
+			}
+		}
+		return 0.0;
+	}
+
+#ifdef STTHM_ENABLE_IMPLICIT_CAST
+	JsonTapeValue::operator const char*() const
+	{
+		return ToString();
+	}
+
+	JsonTapeValue::operator bool() const
+	{
+		return ToBoolean();
+	}
+
+	JsonTapeValue::operator int64_t() const
+	{
+		return ToInteger();
+	}
+
+	JsonTapeValue::operator double() const
+	{
+		return ToFloat();
+	}
+#endif //STTHM_ENABLE_IMPLICIT_CAST
+
+	JsonTapeValue JsonTapeValue::operator[](const char* pName) const
+	{
+		if (IsObject() && pName != NULL)
+		{
+			for (Iterator oIt(*this); oIt.IsValid(); ++oIt)
+			{
+				if (strcmp(oIt->m_pName, pName) == 0)
+					return *oIt;
+			}
+		}
+		return JsonTapeValue();
+	}
+
+	JsonTapeValue JsonTapeValue::operator[](int iIndex) const
+	{
+		if (IsContainer() && iIndex >= 0)
+		{
+			// Skip whole sub trees with the container end offsets
+			for (Iterator oIt(*this); oIt.IsValid(); ++oIt)
+			{
+				if (iIndex-- == 0)
+					return *oIt;
+			}
+		}
+		return JsonTapeValue();
+	}
+
+	//////////////////////////////
+	// JsonTape
+	//////////////////////////////
+
+	JsonTape::JsonTape()
+	{
+		m_oStringAllocator.CreateJsonValue	= NULL;
+		m_oStringAllocator.DeleteJsonValue	= NULL;
+		m_oStringAllocator.AllocString		= &JsonTape::AllocString;
+		m_oStringAllocator.FreeString		= &JsonTape::FreeString;
+		m_oStringAllocator.pUserData		= this;
+		m_oStringAllocator.AllocMemory		= NULL;
+		m_oStringAllocator.FreeMemory		= NULL;
+	}
+
+	JsonTape::~JsonTape()
+	{
+	}
+
+	JsonTapeValue JsonTape::GetRoot() const
+	{
+		if (m_oTape.Size() == 0)
+			return JsonTapeValue();
+		return JsonTapeValue(this, 0, NULL);
+	}
+
+	void JsonTape::Clear()
+	{
+		m_oTape.Clear();
+		m_oStrings.Clear();
+	}
+
+	int JsonTape::ReadString(const char* pJson)
+	{
+		Clear();
+		if (pJson != NULL)
+		{
+			const char* pEnd = pJson;
+			if (ParseValue(pEnd, 0) == false)
+			{
+				Clear();
+				return Internal::CountLines(pJson, pEnd);
+			}
+			return 0;
+		}
+		return -1;
+	}
+
+	int JsonTape::ReadFile(const char* pFilename)
+	{
+		Internal::FileContent oContent;
+		int iResult = oContent.Load(pFilename, true);
+		if (iResult != 0)
+			return iResult;
+
+		return ReadString(oContent.Data());
+	}
+
+	size_t JsonTape::MemoryUsage() const
+	{
+		return m_oTape.Size() * sizeof(uint64_t) + m_oStrings.Size();
+	}
+
+	uint32_t JsonTape::GetNext(uint32_t iIndex) const
+	{
+		switch (GetTag(iIndex))
+		{
+		case E_TAG_OBJECT:
+		case E_TAG_ARRAY:
+			return (uint32_t)GetPayload(iIndex);
+		case E_TAG_INTEGER:
+		case E_TAG_FLOAT:
+			return iIndex + 2;
+		default:
+			return iIndex + 1;
+		}
+	}
+
+	bool JsonTape::PushString(const char*& pString, ETag eTag)
+	{
+		size_t iOffset = m_oStrings.Size();
+		char* pValue = JsonValue::ReadStringValue(pString, &m_oStringAllocator, false);
+		if (pValue == NULL)
+			return false;
+
+		// Allocation is an upper bound when the string contains escaped chars, give back the unused part
+		m_oStrings.Resize(iOffset + strlen(m_oStrings.Data() + iOffset) + 1);
+		PushWord(eTag, iOffset);
+		return true;
+	}
+
+	bool JsonTape::ParseValue(const char*& pString, int iDepth)
+	{
+		Internal::SkipSpaces(pString);
+		switch (*pString)
+		{
+		case 0:
+			PushWord(E_TAG_NULL, 0);
+			return true;
+		case '"':
+			return PushString(++pString, E_TAG_STRING);
+		case 'N':
+		case 'I':
+		case '-':
+		case '0': case '1': case '2': case '3': case '4':
+		case '5': case '6': case '7': case '8': case '9':
+		{
+			double fValue;
+			int64_t iValue;
+			if (Internal::MatchLiteral(pString, "NaN", 3))
+			{
+				fValue = Internal::c_fNaN;
+			}
+			else if (Internal::MatchLiteral(pString, "Infinity", 8))
+			{
+				fValue = Internal::c_fInfinity;
+			}
+			else if (Internal::MatchLiteral(pString, "-Infinity", 9))
+			{
+				fValue = Internal::c_fNegativeInfinity;
+			}
+			else
+			{
+				Internal::ENumberType eNumber = Internal::ParseNumber(pString, iValue, fValue);
+				if (eNumber == Internal::E_NUMBER_INVALID)
+					return false;
+				if (eNumber == Internal::E_NUMBER_INTEGER)
+				{
+					PushWord(E_TAG_INTEGER, 0);
+					m_oTape.Push((uint64_t)iValue);
+					return true;
+				}
+			}
+
+			uint64_t iRaw;
+			memcpy(&iRaw, &fValue, sizeof(double));
+			PushWord(E_TAG_FLOAT, 0);
+			m_oTape.Push(iRaw);
+			return true;
+		}
+		case 't':
+			if (Internal::MatchLiteral(pString, "true", 4))
+			{
+				PushWord(E_TAG_TRUE, 0);
+				return true;
+			}
+			break;
+		case 'f':
+			if (Internal::MatchLiteral(pString, "false", 5))
+			{
+				PushWord(E_TAG_FALSE, 0);
+				return true;
+			}
+			break;
+		case 'n':
+			if (Internal::MatchLiteral(pString, "null", 4))
+			{
+				PushWord(E_TAG_NULL, 0);
+				return true;
+			}
+			break;
+		case '{':
+			if (iDepth >= STTHM_MAX_DEPTH)
+				return false;
+			++pString;
+			return ParseObject(pString, iDepth + 1);
+		case '[':
+			if (iDepth >= STTHM_MAX_DEPTH)
+				return false;
+			++pString;
+			return ParseArray(pString, iDepth + 1);
+		default:
+			break;
+		}
+
+		// Error
+		return false;
+	}
+
+	bool JsonTape::ParseObject(const char*& pString, int iDepth)
+	{
+		size_t iStart = m_oTape.Size();
+		PushWord(E_TAG_OBJECT, 0);
+		uint64_t iCount = 0;
+
+		Internal::SkipSpaces(pString);
+		if (*pString != '}')
+		{
+			for (;;)
+			{
+				Internal::SkipSpaces(pString);
+
+				// Read member name
+				if (*pString != '"' || PushString(++pString, E_TAG_KEY) == false)
+					return false;
+
+				Internal::SkipSpaces(pString);
+				if (*pString != ':')
+					return false;
+				++pString;
+
+				Internal::SkipSpaces(pString);
+				if (*pString == 0 || ParseValue(pString, iDepth) == false)
+					return false;
+
+				++iCount;
+
+				Internal::SkipSpaces(pString);
+				if (*pString == '}')
+					break;
+				else if (*pString != ',')
+					return false;
+				++pString;
+			}
+		}
+		++pString;
+
+		PushWord(E_TAG_END, iStart);
+		JsonStthmAssert(m_oTape.Size() <= 0xFFFFFFFF);
+		if (iCount > 0xFFFFFF)
+			iCount = 0xFFFFFF;
+		m_oTape.Data()[iStart] = ((uint64_t)E_TAG_OBJECT << 56) | (iCount << 32) | (uint32_t)m_oTape.Size();
+		return true;
+	}
+
+	bool JsonTape::ParseArray(const char*& pString, int iDepth)
+	{
+		size_t iStart = m_oTape.Size();
+		PushWord(E_TAG_ARRAY, 0);
+		uint64_t iCount = 0;
+
+		Internal::SkipSpaces(pString);
+		if (*pString != ']')
+		{
+			for (;;)
+			{
+				Internal::SkipSpaces(pString);
+				if (*pString == 0 || ParseValue(pString, iDepth) == false)
+					return false;
+
+				++iCount;
+
+				Internal::SkipSpaces(pString);
+				if (*pString == ']')
+					break;
+				else if (*pString != ',')
+					return false;
+				++pString;
+			}
+		}
+		++pString;
+
+		PushWord(E_TAG_END, iStart);
+		JsonStthmAssert(m_oTape.Size() <= 0xFFFFFFFF);
+		if (iCount > 0xFFFFFF)
+			iCount = 0xFFFFFF;
+		m_oTape.Data()[iStart] = ((uint64_t)E_TAG_ARRAY << 56) | (iCount << 32) | (uint32_t)m_oTape.Size();
+		return true;
+	}
+
+	char* JsonTape::AllocString(size_t iSize, void* pUserData)
+	{
+		Internal::Buffer<char, 1>& oStrings = ((JsonTape*)pUserData)->m_oStrings;
+		oStrings.Resize(oStrings.Size() + iSize);
+		return oStrings.Data() + oStrings.Size() - iSize;
+	}
+
+	void JsonTape::FreeString(char* /*pString*/, void* /*pUserData*/)
+	{
+		// Do nothing, tape is cleared on error
+	}
+
+	//////////////////////////////
+	// JsonLazyValue::Iterator
+	//////////////////////////////
+
+	JsonLazyValue::Iterator::Iterator(const JsonLazyValue& oValue)
+		: m_bObject(false)
+	{
+		if (oValue.m_pDoc != NULL)
+		{
+			char cChar = oValue.m_pDoc->GetChar(oValue.m_iIndex);
+			if (cChar == '{' || cChar == '[')
+			{
+				m_bObject = cChar == '{';
+				uint32_t iName = 0;
+				uint32_t iChild = oValue.m_pDoc->GetFirstChild(oValue.m_iIndex, m_bObject, iName);
+				if (iChild != 0)
+					m_oChild = JsonLazyValue(oValue.m_pDoc, iChild, iName);
+			}
+		}
+	}
+
+	JsonLazyValue::Iterator::Iterator(const Iterator& oIt)
+		: m_oChild(oIt.m_oChild)
+		, m_bObject(oIt.m_bObject)
+	{
+	}
+
+	bool JsonLazyValue::Iterator::IsValid() const
+	{
+		return m_oChild.IsValid();
+	}
+
+	bool JsonLazyValue::Iterator::operator!=(const Iterator& oIte) const
+	{
+		return m_oChild.m_pDoc != oIte.m_oChild.m_pDoc || m_oChild.m_iIndex != oIte.m_oChild.m_iIndex;
+	}
+
+	void JsonLazyValue::Iterator::operator++()
+	{
+		if (m_oChild.m_pDoc != NULL)
+		{
+			uint32_t iName = 0;
+			uint32_t iChild = m_oChild.m_pDoc->GetNextChild(m_oChild.m_iIndex, m_bObject, iName);
+			if (iChild != 0)
+				m_oChild = JsonLazyValue(m_oChild.m_pDoc, iChild, iName);
+			else
+				m_oChild = JsonLazyValue();
 		}
 	}
 
-	void JsonValue::SetBoolean(bool bValue)
+	const JsonLazyValue& JsonLazyValue::Iterator::operator*() const
 	{
-		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
-		if (this == &JsonStthm::JsonValue::INVALID)
-			return;
+		return m_oChild;
+	}
 
-		InitType(E_TYPE_BOOLEAN);
-		m_oValue.Boolean = bValue;
+	const JsonLazyValue* JsonLazyValue::Iterator::operator->() const
+	{
+		return &m_oChild;
 	}
 
-	void JsonValue::SetInteger(int64_t iValue)
+	//////////////////////////////
+	// JsonLazyValue
+	//////////////////////////////
+
+	JsonLazyValue::JsonLazyValue()
+		: m_pDoc(NULL)
+		, m_iIndex(0)
+		, m_iName(0)
 	{
-		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
-		if (this == &JsonStthm::JsonValue::INVALID)
-			return;
+	}
 
-		InitType(E_TYPE_INTEGER);
-		m_oValue.Integer = iValue;
+	JsonLazyValue::JsonLazyValue(const JsonLazyDoc* pDoc, uint32_t iIndex, uint32_t iName)
+		: m_pDoc(pDoc)
+		, m_iIndex(iIndex)
+		, m_iName(iName)
+	{
 	}
 
-	void JsonValue::SetFloat(double fValue)
+	JsonValue::EType JsonLazyValue::GetType() const
 	{
-		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
-		if (this == &JsonStthm::JsonValue::INVALID)
-			return;
+		if (m_pDoc == NULL)
+			return JsonValue::E_TYPE_NULL;
 
-		InitType(E_TYPE_FLOAT);
-		m_oValue.Float = fValue;
+		switch (m_pDoc->GetChar(m_iIndex))
+		{
+		case '{':
+			return JsonValue::E_TYPE_OBJECT;
+		case '[':
+			return JsonValue::E_TYPE_ARRAY;
+		case '"':
+			return JsonValue::E_TYPE_STRING;
+		default:
+		{
+			Internal::Scalar oScalar;
+			if (Internal::ReadScalarToken(m_pDoc->GetPointer(m_iIndex), oScalar))
+				return oScalar.eType;
+			return JsonValue::E_TYPE_NULL;
+		}
+		}
 	}
 
-	JsonValue& JsonValue::Append()
+	int JsonLazyValue::GetMemberCount() const
 	{
-		JsonStthmAssert(this != &INVALID);
-		if (this == &INVALID)
-			return INVALID;
+		int iCount = 0;
+		for (Iterator oIt(*this); oIt.IsValid(); ++oIt)
+			++iCount;
+		return iCount;
+	}
 
-		if (m_eType == E_TYPE_NULL)
-			InitType(E_TYPE_ARRAY);
+	const char* JsonLazyValue::GetName() const
+	{
+		if (m_pDoc != NULL && m_iName != 0)
+			return m_pDoc->UnescapeString(m_iName);
+		return NULL;
+	}
 
-		if (m_eType != E_TYPE_ARRAY)
-			return INVALID;
+	const char* JsonLazyValue::ToString() const
+	{
+		if (m_pDoc != NULL && m_pDoc->GetChar(m_iIndex) == '"')
+			return m_pDoc->UnescapeString(m_iIndex);
+		return NULL;
+	}
 
-		// Append new element
-		JsonValue* pNewChild = m_pAllocator->CreateJsonValue(m_pAllocator, m_pAllocator->pUserData);
+	bool JsonLazyValue::ToBoolean() const
+	{
+		Internal::Scalar oScalar;
+		if (m_pDoc != NULL && Internal::ReadScalarToken(m_pDoc->GetPointer(m_iIndex), oScalar) && oScalar.eType == JsonValue::E_TYPE_BOOLEAN)
+			return oScalar.bBoolean;
+		return false;
+	}
 
-		if (NULL != m_oValue.Childs.m_pLast)
-			m_oValue.Childs.m_pLast->m_pNext = pNewChild;
-		else
-			m_oValue.Childs.m_pFirst = pNewChild;
+	int64_t JsonLazyValue::ToInteger() const
+	{
+		Internal::Scalar oScalar;
+		if (m_pDoc != NULL && Internal::ReadScalarToken(m_pDoc->GetPointer(m_iIndex), oScalar))
+		{
+			if (oScalar.eType == JsonValue::E_TYPE_INTEGER)
+				return oScalar.iInteger;
+			else if (oScalar.eType == JsonValue::E_TYPE_FLOAT)
+				return (int64_t)oScalar.fFloat;
+		}
+		return 0;
+	}
+
+	double JsonLazyValue::ToFloat() const
+	{
+		Internal::Scalar oScalar;
+		if (m_pDoc != NULL && Internal::ReadScalarToken(m_pDoc->GetPointer(m_iIndex), oScalar))
+		{
+			if (oScalar.eType == JsonValue::E_TYPE_FLOAT)
+				return oScalar.fFloat;
+			else if (oScalar.eType == JsonValue::E_TYPE_INTEGER)
+				return (double)oScalar.iInteger;
+		}
+		return 0.0;
+	}
 
-		m_oValue.Childs.m_pLast = pNewChild;
+#ifdef STTHM_ENABLE_IMPLICIT_CAST
+	JsonLazyValue::operator const char*() const
+	{
+		return ToString();
+	}
 
-		return *m_oValue.Childs.m_pLast;
+	JsonLazyValue::operator bool() const
+	{
+		return ToBoolean();
 	}
 
-	bool JsonValue::Combine(const JsonValue& oRight, bool bMergeSubMembers)
+	JsonLazyValue::operator int64_t() const
 	{
-		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
-		if (this == &JsonStthm::JsonValue::INVALID)
-			return false;
+		return ToInteger();
+	}
 
-		if (m_eType != oRight.m_eType)
-			return false;
+	JsonLazyValue::operator double() const
+	{
+		return ToFloat();
+	}
+#endif //STTHM_ENABLE_IMPLICIT_CAST
 
-		switch(m_eType)
-		{
-		case E_TYPE_NULL:
-			// Nothing to do
-			break;
-		case E_TYPE_OBJECT:
+	JsonLazyValue JsonLazyValue::operator[](const char* pName) const
+	{
+		if (m_pDoc != NULL && pName != NULL && m_pDoc->GetChar(m_iIndex) == '{')
 		{
-			// Replace value or try to add recursively values of sub objects
-			for (const JsonValue* pChild =  oRight.m_oValue.Childs.m_pFirst; pChild != NULL; pChild = pChild->m_pNext)
+			// Names are compared in the raw buffer, member values are never parsed
+			for (Iterator oIt(*this); oIt.IsValid(); ++oIt)
 			{
-				JsonValue& oLeftChild = (*this)[pChild->m_pName];
-				if (bMergeSubMembers && oLeftChild.m_eType == pChild->m_eType) // Combine again is the childrens's type is the same otherwise replace it
-				{
-					(*this)[pChild->m_pName].Combine(*pChild, true);
-				}
-				else
-				{
-					(*this)[pChild->m_pName] = *pChild;
-				}
+				if (m_pDoc->MatchName(oIt->m_iName, pName))
+					return *oIt;
 			}
-			break;
 		}
-		case E_TYPE_ARRAY:
+		return JsonLazyValue();
+	}
+
+	JsonLazyValue JsonLazyValue::operator[](int iIndex) const
+	{
+		if (iIndex >= 0)
 		{
-			// Append to array
-			for (const JsonValue* pChild = oRight.m_oValue.Childs.m_pFirst; pChild != NULL; pChild = pChild->m_pNext)
+			for (Iterator oIt(*this); oIt.IsValid(); ++oIt)
 			{
-				Append() = *pChild;
+				if (iIndex-- == 0)
+					return *oIt;
 			}
-			break;
-		}
-		case E_TYPE_STRING:
-		{
-			// Concatenate strings
-			size_t iLenLeft = strlen(m_oValue.String);
-			size_t iLenRight = strlen(oRight.m_oValue.String);
-			size_t iLenNew = iLenLeft + iLenRight;
-			char* pNewString = m_pAllocator->AllocString(iLenNew + 1, m_pAllocator->pUserData);
-			memcpy(pNewString, m_oValue.String, iLenLeft);
-			memcpy(pNewString + iLenLeft, oRight.m_oValue.String, iLenRight);
-			pNewString[iLenNew] = 0;
-			m_pAllocator->FreeString(m_oValue.String, m_pAllocator->pUserData);
-			m_oValue.String = pNewString;
-			break;
-		}
-		case E_TYPE_BOOLEAN:
-			m_oValue.Boolean = m_oValue.Boolean || oRight.m_oValue.Boolean;
-			break;
-		case E_TYPE_INTEGER:
-			m_oValue.Integer += oRight.m_oValue.Integer;
-			break;
-		case E_TYPE_FLOAT:
-			m_oValue.Float += oRight.m_oValue.Float;
-			break;
 		}
+		return JsonLazyValue();
+	}
 
-		return true;
+	//////////////////////////////
+	// JsonLazyDoc
+	//////////////////////////////
+
+	JsonLazyDoc::JsonLazyDoc()
+		: m_pJson(NULL)
+		, m_pFile(NULL)
+		, m_iCached(0)
+	{
 	}
 
-	bool JsonValue::operator ==(const JsonValue& oRight) const
+	JsonLazyDoc::~JsonLazyDoc()
 	{
-		if (m_eType != oRight.m_eType)
-			return false;
+		Clear();
+		delete m_pFile;
+	}
 
-		switch (m_eType)
-		{
-		case E_TYPE_NULL:
-			break;
-		case E_TYPE_OBJECT:
-		{
-			// We don't care if members order is not the same
-			const JsonValue* pChildLeft = m_oValue.Childs.m_pFirst;
-			while (pChildLeft != NULL)
-			{
-				if (*pChildLeft != oRight[pChildLeft->m_pName])
-					return false;
+	JsonLazyValue JsonLazyDoc::GetRoot() const
+	{
+		if (m_pJson == NULL)
+			return JsonLazyValue();
+		return JsonLazyValue(this, 0, 0);
+	}
 
-				pChildLeft = pChildLeft->m_pNext;
-			}
-			break;
-		}
-		case E_TYPE_ARRAY:
+	void JsonLazyDoc::Clear()
+	{
+		m_pJson = NULL;
+		if (m_pFile != NULL)
+			m_pFile->Release();
+		m_oIndex.Clear();
+		m_oClose.Clear();
+		m_oStrings.Clear();
+		m_oCache.Clear();
+		m_iCached = 0;
+	}
+
+	int JsonLazyDoc::ReadString(const char* pJson)
+	{
+		Clear();
+		if (pJson != NULL)
 		{
-			JsonValue* pChildLeft = m_oValue.Childs.m_pFirst;
-			JsonValue* pChildRight = oRight.m_oValue.Childs.m_pFirst;
-			while (pChildLeft != NULL && pChildRight != NULL)
-			{
-				if (*pChildLeft != *pChildRight)
-					return false;
+			return Read(pJson, strlen(pJson));
+		}
+		return -1;
+	}
 
-				pChildLeft = pChildLeft->m_pNext;
-				pChildRight = pChildRight->m_pNext;
-			}
+	int JsonLazyDoc::ReadFile(const char* pFilename, int iFlags)
+	{
+		Clear();
+		if (m_pFile == NULL)
+			m_pFile = new Internal::FileContent();
 
-			if (pChildLeft != NULL || pChildRight != NULL)
-				return false;
-			break;
-		}
-		case E_TYPE_STRING:
-			if (strcmp(m_oValue.String, oRight.m_oValue.String) != 0)
-				return false;
-			break;
-		case E_TYPE_BOOLEAN:
-			if (memcmp(&m_oValue.Boolean, &oRight.m_oValue.Boolean, sizeof(m_oValue.Boolean)) != 0)
-				return false;
-			break;
-		case E_TYPE_INTEGER:
-			if (memcmp(&m_oValue.Integer, &oRight.m_oValue.Integer, sizeof(m_oValue.Integer)) != 0)
-				return false;
-			break;
-		case E_TYPE_FLOAT:
-			if (memcmp(&m_oValue.Float, &oRight.m_oValue.Float, sizeof(m_oValue.Float)) != 0)
-				return false;
-			break;
-		}
+		int iResult = m_pFile->Load(pFilename, (iFlags & JsonValue::E_READ_NO_FILE_MAPPING) == 0);
+		if (iResult != 0)
+			return iResult;
 
-		return true;
+		return Read(m_pFile->Data(), m_pFile->Size());
 	}
 
-	bool JsonValue::operator !=(const JsonValue& oRight) const
+	size_t JsonLazyDoc::MemoryUsage() const
 	{
-		return (*this == oRight) == false;
+		return (m_oIndex.Size() + m_oClose.Size()) * sizeof(uint32_t) + m_oCache.Size() * sizeof(CachedString) + m_oStrings.MemoryUsage();
 	}
 
-	const JsonValue& JsonValue::operator[](const char* pName) const
+	int JsonLazyDoc::Read(const char* pJson, size_t iLength)
 	{
-		if (m_eType == E_TYPE_OBJECT)
+		if (Internal::BuildStructuralIndex(pJson, iLength, m_oIndex) == false)
 		{
-			JsonValue* pChild = m_oValue.Childs.m_pFirst;
-			while (pChild != NULL)
-			{
-				if (strcmp(pChild->m_pName, pName) == 0)
-					return *pChild;
-				if (pChild->m_pNext == NULL)
-					break;
-				pChild = pChild->m_pNext;
-			}
+			Clear();
+			return -2;
 		}
-		return JsonValue::INVALID;
-	}
-
-	JsonValue& JsonValue::operator[](const char* pName)
-	{
-		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
-		if (this == &JsonStthm::JsonValue::INVALID)
-			return JsonValue::INVALID;
 
-		if (pName == NULL || pName[0] == 0)
-			return JsonValue::INVALID;
+		m_pJson = pJson;
 
-		if (m_eType == E_TYPE_NULL)
-			InitType(E_TYPE_OBJECT);
-		if (m_eType == E_TYPE_OBJECT)
+		// Match brackets so a whole container is skipped with a single lookup
+		const uint32_t iCount = (uint32_t)m_oIndex.Size() - 1;
+		m_oClose.Resize(iCount + 1);
+		uint32_t* pClose = m_oClose.Data();
+		Internal::Buffer<uint32_t> oOpen;
+		uint32_t iError = iCount;
+		for (uint32_t i = 0; i < iCount; ++i)
 		{
-			JsonValue* pChild = m_oValue.Childs.m_pFirst;
-			while (pChild != NULL)
+			char cChar = GetChar(i);
+			if (cChar == '{' || cChar == '[')
 			{
-				if (strcmp(pChild->m_pName, pName) == 0)
-					return *pChild;
-				if (pChild->m_pNext == NULL)
+				oOpen.Push(i);
+			}
+			else if (cChar == '}' || cChar == ']')
+			{
+				if (oOpen.Size() == 0 || GetChar(oOpen.Data()[oOpen.Size() - 1]) != (cChar == '}' ? '{' : '['))
+				{
+					iError = i;
 					break;
-				pChild = pChild->m_pNext;
+				}
+				pClose[oOpen.Data()[oOpen.Size() - 1]] = i;
+				oOpen.Resize(oOpen.Size() - 1);
 			}
+		}
 
-			JsonValue* pNewMember = m_pAllocator->CreateJsonValue(m_pAllocator, m_pAllocator->pUserData);
+		bool bValid = iError == iCount && oOpen.Size() == 0;
+		if (bValid && iCount > 0)
+		{
+			// A single root value
+			if (Internal::IsValueStart(GetChar(0)) == false)
+			{
+				iError = 0;
+				bValid = false;
+			}
+			else if (GetNext(0) != iCount)
+			{
+				iError = GetNext(0);
+				bValid = false;
+			}
+		}
 
-			size_t iNameLen = strlen(pName) + 1;
-			void* pNewString = m_pAllocator->AllocString(iNameLen, m_pAllocator->pUserData);
-			memcpy(pNewString, (const void*)pName, iNameLen);
-			pNewMember->m_pName = (char*)pNewString;
+		if (bValid == false)
+		{
+			int iLine = Internal::CountLines(pJson, GetPointer(iError));
+			Clear();
+			return iLine;
+		}
+		return 0;
+	}
 
-			if (NULL != m_oValue.Childs.m_pLast)
-				m_oValue.Childs.m_pLast->m_pNext = pNewMember;
-			else
-				m_oValue.Childs.m_pFirst = pNewMember;
+	uint32_t JsonLazyDoc::GetNext(uint32_t iIndex) const
+	{
+		char cChar = GetChar(iIndex);
+		if (cChar == '{' || cChar == '[')
+			return m_oClose.Data()[iIndex] + 1;
+		return iIndex + 1;
+	}
 
-			m_oValue.Childs.m_pLast = pNewMember;
-			return *pNewMember;
+	uint32_t JsonLazyDoc::GetFirstChild(uint32_t iContainer, bool bObject, uint32_t& iName) const
+	{
+		// Brackets are matched, so the container end is met before leaving it
+		uint32_t iChild = iContainer + 1;
+		if (bObject)
+		{
+			if (GetChar(iChild) != '"' || GetChar(iChild + 1) != ':')
+				return 0;
+			iName = iChild;
+			iChild += 2;
 		}
-		return JsonValue::INVALID;
+		return Internal::IsValueStart(GetChar(iChild)) ? iChild : 0;
 	}
 
-	const JsonValue& JsonValue::operator[](char* pName) const
+	uint32_t JsonLazyDoc::GetNextChild(uint32_t iChild, bool bObject, uint32_t& iName) const
 	{
-		return (*this)[(const char*)pName];
+		uint32_t iNext = GetNext(iChild);
+		if (GetChar(iNext) != ',')
+			return 0;
+		// A comma is followed by a child like an opening bracket
+		return GetFirstChild(iNext, bObject, iName);
 	}
 
-	JsonValue& JsonValue::operator[](char* pName)
+	bool JsonLazyDoc::MatchName(uint32_t iName, const char* pName) const
 	{
-		return (*this)[(const char*)pName];
+		return JsonValue::MatchStringValue(GetPointer(iName) + 1, pName);
 	}
 
-	const JsonValue& JsonValue::operator [](int iIndex) const
+	const char* JsonLazyDoc::UnescapeString(uint32_t iIndex) const
 	{
-		if (m_eType == E_TYPE_OBJECT || m_eType == E_TYPE_ARRAY)
+		if (m_oCache.Size() > 0)
 		{
-			JsonValue* pChild = m_oValue.Childs.m_pFirst;
-			int iCurrent = 0;
-			while (pChild != NULL)
-			{
-				if (iCurrent++ == iIndex)
-					return *pChild;
-				pChild = pChild->m_pNext;
-			}
+			CachedString* pCached = FindCachedString(iIndex);
+			if (pCached->m_pString != NULL)
+				return pCached->m_pString;
 		}
-		return JsonValue::INVALID;
-	}
 
-	JsonValue& JsonValue::operator[](int iIndex)
-	{
-		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
-		if (this == &JsonStthm::JsonValue::INVALID)
-			return JsonValue::INVALID;
+		const char* pString = GetPointer(iIndex) + 1;
+		const char* pUnescaped = JsonValue::ReadStringValue(pString, &m_oStrings.m_oAllocator, false);
+		if (pUnescaped == NULL)
+			return NULL;
 
-		if (m_eType == E_TYPE_NULL)
-			InitType(E_TYPE_ARRAY);
-		if (m_eType == E_TYPE_OBJECT || m_eType == E_TYPE_ARRAY)
+		// Keep load factor under 0.5
+		if ((m_iCached + 1) * 2 > m_oCache.Size())
 		{
-			JsonValue* pChild = m_oValue.Childs.m_pFirst;
-			int iCurrent = 0;
-			while (pChild != NULL)
+			Internal::Buffer<CachedString, 1> oOldCache;
+			oOldCache.PushRange(m_oCache.Data(), m_oCache.Size());
+			const size_t iCapacity = m_oCache.Size() > 0 ? m_oCache.Size() * 2 : 64;
+			m_oCache.Resize(iCapacity);
+			memset(m_oCache.Data(), 0, iCapacity * sizeof(CachedString));
+			for (size_t i = 0; i < oOldCache.Size(); ++i)
 			{
-				if (iCurrent++ == iIndex)
-					return *pChild;
-				if (pChild->m_pNext == NULL)
-					break;
-				pChild = pChild->m_pNext;
+				if (oOldCache.Data()[i].m_pString != NULL)
+					*FindCachedString(oOldCache.Data()[i].m_iIndex) = oOldCache.Data()[i];
 			}
-			if (m_eType == E_TYPE_ARRAY)
-			{
-				do
-				{
-					JsonValue* pNewChild = m_pAllocator->CreateJsonValue(m_pAllocator, m_pAllocator->pUserData);
+		}
 
-					if (NULL != m_oValue.Childs.m_pLast)
-						m_oValue.Childs.m_pLast->m_pNext = pNewChild;
-					else
-						m_oValue.Childs.m_pFirst = pNewChild;
+		CachedString* pCached = FindCachedString(iIndex);
+		pCached->m_iIndex = iIndex;
+		pCached->m_pString = pUnescaped;
+		++m_iCached;
+		return pUnescaped;
+	}
 
-					m_oValue.Childs.m_pLast = pNewChild;
-				}
-				while (iCurrent++ != iIndex);
-				return *m_oValue.Childs.m_pLast;
-			}
-		}
-		return JsonValue::INVALID;
+	JsonLazyDoc::CachedString* JsonLazyDoc::FindCachedString(uint32_t iIndex) const
+	{
+		const size_t iMask = m_oCache.Size() - 1;
+		size_t iSlot = (iIndex * 2654435761u) & iMask;
+		CachedString* pSlots = m_oCache.Data();
+		while (pSlots[iSlot].m_pString != NULL && pSlots[iSlot].m_iIndex != iIndex)
+			iSlot = (iSlot + 1) & iMask;
+		return &pSlots[iSlot];
 	}
 
-	JsonValue& JsonValue::operator =(const JsonValue& oValue)
+	//////////////////////////////
+	// JsonSax
+	//////////////////////////////
+
+	JsonSax::JsonSax()
+		: m_pHandler(NULL)
+		, m_bStop(false)
 	{
-		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
-		if (this == &JsonStthm::JsonValue::INVALID)
-			return JsonValue::INVALID;
+		m_oStringAllocator.CreateJsonValue	= NULL;
+		m_oStringAllocator.DeleteJsonValue	= NULL;
+		m_oStringAllocator.AllocString		= &JsonSax::AllocString;
+		m_oStringAllocator.FreeString		= &JsonSax::FreeString;
+		m_oStringAllocator.pUserData		= this;
+		m_oStringAllocator.AllocMemory		= NULL;
+		m_oStringAllocator.FreeMemory		= NULL;
+	}
 
-		if (oValue.m_eType == E_TYPE_OBJECT)
+	int JsonSax::ReadString(const char* pJson, JsonSaxHandler& oHandler)
+	{
+		if (pJson != NULL)
 		{
-			InitType(E_TYPE_OBJECT);
+			m_pHandler = &oHandler;
+			m_bStop = false;
 
-			JsonValue* pSourceChild = oValue.m_oValue.Childs.m_pFirst;
-			while (pSourceChild != NULL)
+			const char* pEnd = pJson;
+			bool bResult = ParseValue(pEnd, 0);
+			m_pHandler = NULL;
+			if (bResult == false && m_bStop == false)
 			{
-				JsonValue* pNewChild = new JsonValue(*pSourceChild);
-
-				if (pSourceChild->m_pName != NULL)
-				{
-					size_t iNameLen = strlen(pSourceChild->m_pName) + 1;
-					char* pNewString = m_pAllocator->AllocString(iNameLen, m_pAllocator->pUserData);
-					memcpy(pNewString, pSourceChild->m_pName, iNameLen);
-					pNewChild->m_pName = pNewString;
-				}
-
-				if (NULL != m_oValue.Childs.m_pLast)
-					m_oValue.Childs.m_pLast->m_pNext = pNewChild;
-				else
-					m_oValue.Childs.m_pFirst = pNewChild;
-
-				m_oValue.Childs.m_pLast = pNewChild;
-
-				pSourceChild = pSourceChild->m_pNext;
+				return Internal::CountLines(pJson, pEnd);
 			}
+			return 0;
 		}
-		else if (oValue.m_eType == E_TYPE_ARRAY)
-		{
-			InitType(E_TYPE_ARRAY);
-
-			JsonValue* pSourceChild = oValue.m_oValue.Childs.m_pFirst;
-			while (pSourceChild != NULL)
-			{
-				JsonValue* pNewChild = new JsonValue(*pSourceChild);
+		return -1;
+	}
 
-				if (NULL != m_oValue.Childs.m_pLast)
-					m_oValue.Childs.m_pLast->m_pNext = pNewChild;
-				else
-					m_oValue.Childs.m_pFirst = pNewChild;
+	int JsonSax::ReadFile(const char* pFilename, JsonSaxHandler& oHandler, int iFlags)
+	{
+		Internal::FileContent oContent;
+		int iResult = oContent.Load(pFilename, (iFlags & JsonValue::E_READ_NO_FILE_MAPPING) == 0);
+		if (iResult != 0)
+			return iResult;
 
-				m_oValue.Childs.m_pLast = pNewChild;
+		return ReadString(oContent.Data(), oHandler);
+	}
 
-				pSourceChild = pSourceChild->m_pNext;
-			}
+	bool JsonSax::Continue(JsonSaxHandler::EAction eAction)
+	{
+		if (eAction == JsonSaxHandler::E_ACTION_STOP)
+		{
+			m_bStop = true;
+			return false;
 		}
-		else if (oValue.m_eType == E_TYPE_BOOLEAN)
+		return true;
+	}
+
+	const char* JsonSax::ReadStringValue(const char*& pString, size_t& iLength)
+	{
+		// Unescaped in the reused string buffer
+		m_oString.Clear();
+		const char* pValue = JsonValue::ReadStringValue(pString, &m_oStringAllocator, false);
+		if (pValue != NULL)
+			iLength = strlen(pValue);
+		return pValue;
+	}
+
+	bool JsonSax::ParseValue(const char*& pString, int iDepth)
+	{
+		Internal::SkipSpaces(pString);
+		switch (*pString)
 		{
-			*this = oValue.ToBoolean();
+		case 0:
+			return true;
+		case '"':
+		{
+			size_t iLength;
+			const char* pValue = ReadStringValue(++pString, iLength);
+			if (pValue == NULL)
+				return false;
+			return Continue(m_pHandler->String(pValue, iLength));
 		}
-		else if (oValue.m_eType == E_TYPE_STRING)
+		case '{':
 		{
-			*this = oValue.ToString();
+			if (iDepth >= STTHM_MAX_DEPTH)
+				return false;
+			JsonSaxHandler::EAction eAction = m_pHandler->StartObject();
+			if (eAction == JsonSaxHandler::E_ACTION_SKIP)
+				return Internal::SkipValue(pString);
+			if (Continue(eAction) == false)
+				return false;
+			++pString;
+			return ParseObject(pString, iDepth + 1);
 		}
-		else if (oValue.m_eType == E_TYPE_INTEGER)
+		case '[':
 		{
-			*this = oValue.ToInteger();
+			if (iDepth >= STTHM_MAX_DEPTH)
+				return false;
+			JsonSaxHandler::EAction eAction = m_pHandler->StartArray();
+			if (eAction == JsonSaxHandler::E_ACTION_SKIP)
+				return Internal::SkipValue(pString);
+			if (Continue(eAction) == false)
+				return false;
+			++pString;
+			return ParseArray(pString, iDepth + 1);
 		}
-		else if (oValue.m_eType == E_TYPE_FLOAT)
+		default:
 		{
-			*this = oValue.ToFloat();
+			Internal::Scalar oScalar;
+			if (Internal::ReadScalar(pString, oScalar))
+				return Continue(Internal::SendScalar(oScalar, *m_pHandler));
+			break;
 		}
-		return *this;
+		}
+
+		// Error
+		return false;
 	}
 
-#ifdef JsonStthmString
-	JsonValue& JsonValue::operator =(const JsonStthmString& sValue)
+	bool JsonSax::ParseObject(const char*& pString, int iDepth)
 	{
-		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
-		if (this == &JsonStthm::JsonValue::INVALID)
-			return JsonValue::INVALID;
+		Internal::SkipSpaces(pString);
+		if (*pString != '}')
+		{
+			for (;;)
+			{
+				Internal::SkipSpaces(pString);
 
-		InitType(E_TYPE_STRING);
-		SetStringValue(sValue.c_str());
+				// Read member name
+				if (*pString != '"')
+					return false;
 
-		return *this;
+				size_t iLength;
+				const char* pName = ReadStringValue(++pString, iLength);
+				if (pName == NULL)
+					return false;
+
+				JsonSaxHandler::EAction eAction = m_pHandler->Key(pName, iLength);
+				if (Continue(eAction) == false)
+					return false;
+
+				Internal::SkipSpaces(pString);
+				if (*pString != ':')
+					return false;
+				++pString;
+
+				Internal::SkipSpaces(pString);
+				if (*pString == 0)
+					return false;
+
+				if (eAction == JsonSaxHandler::E_ACTION_SKIP)
+				{
+					if (Internal::SkipValue(pString) == false)
+						return false;
+				}
+				else if (ParseValue(pString, iDepth) == false)
+				{
+					return false;
+				}
+
+				Internal::SkipSpaces(pString);
+				if (*pString == '}')
+					break;
+				else if (*pString != ',')
+					return false;
+				++pString;
+			}
+		}
+		++pString;
+		return Continue(m_pHandler->EndObject());
 	}
-#endif //JsonStthmString
 
-	JsonValue& JsonValue::operator =(const char* pValue)
+	bool JsonSax::ParseArray(const char*& pString, int iDepth)
 	{
-		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
-		if (this == &JsonStthm::JsonValue::INVALID)
-			return JsonValue::INVALID;
+		Internal::SkipSpaces(pString);
+		if (*pString != ']')
+		{
+			for (;;)
+			{
+				Internal::SkipSpaces(pString);
+				if (*pString == 0 || ParseValue(pString, iDepth) == false)
+					return false;
 
-		SetString(pValue);
-		return *this;
+				Internal::SkipSpaces(pString);
+				if (*pString == ']')
+					break;
+				else if (*pString != ',')
+					return false;
+				++pString;
+			}
+		}
+		++pString;
+		return Continue(m_pHandler->EndArray());
 	}
 
-	JsonValue& JsonValue::operator =(bool bValue)
+	char* JsonSax::AllocString(size_t iSize, void* pUserData)
 	{
-		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
-		if (this == &JsonStthm::JsonValue::INVALID)
-			return JsonValue::INVALID;
+		Internal::CharBuffer& oString = ((JsonSax*)pUserData)->m_oString;
+		oString.Resize(iSize);
+		return oString.Data();
+	}
 
-		SetBoolean(bValue);
-		return *this;
+	void JsonSax::FreeString(char* /*pString*/, void* /*pUserData*/)
+	{
+		// Do nothing, buffer is reused
 	}
 
-	JsonValue& JsonValue::operator =(int64_t iValue)
+	//////////////////////////////
+	// JsonPushReader
+	//////////////////////////////
+
+	JsonPushReader::JsonPushReader(JsonSaxHandler& oHandler)
+		: m_pHandler(&oHandler)
 	{
-		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
-		if (this == &JsonStthm::JsonValue::INVALID)
-			return JsonValue::INVALID;
+		Reset();
+	}
 
-		SetInteger(iValue);
-		return *this;
+	void JsonPushReader::Reset()
+	{
+		m_eState = E_STATE_VALUE;
+		m_eToken = E_TOKEN_NONE;
+		m_bEscaped = false;
+		m_bStarted = false;
+		m_bStopped = false;
+		m_bSkipValue = false;
+		m_iSkipDepth = 0;
+		m_iLine = 1;
+		m_oToken.Clear();
+		m_oStack.Clear();
 	}
 
-	JsonValue& JsonValue::operator =(double fValue)
+	int JsonPushReader::Feed(const char* pData, size_t iLength)
 	{
-		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
-		if (this == &JsonStthm::JsonValue::INVALID)
-			return JsonValue::INVALID;
+		if (m_eState == E_STATE_ERROR)
+			return m_iLine;
 
-		SetFloat(fValue);
-		return *this;
+		const char* pEnd = pData + iLength;
+		while (pData != pEnd && m_bStopped == false)
+		{
+			if (m_eToken == E_TOKEN_STRING || m_eToken == E_TOKEN_KEY)
+			{
+				// Accumulate raw string up to its closing quote, unescaped once complete
+				const char* pStart = pData;
+				bool bClosed = false;
+				while (pData != pEnd)
+				{
+					char cChar = *pData++;
+					if (m_bEscaped)
+						m_bEscaped = false;
+					else if (cChar == '\\')
+						m_bEscaped = true;
+					else if (cChar == '"')
+					{
+						bClosed = true;
+						break;
+					}
+					else if (cChar == '\n')
+						++m_iLine;
+				}
+				m_oToken.PushRange(pStart, pData - pStart);
+				if (bClosed && EndString() == false)
+					break;
+				continue;
+			}
+			else if (m_eToken == E_TOKEN_SCALAR)
+			{
+				const char* pStart = pData;
+				while (pData != pEnd && Internal::IsScalarChar(*pData))
+					++pData;
+				m_oToken.PushRange(pStart, pData - pStart);
+				if (pData != pEnd && EndScalar() == false)
+					break;
+				continue;
+			}
+
+			char cChar = *pData++;
+			if (Internal::IsSpace(cChar))
+			{
+				if (cChar == '\n')
+					++m_iLine;
+				continue;
+			}
+
+			bool bContinue;
+			switch (m_eState)
+			{
+			case E_STATE_VALUE:
+				bContinue = StartValue(cChar);
+				break;
+			case E_STATE_FIRST_VALUE:
+				bContinue = (cChar == ']') ? EndContainer('[') : StartValue(cChar);
+				break;
+			case E_STATE_FIRST_KEY:
+				if (cChar == '}')
+				{
+					bContinue = EndContainer('{');
+					break;
+				}
+				// Fall through
+			case E_STATE_KEY:
+				if (cChar == '"')
+				{
+					m_eToken = E_TOKEN_KEY;
+					m_oToken.Clear();
+					bContinue = true;
+				}
+				else
+				{
+					bContinue = Fail();
+				}
+				break;
+			case E_STATE_COLON:
+				m_eState = E_STATE_VALUE;
+				bContinue = (cChar == ':') || Fail();
+				break;
+			case E_STATE_OBJECT_NEXT:
+				if (cChar == ',')
+				{
+					m_eState = E_STATE_KEY;
+					bContinue = true;
+				}
+				else
+				{
+					bContinue = (cChar == '}') ? EndContainer('{') : Fail();
+				}
+				break;
+			case E_STATE_ARRAY_NEXT:
+				if (cChar == ',')
+				{
+					m_eState = E_STATE_VALUE;
+					bContinue = true;
+				}
+				else
+				{
+					bContinue = (cChar == ']') ? EndContainer('[') : Fail();
+				}
+				break;
+			default:
+				// Garbage after the document
+				bContinue = Fail();
+				break;
+			}
+
+			if (bContinue == false)
+				break;
+		}
+
+		return m_eState == E_STATE_ERROR ? m_iLine : 0;
+	}
+
+	int JsonPushReader::Finish()
+	{
+		if (m_eState == E_STATE_ERROR)
+			return m_iLine;
+
+		if (m_bStopped == false && m_eToken == E_TOKEN_SCALAR)
+			EndScalar();
+
+		if (m_eState == E_STATE_ERROR)
+			return m_iLine;
+
+		if (m_bStopped || m_eState == E_STATE_DONE || m_bStarted == false)
+			return 0;
+
+		// Incomplete document
+		Fail();
+		return m_iLine;
 	}
 
-	JsonValue& JsonValue::operator +=(const JsonValue& oValue)
+	bool JsonPushReader::Fail()
 	{
-		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
-		if (this == &JsonStthm::JsonValue::INVALID)
-			return JsonValue::INVALID;
-
-		if (m_eType == E_TYPE_ARRAY)
-		{
-			JsonValue* pNewValue = new JsonValue(oValue);
-
-			if (NULL != m_oValue.Childs.m_pLast)
-				m_oValue.Childs.m_pLast->m_pNext = pNewValue;
-			else
-				m_oValue.Childs.m_pFirst = pNewValue;
+		m_eState = E_STATE_ERROR;
+		return false;
+	}
 
-			m_oValue.Childs.m_pLast = pNewValue;
-		}
-		else if (m_eType == E_TYPE_STRING)
+	bool JsonPushReader::Send(JsonSaxHandler::EAction eAction)
+	{
+		if (eAction == JsonSaxHandler::E_ACTION_STOP)
 		{
-			if (oValue.IsString())
-			{
-				Internal::CharBuffer oNewStr;
-				const char* pAddString = oValue.ToString();
-				size_t iLen1 = strlen(m_oValue.String);
-				size_t iLen2 = strlen(pAddString);
-				oNewStr.Reserve(iLen1 + iLen2 + 1);
-				oNewStr.PushRange(m_oValue.String, iLen1);
-				oNewStr.PushRange(pAddString, iLen2);
-				oNewStr.Push(0);
-				SetStringValue(oNewStr.Data());
-			}
+			m_bStopped = true;
+			return false;
 		}
-		return *this;
+		return true;
 	}
 
-	bool JsonValue::Parse(const char*& pString)
+	bool JsonPushReader::StartValue(char cChar)
 	{
-		JsonStthmAssert(this != &JsonStthm::JsonValue::INVALID);
-		if (this == &JsonStthm::JsonValue::INVALID || pString == NULL)
-			return false;
-
-		Internal::SkipSpaces(pString);
-		if (*pString == 0)
+		m_bStarted = true;
+		if (cChar == '"')
 		{
+			m_eToken = E_TOKEN_STRING;
+			m_oToken.Clear();
 			return true;
 		}
-		else if (*pString == '"')
+		else if (cChar == '{' || cChar == '[')
 		{
-			char* pValue = ReadStringValue(++pString, m_pAllocator);
-			if (pValue == NULL)
+			m_oStack.Push(cChar);
+			m_eState = (cChar == '{') ? E_STATE_FIRST_KEY : E_STATE_FIRST_VALUE;
+			if (m_iSkipDepth != 0)
+				return true;
+
+			if (m_bSkipValue)
 			{
-				return false;
+				m_bSkipValue = false;
+				m_iSkipDepth = m_oStack.Size();
+				return true;
 			}
 
-			InitType(E_TYPE_STRING);
-			m_oValue.String = pValue;
-			return true;
+			JsonSaxHandler::EAction eAction = (cChar == '{') ? m_pHandler->StartObject() : m_pHandler->StartArray();
+			if (eAction == JsonSaxHandler::E_ACTION_SKIP)
+				m_iSkipDepth = m_oStack.Size();
+			return Send(eAction);
 		}
-		else if (memcmp(pString, "NaN", 3) == 0)
+		else if (Internal::IsScalarChar(cChar))
 		{
-			pString += 3;
-			InitType(E_TYPE_FLOAT);
-			m_oValue.Float = Internal::c_fNaN;
+			m_eToken = E_TOKEN_SCALAR;
+			m_oToken.Clear();
+			m_oToken.Push(cChar);
 			return true;
 		}
-		else if (memcmp(pString, "-Infinity", 9) == 0)
+		return Fail();
+	}
+
+	bool JsonPushReader::EndValue()
+	{
+		if (m_oStack.Size() == 0)
+			m_eState = E_STATE_DONE;
+		else if (m_oStack.Data()[m_oStack.Size() - 1] == '{')
+			m_eState = E_STATE_OBJECT_NEXT;
+		else
+			m_eState = E_STATE_ARRAY_NEXT;
+
+		// Value skipped by a container or a key
+		if (m_iSkipDepth != 0)
+			return false;
+		if (m_bSkipValue)
 		{
-			pString += 9;
-			InitType(E_TYPE_FLOAT);
-			m_oValue.Float = -Internal::c_fInfinity;
-			return true;
+			m_bSkipValue = false;
+			return false;
 		}
-		else if (memcmp(pString, "Infinity", 8) == 0)
+		return true;
+	}
+
+	bool JsonPushReader::EndContainer(char cOpen)
+	{
+		size_t iDepth = m_oStack.Size();
+		m_oStack.Resize(iDepth - 1);
+		if (m_iSkipDepth != 0)
 		{
-			pString += 8;
-			InitType(E_TYPE_FLOAT);
-			m_oValue.Float = Internal::c_fInfinity;
+			if (iDepth == m_iSkipDepth)
+				m_iSkipDepth = 0;
+			EndValue();
 			return true;
 		}
-		else if (Internal::IsDigit(*pString) || *pString == '-')
-		{
-			return ReadNumericValue(pString, *this);
-		}
-		else if (memcmp(pString, "true", 4) == 0)
+
+		EndValue();
+		return Send((cOpen == '{') ? m_pHandler->EndObject() : m_pHandler->EndArray());
+	}
+
+	bool JsonPushReader::EndString()
+	{
+		EToken eToken = m_eToken;
+		m_eToken = E_TOKEN_NONE;
+
+		// Token ends with the closing quote, unescape it in place
+		m_oToken.Push(0);
+		const char* pCursor = m_oToken.Data();
+		char* pValue = JsonValue::ReadStringValue(pCursor, NULL, true);
+		if (pValue == NULL)
+			return Fail();
+
+		if (eToken == E_TOKEN_KEY)
 		{
-			pString += 4;
-			InitType(E_TYPE_BOOLEAN);
-			m_oValue.Boolean = true;
-			return true;
+			m_eState = E_STATE_COLON;
+			if (m_iSkipDepth != 0)
+				return true;
+
+			JsonSaxHandler::EAction eAction = m_pHandler->Key(pValue, strlen(pValue));
+			if (eAction == JsonSaxHandler::E_ACTION_SKIP)
+				m_bSkipValue = true;
+			return Send(eAction);
 		}
-		else if (memcmp(pString, "false", 5) == 0)
-		{
-			pString += 5;
-			InitType(E_TYPE_BOOLEAN);
-			m_oValue.Boolean = false;
+
+		if (EndValue() == false)
 			return true;
-		}
-		else if (memcmp(pString, "null", 4) == 0)
-		{
-			pString += 4;
-			InitType(E_TYPE_NULL);
+		return Send(m_pHandler->String(pValue, strlen(pValue)));
+	}
+
+	bool JsonPushReader::EndScalar()
+	{
+		m_eToken = E_TOKEN_NONE;
+
+		m_oToken.Push(0);
+		const char* pCursor = m_oToken.Data();
+		Internal::Scalar oScalar;
+		if (Internal::ReadScalar(pCursor, oScalar) == false || *pCursor != 0)
+			return Fail();
+
+		if (EndValue() == false)
 			return true;
-		}
-		else if (*pString == '{')
-		{
-			++pString;
-			return ReadObjectValue(pString, *this);
-		}
-		else if (*pString == '[')
+		return Send(Internal::SendScalar(oScalar, *m_pHandler));
+	}
+
+	//////////////////////////////
+	// JsonLinesReader
+	//////////////////////////////
+
+	struct JsonLinesReader::Job
+	{
+		const char*					m_pJson;
+		const char*					m_pEnd;
+		size_t						m_iBatchSize;
+		size_t						m_iBatchCount;
+		ValueCallback				m_pCallback;
+		void*						m_pUserData;
+		bool						m_bOrdered;
+
+		std::atomic<size_t>			m_iNextBatch;
+		std::atomic<bool>			m_bStop;
+
+		std::mutex					m_oMutex;
+		std::condition_variable		m_oDelivered;
+		size_t						m_iNextDelivery;	// Ordered mode only
+		size_t						m_iErrorBatch;		// Batches after the first invalid line are not parsed or delivered
+		const char*					m_pErrorLine;
+
+		// Batches start after the first line end following their nominal offset, so a line is never split
+		const char* GetBatchStart(size_t iBatch) const
 		{
-			++pString;
-			return ReadArrayValue(pString, *this);
+			if (iBatch == 0)
+				return m_pJson;
+			if (iBatch >= m_iBatchCount)
+				return m_pEnd;
+			const char* pStart = m_pJson + iBatch * m_iBatchSize;
+			const char* pLineEnd = (const char*)memchr(pStart, '\n', m_pEnd - pStart);
+			return (pLineEnd != NULL) ? pLineEnd + 1 : m_pEnd;
 		}
+	};
 
-		// Error
-		return false;
+	JsonLinesReader::JsonLinesReader(int iThreadCount, size_t iBatchSize)
+		: m_iThreadCount(iThreadCount)
+		, m_iBatchSize(iBatchSize > 0 ? iBatchSize : 1)
+	{
 	}
 
-	// Static functions
-
-	int JsonValue::ReadSpecialChar(const char*& pString, char* pOut)
+	int JsonLinesReader::ReadString(const char* pJson, ValueCallback pCallback, void* pUserData, bool bOrdered)
 	{
-		if (*pString == 'n')		{ pOut[0] = '\n';	return 1; }
-		else if (*pString == 'r')	{ pOut[0] = '\r';	return 1; }
-		else if (*pString == 't')	{ pOut[0] = '\t';	return 1; }
-		else if (*pString == 'b')	{ pOut[0] = '\b';	return 1; }
-		else if (*pString == 'f')	{ pOut[0] = '\f';	return 1; }
-		else if (*pString == '"')	{ pOut[0] = '"';	return 1; }
-		else if (*pString == '\\')	{ pOut[0] = '\\';	return 1; }
-		else if (*pString == '/')	{ pOut[0] = '/';	return 1; }
-		else if (*pString == 'u')
+		if (pJson != NULL && pCallback != NULL)
 		{
-			uint32_t iChar = 0;
-			for (int i = 0; i < 4; ++i)
-			{
-				uint8_t iXDigit = Internal::XDigitToUInt8(*++pString);
-				if (iXDigit != 255)
-					iChar = iChar * 16 + iXDigit;
-				else
-					return 0;
-			}
+			return Read(pJson, strlen(pJson), pCallback, pUserData, bOrdered);
+		}
+		return -1;
+	}
 
-			if (iChar >= 0xD800 && iChar <= 0xDFFF) // UTF16 Surrogate pair
-			{
-				if ((iChar & 0xFC00) != 0xD800)
-					return 0; //Invalid first pair code
+	int JsonLinesReader::ReadFile(const char* pFilename, ValueCallback pCallback, void* pUserData, bool bOrdered, int iFlags)
+	{
+		if (pCallback == NULL)
+			return -1;
 
-				if (*++pString != '\\' || *++pString != 'u')
-					return 0; //Not a valid pair
+		Internal::FileContent oContent;
+		int iResult = oContent.Load(pFilename, (iFlags & JsonValue::E_READ_NO_FILE_MAPPING) == 0);
+		if (iResult != 0)
+			return iResult;
 
-				uint32_t iChar2 = 0;
-				for (int i = 0; i < 4; ++i)
-				{
-					uint8_t iXDigit = Internal::XDigitToUInt8(*++pString);
-					if (iXDigit != 255)
-						iChar2 = iChar2 * 16 + iXDigit;
-					else
-						return 0;
-				}
+		return Read(oContent.Data(), oContent.Size(), pCallback, pUserData, bOrdered);
+	}
 
-				if ((iChar2 & 0xFC00) != 0xDC00)
-					return 0; //Invalid second pair code
+	int JsonLinesReader::Read(const char* pJson, size_t iLength, ValueCallback pCallback, void* pUserData, bool bOrdered)
+	{
+		Job oJob;
+		oJob.m_pJson = pJson;
+		oJob.m_pEnd = pJson + iLength;
+		oJob.m_iBatchSize = m_iBatchSize;
+		oJob.m_iBatchCount = (iLength + m_iBatchSize - 1) / m_iBatchSize;
+		oJob.m_pCallback = pCallback;
+		oJob.m_pUserData = pUserData;
+		oJob.m_bOrdered = bOrdered;
+		oJob.m_iNextBatch = 0;
+		oJob.m_bStop = false;
+		oJob.m_iNextDelivery = 0;
+		oJob.m_iErrorBatch = (size_t)-1;
+		oJob.m_pErrorLine = NULL;
+
+		size_t iThreadCount = (m_iThreadCount > 0) ? (size_t)m_iThreadCount : (size_t)std::thread::hardware_concurrency();
+		if (iThreadCount > oJob.m_iBatchCount)
+			iThreadCount = oJob.m_iBatchCount;
+
+		// Current thread is one of the workers
+		std::thread* pThreads = NULL;
+		if (iThreadCount > 1)
+		{
+			pThreads = new std::thread[iThreadCount - 1];
+			for (size_t i = 0; i < iThreadCount - 1; ++i)
+				pThreads[i] = std::thread(&JsonLinesReader::RunWorker, &oJob);
+		}
 
-				iChar = 0x10000 + (((iChar & 0x3FF) << 10) | (iChar2 & 0x3FF));
-			}
+		RunWorker(&oJob);
 
-			if (iChar < 0x80)
-			{
-				pOut[0] = (char)iChar;
-				return 1;
-			}
-			if (iChar >= 0x80 && iChar <= 0x7FF)
-			{
-				pOut[0] = (char)(0xC0 | ((iChar >> 6)));
-				pOut[1] = (char)(0x80 | ((iChar >> 0) & 0x3F));
-				return 2;
-			}
-			if (iChar >= 0x800 && iChar <= 0xFFFF)
-			{
-				pOut[0] = (char)(0xE0 | ((iChar >> 12)));
-				pOut[1] = (char)(0x80 | ((iChar >> 6) & 0x3F));
-				pOut[2] = (char)(0x80 | ((iChar >> 0) & 0x3F));
-				return 3;
-			}
-			if (iChar >= 0x10000 && iChar <= 0x10FFFF)
+		if (pThreads != NULL)
+		{
+			for (size_t i = 0; i < iThreadCount - 1; ++i)
+				pThreads[i].join();
+			delete[] pThreads;
+		}
+
+		if (oJob.m_pErrorLine != NULL)
+		{
+			int iLine = 1;
+			const char* pCursor = pJson;
+			while ((pCursor = (const char*)memchr(pCursor, '\n', oJob.m_pErrorLine - pCursor)) != NULL)
 			{
-				pOut[0] = (char)(0xF0 | ((iChar >> 18)));
-				pOut[1] = (char)(0x80 | ((iChar >> 12) & 0x3F));
-				pOut[2] = (char)(0x80 | ((iChar >> 6) & 0x3F));
-				pOut[3] = (char)(0x80 | ((iChar >> 0) & 0x3F));
-				return 4;
+				++pCursor;
+				++iLine;
 			}
+			return iLine;
 		}
-
 		return 0;
 	}
 
-	char* JsonValue::ReadStringValue(const char*& pString, Allocator* pAllocator)
+	void JsonLinesReader::RunWorker(Job* pJob)
 	{
-		size_t iLen = 0;
-		// Read string length
+		JsonDoc oDoc;
+		oDoc.SetRetainMode(JsonDoc::E_RETAIN_LARGEST_BLOCK);
+		for (;;)
 		{
-			char pTemp[4];
-			const char* pCursor = pString;
-			while (*pCursor != 0)
+			size_t iBatch = pJob->m_iNextBatch++;
+			if (iBatch >= pJob->m_iBatchCount)
+				break;
+
+			bool bParsed = false;
+			if (pJob->m_bStop == false)
 			{
-				if (*pCursor == '\\')
+				bool bSkip;
 				{
-					int iCharLen = ReadSpecialChar(++pCursor, pTemp);
-					if (iCharLen == 0)
-						return NULL;
-					iLen += iCharLen;
-					++pCursor;
-					continue;
+					std::lock_guard<std::mutex> oLock(pJob->m_oMutex);
+					bSkip = iBatch > pJob->m_iErrorBatch;
 				}
-				else if (*pCursor == '"')
+
+				const char* pErrorLine = NULL;
+				if (bSkip == false)
 				{
-					++pCursor;
-					break;
+					bParsed = true;
+					if (ParseBatch(oDoc, pJob->GetBatchStart(iBatch), pJob->GetBatchStart(iBatch + 1), pErrorLine) == false)
+					{
+						std::lock_guard<std::mutex> oLock(pJob->m_oMutex);
+						if (iBatch < pJob->m_iErrorBatch)
+						{
+							pJob->m_iErrorBatch = iBatch;
+							pJob->m_pErrorLine = pErrorLine;
+						}
+					}
 				}
-
-				++iLen;
-				++pCursor;
 			}
-		}
 
-		// Alloc string
-		char* pNewString = pAllocator->AllocString(iLen + 1, pAllocator->pUserData);
-		pNewString[iLen] = '\0';
-		char* pNewStringCursor = pNewString;
+			{
+				// Ordered: wait for previous batches to be delivered, they are all parsed by then so
+				// the first error is known. Unordered: an earlier batch may still be parsing.
+				std::unique_lock<std::mutex> oLock(pJob->m_oMutex);
+				while (pJob->m_bOrdered && pJob->m_iNextDelivery != iBatch)
+					pJob->m_oDelivered.wait(oLock);
+				if (iBatch > pJob->m_iErrorBatch)
+					bParsed = false;
+			}
 
-		// Read string
-		{
-			while (*pString != 0)
+			if (bParsed && pJob->m_bStop == false)
 			{
-				if (*pString == '\\')
+				for (JsonValue::Iterator oIt(&oDoc.m_oRoot); oIt.IsValid(); ++oIt)
 				{
-					int iCharLen = ReadSpecialChar(++pString, pNewStringCursor);
-					if (iCharLen == 0)
-						return NULL;
-					pNewStringCursor += iCharLen;
-					++pString;
-					continue;
-				}
-				else if (*pString == '"')
-				{
-					++pString;
-					return pNewString;
+					if (pJob->m_pCallback(*oIt, pJob->m_pUserData) == false)
+					{
+						pJob->m_bStop = true;
+						break;
+					}
 				}
+			}
 
-				*pNewStringCursor = *pString;
-				++pNewStringCursor;
-				++pString;
+			if (pJob->m_bOrdered)
+			{
+				std::lock_guard<std::mutex> oLock(pJob->m_oMutex);
+				++pJob->m_iNextDelivery;
+				pJob->m_oDelivered.notify_all();
 			}
 		}
-		return NULL;
 	}
 
-	bool JsonValue::ReadNumericValue(const char*& pString, JsonValue& oValue)
+	bool JsonLinesReader::ParseBatch(JsonDoc& oDoc, const char* pBegin, const char* pEnd, const char*& pErrorLine)
 	{
-	#ifdef STTHM_USE_CUSTOM_NUMERIC_PARSER
-		static double const c_pExpTable[] = {
-			1e5, 1e4, 1e3, 1e2, 10, 1,
-			0.1, 1e-2, 1e-3, 1e-4, 1e-5, 1e-6,
-			1e-7, 1e-8, 1e-9, 1e-10, 1e-11, 1e-12,
-			1e-13, 1e-14, 1e-15, 1e-16, 1e-17
-		};
-		static double const* c_pExpLookup = &c_pExpTable[5];
-
-		bool bNeg = false;
-		if (*pString == '-')
-		{
-			++pString;
-			bNeg = true;
-		}
-
-		uint64_t lValue = 0;
-		int iNegFract = 0;
-
-		while (Internal::IsDigit(*pString))
-			lValue = lValue * 10 + (*pString++ & 0xF);
-
-		if (*pString == '.')
+		// All values of the batch are childs of the root, arena is reused across batches
+		oDoc.Clear();
+		JsonValue& oRoot = oDoc.m_oRoot;
+		oRoot.InitType(JsonValue::E_TYPE_ARRAY);
+		Allocator* pAllocator = &oDoc.m_oAllocator;
+
+		const char* pLine = pBegin;
+		while (pLine < pEnd)
 		{
-			const char* pStart = ++pString;
-
-			while (Internal::IsDigit(*pString))
-				lValue = lValue * 10 + (*pString++ & 0xF);
-
-			iNegFract = (int)(pString - pStart);
+			const char* pLineEnd = (const char*)memchr(pLine, '\n', pEnd - pLine);
+			if (pLineEnd == NULL)
+				pLineEnd = pEnd;
 
-			if (*pString == 'e' || *pString == 'E')
-			{
+			const char* pString = pLine;
+			while (pString != pLineEnd && Internal::IsSpace(*pString))
 				++pString;
 
-				bool bNegExp = false;
-				if (*pString == '+')
-				{
+			// Empty lines are ignored
+			if (pString != pLineEnd)
+			{
+				JsonValue* pValue = pAllocator->CreateJsonValue(pAllocator, pAllocator->pUserData);
+				bool bValid = pValue->Parse(pString, false) && pString <= pLineEnd;
+				while (bValid && pString != pLineEnd && Internal::IsSpace(*pString))
 					++pString;
-				}
-				else if (*pString == '-')
+
+				if (bValid == false || pString != pLineEnd)
 				{
-					++pString;
-					bNegExp = true;
+					pErrorLine = pLine;
+					return false;
 				}
-
-				uint64_t iExpValue = 0;
-				while (Internal::IsDigit(*pString))
-					iExpValue = iExpValue * 10 + (*pString++ & 0xF);
-
-				iNegFract += bNegExp ? (int)iExpValue : -(int)iExpValue;
+				oRoot.AppendChild(pValue);
 			}
-			oValue = (bNeg ? -1.0 : 1.0) * lValue * c_pExpLookup[iNegFract];
-		}
-		else
-		{
-			//TODO manage E/e for long?
-			oValue = (int64_t)(bNeg ? -lValue : lValue);
-		}
-		return true;
-	#else //STTHM_USE_CUSTOM_NUMERIC_PARSER
-		char* pEndDouble;
-		char* pEndLong;
-		double fValue = strtod( pString, &pEndDouble );
-		int64_t iValue = Internal::StrToInt64( pString, &pEndLong );
-		if( pEndDouble > pEndLong )
-		{
-			pString = pEndDouble;
-			oValue.InitType(E_TYPE_FLOAT);
-			oValue.m_oValue.Float = fValue;
-		}
-		else
-		{
-			pString = pEndLong;
-			oValue.InitType(E_TYPE_INTEGER);
-			oValue.m_oValue.Integer= iValue;
+			pLine = pLineEnd + 1;
 		}
-
 		return true;
-	#endif // !STTHM_USE_CUSTOM_NUMERIC_PARSER
 	}
 
-	bool JsonValue::ReadObjectValue(const char*& pString, JsonValue& oValue)
-	{
-		oValue.InitType(JsonValue::E_TYPE_OBJECT);
-
-		Internal::SkipSpaces(pString);
-
-		if( *pString == '}' )
-		{
-			++pString;
-			return true;
-		}
-
-		while (*pString != 0)
-		{
-			Internal::SkipSpaces(pString);
-
-			// Read member name
-			if (*pString != '"')
-				return false;
-
-			char* pName = ReadStringValue(++pString, oValue.m_pAllocator);
-			if (pName == NULL)
-				return false;
+	//////////////////////////////
+	// JsonTextReader
+	//////////////////////////////
 
-			JsonValue* pNewMember = oValue.m_pAllocator->CreateJsonValue(oValue.m_pAllocator, oValue.m_pAllocator->pUserData);
-			pNewMember->m_pName = pName;
+	JsonTextReader::JsonTextReader(const char* pJson)
+		: m_pJson(pJson)
+		, m_pCursor(pJson)
+		, m_bFirst(false)
+		, m_bFailed(pJson == NULL)
+	{
+		m_oStringAllocator.CreateJsonValue	= NULL;
+		m_oStringAllocator.DeleteJsonValue	= NULL;
+		m_oStringAllocator.AllocString		= &JsonTextReader::AllocString;
+		m_oStringAllocator.FreeString		= &JsonTextReader::FreeString;
+		m_oStringAllocator.pUserData		= this;
+		m_oStringAllocator.AllocMemory		= NULL;
+		m_oStringAllocator.FreeMemory		= NULL;
+	}
 
-			Internal::SkipSpaces(pString);
+	int JsonTextReader::GetErrorLine() const
+	{
+		if (m_pJson == NULL)
+			return -1;
+		return m_bFailed ? Internal::CountLines(m_pJson, m_pCursor) : 0;
+	}
 
-			if (*pString != ':')
-				return false;
+	bool JsonTextReader::IsNull()
+	{
+		if (m_bFailed)
+			return false;
+		Internal::SkipSpaces(m_pCursor);
+		return Internal::MatchLiteral(m_pCursor, "null", 4);
+	}
 
-			++pString;
+	bool JsonTextReader::ReadBoolean(bool& bValue)
+	{
+		if (m_bFailed)
+			return false;
+		Internal::SkipSpaces(m_pCursor);
+		if (Internal::MatchLiteral(m_pCursor, "true", 4))
+			bValue = true;
+		else if (Internal::MatchLiteral(m_pCursor, "false", 5))
+			bValue = false;
+		else
+			return Fail();
+		return true;
+	}
 
-			Internal::SkipSpaces(pString);
+	bool JsonTextReader::ReadInteger(int64_t& iValue, int64_t iMin, int64_t iMax)
+	{
+		if (m_bFailed)
+			return false;
+		Internal::SkipSpaces(m_pCursor);
+		Internal::Scalar oScalar;
+		if (Internal::ReadScalar(m_pCursor, oScalar) == false)
+			return Fail();
+
+		int64_t iRead;
+		if (oScalar.eType == JsonValue::E_TYPE_INTEGER)
+			iRead = oScalar.iInteger;
+		// -2^63 <= value < 2^63, also false for NaN
+		else if (oScalar.eType == JsonValue::E_TYPE_FLOAT && oScalar.fFloat >= -9223372036854775808.0 && oScalar.fFloat < 9223372036854775808.0)
+			iRead = (int64_t)oScalar.fFloat;
+		else
+			return Fail();
 
-			if (pNewMember->Parse(pString) == false)
-			{
-				oValue.m_pAllocator->DeleteJsonValue(pNewMember, oValue.m_pAllocator->pUserData);
-				return false;
-			}
+		// Floats are accepted without a fractional part only, like 2.0 or 1e2
+		if (oScalar.eType == JsonValue::E_TYPE_FLOAT && (double)iRead != oScalar.fFloat)
+			return Fail();
 
-			if (oValue.m_oValue.Childs.m_pFirst == NULL)
-			{
-				oValue.m_oValue.Childs.m_pFirst = pNewMember;
-			}
-			else
-			{
-				oValue.m_oValue.Childs.m_pLast->m_pNext = pNewMember;
-			}
-			oValue.m_oValue.Childs.m_pLast = pNewMember;
+		if (iRead < iMin || iRead > iMax)
+			return Fail();
+		iValue = iRead;
+		return true;
+	}
 
-			Internal::SkipSpaces(pString);
+	bool JsonTextReader::ReadFloat(double& fValue)
+	{
+		if (m_bFailed)
+			return false;
+		Internal::SkipSpaces(m_pCursor);
+		Internal::Scalar oScalar;
+		if (Internal::ReadScalar(m_pCursor, oScalar) == false)
+			return Fail();
+		if (oScalar.eType == JsonValue::E_TYPE_FLOAT)
+			fValue = oScalar.fFloat;
+		else if (oScalar.eType == JsonValue::E_TYPE_INTEGER)
+			fValue = (double)oScalar.iInteger;
+		else
+			return Fail();
+		return true;
+	}
 
-			if (*pString == '}')
-			{
-				++pString;
-				return true;
-			}
-			else if (*pString != ',')
-			{
-				return false;
-			}
-			++pString;
+	bool JsonTextReader::ReadString(const char*& pValue, size_t& iLength)
+	{
+		if (m_bFailed)
+			return false;
+		Internal::SkipSpaces(m_pCursor);
+		if (*m_pCursor != '"')
+			return Fail();
+
+		// Read in place unless escaped
+		const char* pStart = m_pCursor + 1;
+		const char* pEnd = Internal::FindQuoteOrBackslash(pStart);
+		if (*pEnd == '"')
+		{
+			pValue = pStart;
+			iLength = pEnd - pStart;
+			m_pCursor = pEnd + 1;
+			return true;
 		}
-		return false;
+		m_pCursor = pStart;
+		return ReadEscapedString(pValue, iLength);
 	}
 
-	bool JsonValue::ReadArrayValue(const char*& pString, JsonValue& oValue)
+	bool JsonTextReader::BeginObject()
 	{
-		oValue.InitType(JsonValue::E_TYPE_ARRAY);
+		if (m_bFailed)
+			return false;
+		Internal::SkipSpaces(m_pCursor);
+		if (*m_pCursor != '{')
+			return Fail();
+		++m_pCursor;
+		m_bFirst = true;
+		return true;
+	}
 
-		Internal::SkipSpaces( pString );
-		if( *pString == ']' )
+	bool JsonTextReader::NextMember(const char*& pName, size_t& iLength, uint32_t& iHash)
+	{
+		if (m_bFailed)
+			return false;
+		Internal::SkipSpaces(m_pCursor);
+		if (*m_pCursor == '}')
 		{
-			++pString;
-			return true;
+			++m_pCursor;
+			m_bFirst = false;
+			return false;
 		}
 
-		while (*pString != 0)
+		if (m_bFirst == false)
 		{
-			Internal::SkipSpaces(pString);
+			if (*m_pCursor != ',')
+				return Fail();
+			++m_pCursor;
+			Internal::SkipSpaces(m_pCursor);
+		}
+		m_bFirst = false;
 
-			JsonValue* pNewValue = oValue.m_pAllocator->CreateJsonValue(oValue.m_pAllocator, oValue.m_pAllocator->pUserData);
+		if (*m_pCursor != '"')
+			return Fail();
 
-			if (pNewValue->Parse(pString) == false)
-			{
-				oValue.m_pAllocator->DeleteJsonValue(pNewValue, oValue.m_pAllocator->pUserData);
+		// Name is hashed while looking for its end, like Internal::HashMemberName
+		const char* pStart = m_pCursor + 1;
+		const char* pEnd = pStart;
+		uint32_t iNameHash = 2166136261u;
+		while (*pEnd != '"' && *pEnd != '\\' && *pEnd != 0)
+		{
+			iNameHash ^= (uint8_t)*pEnd++;
+			iNameHash *= 16777619u;
+		}
 
+		if (*pEnd == '"')
+		{
+			pName = pStart;
+			iLength = pEnd - pStart;
+			m_pCursor = pEnd + 1;
+		}
+		else
+		{
+			m_pCursor = pStart;
+			if (ReadEscapedString(pName, iLength) == false)
 				return false;
-			}
+			iNameHash = Internal::HashMemberName(pName);
+		}
 
-			if (oValue.m_oValue.Childs.m_pFirst == NULL)
-			{
-				oValue.m_oValue.Childs.m_pFirst = pNewValue;
-			}
-			else
-			{
-				oValue.m_oValue.Childs.m_pLast->m_pNext = pNewValue;
-			}
-			oValue.m_oValue.Childs.m_pLast = pNewValue;
+		Internal::SkipSpaces(m_pCursor);
+		if (*m_pCursor != ':')
+			return Fail();
+		++m_pCursor;
 
-			Internal::SkipSpaces(pString);
+		iHash = iNameHash;
+		return true;
+	}
 
-			if (*pString == ']')
-			{
-				++pString;
-				return true;
-			}
-			else if (*pString != ',')
-			{
-				return false;
-			}
-			++pString;
-		}
-		return false;
+	bool JsonTextReader::BeginArray()
+	{
+		if (m_bFailed)
+			return false;
+		Internal::SkipSpaces(m_pCursor);
+		if (*m_pCursor != '[')
+			return Fail();
+		++m_pCursor;
+		m_bFirst = true;
+		return true;
 	}
 
-	void JsonValue::WriteStringEscaped(Internal::CharBuffer& sOutJson, const char* pInput)
+	bool JsonTextReader::NextValue()
 	{
-		while (*pInput != '\0')
+		if (m_bFailed)
+			return false;
+		Internal::SkipSpaces(m_pCursor);
+		if (*m_pCursor == ']')
 		{
-			char cChar = *pInput;
-			if (cChar == '\n')
-			{
-				sOutJson.PushRange("\\n", 2);
-			}
-			else if (cChar == '\r')
-			{
-				sOutJson.PushRange("\\r", 2);
-			}
-			else if (cChar == '\t')
-			{
-				sOutJson.PushRange("\\t", 2);
-			}
-			else if (cChar == '\b')
-			{
-				sOutJson.PushRange("\\b", 2);
-			}
-			else if (cChar == '\f')
-			{
-				sOutJson.PushRange("\\f", 2);
-			}
-			else if (cChar == '"')
-			{
-				sOutJson.PushRange("\\\"", 2);
-			}
-			else if (cChar == '\\')
-			{
-				sOutJson.PushRange("\\\\", 2);
-			}
-			else if ((unsigned char)cChar < 0x80)
-			{
-				sOutJson += cChar;
-			}
-			else
-			{
-				uint32_t iChar = (unsigned char)cChar;
-				if ((iChar & 0xE0) == 0xC0) // 2 byte
-				{
-					iChar = ((((unsigned char)pInput[0]) & 0x1F) << 6)
-						+ ((((unsigned char)pInput[1]) & 0x3F) << 0);
-					pInput += 1;
-				}
-				else if ((iChar & 0xF0) == 0xE0) // 3 bytes
-				{
-					iChar = ((((unsigned char)pInput[0]) & 0x0F) << 12)
-						+ ((((unsigned char)pInput[1]) & 0x3F) << 6)
-						+ ((((unsigned char)pInput[2]) & 0x3F) << 0);
-					pInput += 2;
-				}
-				else if ((iChar & 0xF8) == 0xF0 && iChar <= 0xF4) // 4 bytes
-				{
-					iChar = ((((unsigned char)pInput[0]) & 0x07) << 18)
-						+ ((((unsigned char)pInput[1]) & 0x3F) << 12)
-						+ ((((unsigned char)pInput[2]) & 0x3F) << 6)
-						+ ((((unsigned char)pInput[3]) & 0x3F) << 0);
-					pInput += 3;
-				}
-				else
-				{
-					//Invalid char
-					JsonStthmAssert(false);
-					iChar = 0;
-				}
-
-				const char* const pHexa = "0123456789abcdef";
-
-				if (iChar < 0xFFFF)
-				{
-					sOutJson.PushRange("\\u", 2);
-					sOutJson.Push(pHexa[(iChar >> 12) & 0x0f]);
-					sOutJson.Push(pHexa[(iChar >> 8) & 0x0f]);
-					sOutJson.Push(pHexa[(iChar >> 4) & 0x0f]);
-					sOutJson.Push(pHexa[(iChar >> 0) & 0x0f]);
-				}
-				else
-				{
-					//UTF-16 pair surrogate
-					uint32_t iCharBis = iChar - 0x10000;
-					uint32_t iW1 = 0xD800 | ((iCharBis >> 10) & 0x3FF);
-					uint32_t iW2 = 0xDC00 | (iCharBis & 0x3FF);
-					sOutJson.PushRange("\\u", 2);
-					sOutJson.Push(pHexa[(iW1 >> 12) & 0x0f]);
-					sOutJson.Push(pHexa[(iW1 >> 8) & 0x0f]);
-					sOutJson.Push(pHexa[(iW1 >> 4) & 0x0f]);
-					sOutJson.Push(pHexa[(iW1 >> 0) & 0x0f]);
-					sOutJson.PushRange("\\u", 2);
-					sOutJson.Push(pHexa[(iW2 >> 12) & 0x0f]);
-					sOutJson.Push(pHexa[(iW2 >> 8) & 0x0f]);
-					sOutJson.Push(pHexa[(iW2 >> 4) & 0x0f]);
-					sOutJson.Push(pHexa[(iW2 >> 0) & 0x0f]);
-				}
-			}
+			++m_pCursor;
+			m_bFirst = false;
+			return false;
+		}
 
-			++pInput;
+		if (m_bFirst == false)
+		{
+			if (*m_pCursor != ',')
+				return Fail();
+			++m_pCursor;
 		}
+		m_bFirst = false;
+		return true;
 	}
 
-	JsonValue* JsonValue::DefaultAllocatorCreateJsonValue(Allocator* pAllocator, void* /*pUserData*/)
+	bool JsonTextReader::SkipValue()
 	{
-		return new JsonValue(pAllocator);
+		if (m_bFailed)
+			return false;
+		Internal::SkipSpaces(m_pCursor);
+		if (Internal::SkipValue(m_pCursor) == false)
+			return Fail();
+		return true;
 	}
 
-	void JsonValue::DefaultAllocatorDeleteJsonValue(JsonValue* pValue, void* /*pUserData*/)
+	bool JsonTextReader::Fail()
 	{
-		delete pValue;
+		m_bFailed = true;
+		return false;
 	}
 
-	char* JsonValue::DefaultAllocatorAllocString(size_t iSize, void* /*pUserData*/)
+	bool JsonTextReader::ReadEscapedString(const char*& pValue, size_t& iLength)
 	{
-		return (char*)JsonStthmMalloc(iSize);
+		// Unescaped in the reused string buffer
+		m_oString.Clear();
+		const char* pString = JsonValue::ReadStringValue(m_pCursor, &m_oStringAllocator, false);
+		if (pString == NULL)
+			return Fail();
+		pValue = pString;
+		iLength = strlen(pString);
+		return true;
 	}
 
-	void JsonValue::DefaultAllocatorFreeString(char* pString, void* /*pUserData*/)
+	char* JsonTextReader::AllocString(size_t iSize, void* pUserData)
 	{
-		JsonStthmFree(pString);
+		Internal::CharBuffer& oString = ((JsonTextReader*)pUserData)->m_oString;
+		oString.Resize(iSize);
+		return oString.Data();
+	}
+
+	void JsonTextReader::FreeString(char* /*pString*/, void* /*pUserData*/)
+	{
+		// Do nothing, buffer is reused
 	}
 
 	//////////////////////////////
-	// JsonDoc
+	// JsonTextWriter
 	//////////////////////////////
 
-	JsonDoc::JsonDoc(size_t iBlockSize)
-		: m_oRoot(&m_oAllocator)
-		, m_iBlockSize(iBlockSize)
-		, m_pLastBlock(NULL)
+	bool JsonTextWriter::FileSink(const char* pData, size_t iSize, void* pUserData)
 	{
-		m_oAllocator.CreateJsonValue	= &JsonDoc::CreateJsonValue;
-		m_oAllocator.DeleteJsonValue	= &JsonDoc::DeleteJsonValue;
-		m_oAllocator.AllocString		= &JsonDoc::AllocString;
-		m_oAllocator.FreeString			= &JsonDoc::FreeString;
-		m_oAllocator.pUserData			= this;
+		return fwrite(pData, 1, iSize, (FILE*)pUserData) == iSize;
 	}
 
-	JsonDoc::~JsonDoc()
+	bool JsonTextWriter::FileDescriptorSink(const char* pData, size_t iSize, void* pUserData)
 	{
-		Clear();
+		const int iFileDescriptor = (int)(intptr_t)pUserData;
+		while (iSize > 0)
+		{
+#if defined(_WIN32)
+			const unsigned int iChunk = iSize > 0x40000000 ? 0x40000000 : (unsigned int)iSize;
+			const int iWritten = _write(iFileDescriptor, pData, iChunk);
+#else
+			const ssize_t iWritten = write(iFileDescriptor, pData, iSize);
+			if (iWritten < 0 && errno == EINTR)
+				continue;
+#endif
+			if (iWritten <= 0)
+				return false;
+			pData += iWritten;
+			iSize -= (size_t)iWritten;
+		}
+		return true;
 	}
 
-	void JsonDoc::Clear()
+	JsonTextWriter::JsonTextWriter(Internal::CharBuffer& oOut, int iFlags)
+		: m_pOut(&oOut)
+		, m_oBuffer(0)
+		, m_pSink(NULL)
+		, m_pSinkUserData(NULL)
+		, m_iFlushSize(0)
+		, m_pIndentTable(Internal::c_pIndentTabs)
+		, m_iIndentWidth(1)
+		, m_iBaseIndent(0)
+		, m_iDepth(0)
+		, m_bFirst(true)
+		, m_bAfterKey(false)
+		, m_bRawUtf8((iFlags & JsonValue::E_WRITE_RAW_UTF8) != 0)
+		, m_bPretty((iFlags & JsonValue::E_WRITE_PRETTY) != 0)
+		, m_bFailed(false)
 	{
-		m_oRoot.m_eType = JsonValue::E_TYPE_NULL;
-		Block* pBlock = m_pLastBlock;
-		while (pBlock != NULL)
+	}
+
+	JsonTextWriter::JsonTextWriter(SinkCallback pSink, void* pUserData, int iFlags, size_t iFlushSize)
+		: m_pOut(&m_oBuffer)
+		, m_oBuffer(iFlushSize + 1024)
+		, m_pSink(pSink)
+		, m_pSinkUserData(pUserData)
+		, m_iFlushSize(iFlushSize)
+		, m_pIndentTable(Internal::c_pIndentTabs)
+		, m_iIndentWidth(1)
+		, m_iBaseIndent(0)
+		, m_iDepth(0)
+		, m_bFirst(true)
+		, m_bAfterKey(false)
+		, m_bRawUtf8((iFlags & JsonValue::E_WRITE_RAW_UTF8) != 0)
+		, m_bPretty((iFlags & JsonValue::E_WRITE_PRETTY) != 0)
+		, m_bFailed(false)
+	{
+		JsonStthmAssert(pSink != NULL);
+	}
+
+	JsonTextWriter::~JsonTextWriter()
+	{
+		Flush();
+	}
+
+	bool JsonTextWriter::Flush()
+	{
+		if (m_pSink != NULL && m_oBuffer.Size() > 0)
 		{
-			Block* pPrevious = pBlock->m_pPrevious;
-			JsonStthmFree(pBlock);
-			pBlock = pPrevious;
+			if (m_bFailed == false && m_pSink(m_oBuffer.Data(), m_oBuffer.Size(), m_pSinkUserData) == false)
+				m_bFailed = true;
+			m_oBuffer.Clear();
 		}
-		m_pLastBlock = NULL;
+		return m_bFailed == false;
 	}
 
-	int JsonDoc::ReadString(const char* pJson)
+	void JsonTextWriter::BeginObject()
 	{
-		Clear();
-		return m_oRoot.ReadString(pJson);
+		Separate();
+		*m_pOut += '{';
+		++m_iDepth;
+		m_bFirst = true;
 	}
 
-	int JsonDoc::ReadFile(const char* pFilename)
+	void JsonTextWriter::EndObject()
 	{
-		Clear();
-		return m_oRoot.ReadFile(pFilename);
+		--m_iDepth;
+		if (m_bPretty)
+			NewLine();
+		*m_pOut += '}';
+		m_bFirst = false;
 	}
 
-	void* JsonDoc::Allocate(JsonDoc* pDoc, size_t iSize, size_t iAlign)
+	void JsonTextWriter::Key(const char* pName)
 	{
-		Block* pHead = pDoc->m_pLastBlock;
-		if (pHead != NULL && (iSize + iAlign + pHead->m_iUsed) <= pDoc->m_iBlockSize)
-		{
-			char* pMem = ((char*)pHead) + pHead->m_iUsed;
-			size_t iAlignOffset = iAlign - ((intptr_t)pMem % iAlign);
-			pMem += iAlignOffset;
+		Separate();
+		*m_pOut += '"';
+		JsonValue::WriteStringEscaped(*m_pOut, pName, m_bRawUtf8);
+		if (m_bPretty)
+			m_pOut->PushRange("\": ", 3);
+		else
+			m_pOut->PushRange("\":", 2);
+		m_bAfterKey = true;
+	}
 
-			JsonStthmAssert((intptr_t)pMem % iAlign == 0);
+	void JsonTextWriter::RawKey(const char* pKey, size_t iLength)
+	{
+		Separate();
+		m_pOut->PushRange(pKey, iLength);
+		if (m_bPretty)
+			*m_pOut += ' ';
+		m_bAfterKey = true;
+	}
 
-			pHead->m_iUsed += iSize + iAlignOffset;
-			return pMem;
-		}
+	void JsonTextWriter::BeginArray()
+	{
+		Separate();
+		*m_pOut += '[';
+		++m_iDepth;
+		m_bFirst = true;
+	}
+
+	void JsonTextWriter::EndArray()
+	{
+		--m_iDepth;
+		if (m_bPretty)
+			NewLine();
+		*m_pOut += ']';
+		m_bFirst = false;
+	}
 
-		size_t iAllocSize = sizeof(Block) + iSize + iAlign;
-		size_t iBlockSize = (iAllocSize <= pDoc->m_iBlockSize) ? pDoc->m_iBlockSize : iAllocSize;
-		Block* pBlock = (Block*)JsonStthmMalloc(iBlockSize);
+	void JsonTextWriter::String(const char* pValue)
+	{
+		Separate();
+		*m_pOut += '"';
+		JsonValue::WriteStringEscaped(*m_pOut, pValue, m_bRawUtf8);
+		*m_pOut += '"';
+	}
 
-		char* pMem = (char*)(pBlock + 1);
-		size_t iAlignOffset = iAlign - ((intptr_t)pMem % iAlign);
-		pMem += iAlignOffset;
+	void JsonTextWriter::Integer(int64_t iValue)
+	{
+		Separate();
+		Internal::PushInteger(*m_pOut, iValue);
+	}
 
-		pBlock->m_iUsed = sizeof(Block) + iSize + iAlignOffset;
+	void JsonTextWriter::Float(double fValue)
+	{
+		Separate();
+		Internal::PushFloat(*m_pOut, fValue);
+	}
 
-		if (iAllocSize <= iBlockSize || pHead == NULL)
-		{
-			pBlock->m_pPrevious = pHead;
-			pDoc->m_pLastBlock = pBlock;
-		}
+	void JsonTextWriter::Boolean(bool bValue)
+	{
+		Separate();
+		if (bValue)
+			m_pOut->PushRange("true", 4);
 		else
-		{
-			pBlock->m_pPrevious = pHead->m_pPrevious;
-			pHead->m_pPrevious = pBlock;
-		}
-
-		JsonStthmAssert((intptr_t)pMem % iAlign == 0);
+			m_pOut->PushRange("false", 5);
+	}
 
-		return pMem;
+	void JsonTextWriter::Null()
+	{
+		Separate();
+		m_pOut->PushRange("null", 4);
 	}
 
-	JsonValue* JsonDoc::CreateJsonValue(Allocator* pAllocator, void* pUserData)
+	void JsonTextWriter::Value(const JsonValue& oValue)
 	{
-		JsonValue* pValue = (JsonValue*)Allocate((JsonDoc*)pUserData, sizeof(JsonValue), alignof(JsonValue));
-		if (pValue != NULL)
+		// Containers being written
+		Internal::Buffer<const JsonValue*, 64> oParents;
+		const JsonValue* pValue = &oValue;
+		for (;;)
 		{
-			memset(pValue, 0, sizeof(JsonValue));
-			pValue->m_pAllocator = pAllocator;
-			return pValue;
+			if (oParents.Size() > 0 && oParents.Data()[oParents.Size() - 1]->m_eType == JsonValue::E_TYPE_OBJECT)
+				Key(pValue->m_pName);
+
+			switch (pValue->m_eType)
+			{
+			case JsonValue::E_TYPE_OBJECT:
+				BeginObject();
+				if (pValue->m_oValue.Childs.m_pFirst != NULL)
+				{
+					oParents.Push(pValue);
+					pValue = pValue->m_oValue.Childs.m_pFirst;
+					continue;
+				}
+				EndObject();
+				break;
+			case JsonValue::E_TYPE_ARRAY:
+				BeginArray();
+				if (pValue->m_oValue.Childs.m_pFirst != NULL)
+				{
+					oParents.Push(pValue);
+					pValue = pValue->m_oValue.Childs.m_pFirst;
+					continue;
+				}
+				EndArray();
+				break;
+			case JsonValue::E_TYPE_STRING:
+				String(pValue->m_oValue.String);
+				break;
+			case JsonValue::E_TYPE_BOOLEAN:
+				Boolean(pValue->m_oValue.Boolean);
+				break;
+			case JsonValue::E_TYPE_INTEGER:
+				Integer(pValue->m_oValue.Integer);
+				break;
+			case JsonValue::E_TYPE_FLOAT:
+				Float(pValue->m_oValue.Float);
+				break;
+			default:
+				Null();
+				break;
+			}
+
+			// Next sibling, closing finished containers
+			for (;;)
+			{
+				if (oParents.Size() == 0)
+					return;
+				if (pValue->m_pNext != NULL)
+				{
+					pValue = pValue->m_pNext;
+					break;
+				}
+				pValue = oParents.Data()[oParents.Size() - 1];
+				oParents.Resize(oParents.Size() - 1);
+				if (pValue->m_eType == JsonValue::E_TYPE_OBJECT)
+					EndObject();
+				else
+					EndArray();
+			}
 		}
-		return NULL;
 	}
 
-	void JsonDoc::DeleteJsonValue(JsonValue* /*pValue*/, void* /*pUserData*/)
+	void JsonTextWriter::SetIndent(char cChar, size_t iWidth)
 	{
-		// Do nothing
+		JsonStthmAssert(cChar == '\t' || cChar == ' ');
+		m_pIndentTable = cChar == ' ' ? Internal::c_pIndentSpaces : Internal::c_pIndentTabs;
+		m_iIndentWidth = iWidth;
 	}
 
-	char* JsonDoc::AllocString(size_t iSize, void* pUserData)
+	void JsonTextWriter::Separate()
 	{
-		return (char*)Allocate((JsonDoc*)pUserData, iSize, 1);
-	}
+		if (m_pSink != NULL && m_oBuffer.Size() >= m_iFlushSize)
+			Flush();
 
-	void JsonDoc::FreeString(char* /*pString*/, void* /*pUserData*/)
-	{
-		// Do nothing
+		// Value of a member follows its key
+		if (m_bAfterKey)
+		{
+			m_bAfterKey = false;
+			return;
+		}
+
+		if (m_bFirst == false)
+			*m_pOut += ',';
+		m_bFirst = false;
+		if (m_bPretty && m_iDepth > 0)
+			NewLine();
 	}
 
-	size_t JsonDoc::MemoryUsage() const
+	void JsonTextWriter::NewLine()
 	{
-		Block* pBlock = m_pLastBlock;
-		size_t iSize = 0;
-		while (pBlock != NULL)
+		// Slices of the shared indent table
+		size_t iCount = (m_iBaseIndent + m_iDepth) * m_iIndentWidth;
+		size_t iSlice = iCount < Internal::c_iIndentTableSize ? iCount : Internal::c_iIndentTableSize;
+		m_pOut->PushRange(m_pIndentTable, 1 + iSlice);
+		for (iCount -= iSlice; iCount > 0; iCount -= iSlice)
 		{
-			iSize += (pBlock->m_iUsed > m_iBlockSize) ? pBlock->m_iUsed : m_iBlockSize;
-			pBlock = pBlock->m_pPrevious;
+			iSlice = iCount < Internal::c_iIndentTableSize ? iCount : Internal::c_iIndentTableSize;
+			m_pOut->PushRange(m_pIndentTable + 1, iSlice);
 		}
-		return iSize;
 	}
 }
@@ -17,10 +17,15 @@ namespace JsonStthm
 		char*						(*AllocString)		(size_t iSize, void* pUserData);
 		void						(*FreeString)		(char* pAlloc, void* pUserData);
 		void*						pUserData;
+		// Optional, after pUserData so older initializers still compile, NULL for linear child lookups
+		void*						(*AllocMemory)		(size_t iSize, void* pUserData); // Aligned for any pointer or integer
+		void						(*FreeMemory)		(void* pMemory, void* pUserData);
 	};
 
 	namespace Internal
 	{
+		class FileContent;
+
 		bool IsNaN(double x);
 		bool IsInfinite(double x);
 
@@ -54,7 +59,7 @@ namespace JsonStthm
 					JsonStthmFree(m_pData);
 			}
 
-			Buffer<T>& operator +=(const T& oValue)
+			Buffer<T, HeapSize>& operator +=(const T& oValue)
 			{
 				Push(oValue);
 				return *this;
@@ -69,7 +74,7 @@ namespace JsonStthm
 			void PushRange(const T* pBegin, size_t iLength)
 			{
 				Resize(m_iSize + iLength);
-				memcpy(&m_pData[m_iSize - iLength], pBegin, iLength);
+				memcpy(&m_pData[m_iSize - iLength], pBegin, iLength * sizeof(T));
 			}
 
 			size_t Size() const
@@ -77,6 +82,11 @@ namespace JsonStthm
 				return m_iSize;
 			}
 
+			size_t Capacity() const
+			{
+				return m_iCapacity;
+			}
+
 			void Reserve(size_t iCapacity, bool bForceAlloc = false)
 			{
 				if (iCapacity != m_iCapacity)
@@ -107,6 +117,7 @@ namespace JsonStthm
 			}
 
 			const T* Data() const { return m_pData; }
+			T* Data() { return m_pData; }
 
 			T* Take(Allocator* pAllocator)
 			{
@@ -155,9 +166,45 @@ namespace JsonStthm
 		typedef Buffer<char> CharBuffer;
 	}
 
+	// Set of JSON Pointers (RFC 6901) compiled in a tree, a "*" token matches any member or array value
+	class STTHM_API JsonPathSet
+	{
+		friend class JsonValue;
+	public:
+							JsonPathSet();
+
+		// Returns false when pPath is not a valid pointer, "" selects the whole document
+		bool				Add(const char* pPath);
+		void				Clear();
+	protected:
+		struct Node
+		{
+			uint32_t		m_iName;		// Offset of the unescaped token in m_oNames
+			int64_t			m_iIndex;		// Array index matched by the token, -1 when it is not a number
+			uint32_t		m_iFirstChild;	// 0 when none, node 0 is the document
+			uint32_t		m_iNextSibling;
+			bool			m_bWildcard;
+			bool			m_bLeaf;		// Whole value is selected
+		};
+
+		Internal::Buffer<Node, 1>	m_oNodes;
+		Internal::Buffer<char, 1>	m_oNames;
+
+		const char*			GetName(const Node& oNode) const	{ return m_oNames.Data() + oNode.m_iName; }
+		uint32_t			AddChild(uint32_t iParent, const char* pToken, size_t iLength);
+	};
+
 	class STTHM_API JsonValue
 	{
 		friend class JsonDoc;
+		friend class JsonTape;
+		friend class JsonSax;
+		friend class JsonPushReader;
+		friend class JsonLinesReader;
+		friend class JsonLazyDoc;
+		friend class JsonPath;
+		friend class JsonTextReader;
+		friend class JsonTextWriter;
 	public:
 		enum EType
 		{
@@ -185,12 +232,29 @@ namespace JsonStthm
 			JsonValue* m_pChild;
 		};
 
+		enum EReadFlags
+		{
+			E_READ_DEFAULT				= 0,
+			E_READ_NO_FILE_MAPPING		= 1 << 0,	// ReadFile reads the file in a buffer instead of mapping it in memory
+			E_READ_PARALLEL_ARRAY		= 1 << 1,	// JsonDoc only: values of a top level array are parsed on several threads
+			E_READ_VALIDATE_UTF8		= 1 << 2	// Input is rejected when it is not valid UTF-8, checked by a SIMD pass before parsing
+		};
+
+		enum EWriteFlags
+		{
+			E_WRITE_DEFAULT				= 0,
+			E_WRITE_RAW_UTF8			= 1 << 0,	// Non-ASCII chars are written as UTF-8 instead of \uXXXX, invalid bytes become \ufffd
+			E_WRITE_PRETTY				= 1 << 1	// JsonTextWriter only: one member or value per line, indented with tabs
+		};
+
 		static JsonValue	INVALID;
 	protected:
 							JsonValue(Allocator* pAllocator);
 	public:
 							JsonValue();
 							JsonValue(const JsonValue& oSource);
+							// Steals the childs or string of oSource when it uses the default allocator, else copies. oSource is null afterwards.
+							JsonValue(JsonValue&& oSource) noexcept;
 							JsonValue(bool bValue);
 #ifdef JsonStthmString
 							JsonValue(const JsonStthmString& sValue);
@@ -204,15 +268,24 @@ namespace JsonStthm
 		void				Reset();
 		EType				GetType() const;
 
-		int					ReadString(const char* pJson);
-		int					ReadFile(const char* pFilename);
+		int					ReadString(const char* pJson, int iFlags = E_READ_DEFAULT);
+		int					ReadFile(const char* pFilename, int iFlags = E_READ_DEFAULT);
 
-		void				Write(Internal::CharBuffer& sOutJson, size_t iIndent, bool bCompact) const;
+		// Only values selected by oPaths and their parents are built, everything else is skipped.
+		// Arrays keep the index of selected values, skipped ones before them are null.
+		int					ReadString(const char* pJson, const JsonPathSet& oPaths);
+		int					ReadFile(const char* pFilename, const JsonPathSet& oPaths, int iFlags = E_READ_DEFAULT);
+
+		// Checks syntax and UTF-8 encoding without building any value, pJson[iLength] must be a null char.
+		// Returns 0 when valid, -1 when pJson is NULL, else the line of the error.
+		static int			Validate(const char* pJson, size_t iLength);
+
+		void				Write(Internal::CharBuffer& sOutJson, size_t iIndent, bool bCompact, int iFlags = E_WRITE_DEFAULT) const;
 #ifdef JsonStthmString
-		void				WriteString(JsonStthmString& sOutJson, bool bCompact = false) const;
+		void				WriteString(JsonStthmString& sOutJson, bool bCompact = false, int iFlags = E_WRITE_DEFAULT) const;
 #endif //JsonStthmString
-		char*				WriteString(bool bCompact) const;
-		bool				WriteFile(const char* pFilename, bool bCompact = false) const;
+		char*				WriteString(bool bCompact, int iFlags = E_WRITE_DEFAULT) const;
+		bool				WriteFile(const char* pFilename, bool bCompact = false, int iFlags = E_WRITE_DEFAULT) const;
 
 		int					GetMemberCount() const;
 
@@ -249,6 +322,22 @@ namespace JsonStthm
 
 		JsonValue&			Append();
 
+		// Values are exchanged in O(1) when both use the same allocator, else copied. Names stay in place.
+		// Neither value may contain the other.
+		void				Swap(JsonValue& oOther);
+
+		// Removes a member or child and moves its value to oOut, returns false when not found
+		bool				Detach(const char* pName, JsonValue& oOut);
+		bool				Detach(int iIndex, JsonValue& oOut);
+
+		// Removes and deletes a member or child, returns false when not found
+		bool				Remove(const char* pName);
+		bool				Remove(int iIndex);
+
+		// Moves oValue to the member pName (replaced when it exists) or to the end of the array, oValue is null afterwards
+		JsonValue&			Adopt(const char* pName, JsonValue& oValue);
+		JsonValue&			Adopt(JsonValue& oValue);
+
 		// bMergeSubMembers parameter is for object type and gonna try to merge sub members when possible
 		// Other types will just add values
 		bool				Combine(const JsonValue& oRight, bool bMergeSubMembers);
@@ -266,6 +355,8 @@ namespace JsonStthm
 		JsonValue&			operator [](int iIndex);
 
 		JsonValue&			operator =(const JsonValue& oValue);
+		// O(1) when both use the same allocator, else copies. oValue is null afterwards, it can be a child of this value.
+		JsonValue&			operator =(JsonValue&& oValue) noexcept;
 #ifdef JsonStthmString
 		JsonValue&			operator =(const JsonStthmString& sValue);
 #endif //JsonStthmString
@@ -278,9 +369,29 @@ namespace JsonStthm
 	protected:
 		void				SetStringValue(const char* pString);
 
+		struct ChildIndex;
+		struct ChildArray;
+
+		void				AppendChild(JsonValue* pChild);
+		// Unlinks pChild, pPrevious is its previous sibling or NULL and iPosition its index
+		void				RemoveChild(JsonValue* pChild, JsonValue* pPrevious, int iPosition);
+		// Unlinked child or NULL when not found
+		JsonValue*			UnlinkMember(const char* pName);
+		JsonValue*			UnlinkChild(int iIndex);
+		// Moves value, childs and indexes of oSource, this value must be null
+		void				StealValue(JsonValue& oSource);
+		JsonValue*			FindMember(const char* pName) const;
+		JsonValue*			FindMember(const char* pName, uint32_t iHash) const;
+		JsonValue*			FindChild(int iIndex) const;
+		void				BuildMemberIndex();
+		void				InsertMemberIndex(JsonValue* pMember);
+		void				BuildChildArray();
+		void				InsertChildArray(JsonValue* pChild);
+
 		Allocator*			m_pAllocator;
 
 		EType				m_eType;
+		int					m_iChildCount;	// Objects and arrays only
 		char*				m_pName;
 		JsonValue*			m_pNext;
 
@@ -288,6 +399,11 @@ namespace JsonStthm
 		{
 			JsonValue*		m_pFirst;
 			JsonValue*		m_pLast;
+			union
+			{
+				ChildIndex*	m_pIndex;	// Hash of members for large objects
+				ChildArray*	m_pArray;	// Pointers to childs for large arrays
+			};
 		};
 
 		union ValueUnion
@@ -301,49 +417,126 @@ namespace JsonStthm
 
 		ValueUnion			m_oValue;
 
-		bool				Parse(const char*& pString);
+		// bInSitu: strings are unescaped in place and point into pJson, only for allocators that never free them
+		int					Read(const char* pJson, size_t iLength, int iFlags, bool bInSitu);
+		// Iterative, nesting deeper than STTHM_MAX_DEPTH is an error
+		bool				Parse(const char*& pString, bool bInSitu);
+		// Appends a child, reading its member name first in objects, NULL on error
+		JsonValue*			ParseNewChild(const char*& pString, bool bInSitu);
+		// Strings, numbers and literals
+		bool				ParseLeaf(const char*& pString, bool bInSitu);
+		int					ReadProjected(const char* pJson, const JsonPathSet& oPaths);
+		// pNodes are the path nodes matching this value
+		bool				ParseProjected(const char*& pString, const JsonPathSet& oPaths, const uint32_t* pNodes, size_t iNodeCount);
 
 		static inline int	ReadSpecialChar(const char*& pString, char* pOut);
-		static inline char*	ReadStringValue(const char*& pString, Allocator* pAllocator);
+		static inline char*	ReadStringValue(const char*& pString, Allocator* pAllocator, bool bInSitu);
 		static inline bool	ReadNumericValue(const char*& pString, JsonValue& oValue);
-		static inline bool	ReadObjectValue(const char*& pString, JsonValue& oValue);
-		static inline bool	ReadArrayValue(const char*& pString, JsonValue& oValue);
-		static void			WriteStringEscaped(Internal::CharBuffer& sOutJson, const char* pBuffer);
+		// pString is after the opening quote
+		static bool			ValidateStringValue(const char*& pString);
+		static bool			ValidateMemberName(const char*& pString);
+		// pString is after the opening quote, escaped chars are decoded while comparing
+		static bool			MatchStringValue(const char* pString, const char* pName);
+		static void			WriteStringEscaped(Internal::CharBuffer& sOutJson, const char* pBuffer, bool bRawUtf8);
 
 		static JsonValue*	DefaultAllocatorCreateJsonValue(Allocator* pAllocator, void* pUserData);
 		static void			DefaultAllocatorDeleteJsonValue(JsonValue* pValue, void* pUserData);
 		static char*		DefaultAllocatorAllocString(size_t iSize, void* pUserData);
 		static void			DefaultAllocatorFreeString(char* pString, void* pUserData);
+		static void*		DefaultAllocatorAllocMemory(size_t iSize, void* pUserData);
+		static void			DefaultAllocatorFreeMemory(void* pMemory, void* pUserData);
 		static Allocator	s_oDefaultAllocator;
 	};
 
-	// Quicker and use less memory than loading a Json with JsonValue, but read only
+	// Quicker and use less memory than loading a Json with JsonValue.
+	// Values are allocated in blocks freed all at once, edits through GetMutableRoot() allocate in the blocks too
+	// and removed or replaced values become dead bytes until Compact().
 	class STTHM_API JsonDoc
 	{
+		friend class JsonLinesReader;
+		friend class JsonLazyDoc;
 	public:
+		// Blocks kept empty by Clear() and the Read functions for the next parse
+		enum ERetainMode
+		{
+			E_RETAIN_NONE = 0,		// Every block is freed
+			E_RETAIN_LARGEST_BLOCK,	// Largest block is kept
+			E_RETAIN_HIGH_WATER		// Largest blocks are kept up to a total size
+		};
+
+		struct MemoryStats
+		{
+			size_t			m_iReserved;	// Bytes of all blocks, see MemoryUsage()
+			size_t			m_iUsed;		// Bytes given to values, names, strings and indexes, alignment included
+			size_t			m_iWasted;		// Unused ends of blocks left behind when a new block was started
+			size_t			m_iRetained;	// Bytes of empty blocks kept for the next parse
+			size_t			m_iDead;		// Part of m_iUsed left by edits: removed values, replaced strings and indexes
+			size_t			m_iPeak;		// Highest m_iReserved since construction
+			size_t			m_iBlockCount;
+		};
+
+		// Block sizes grow geometrically from iBlockSize up to STTHM_DOC_MAX_BLOCK_SIZE
 							JsonDoc(size_t iBlockSize = 4096);
 							~JsonDoc();
 
-		const JsonValue&	GetRoot() { return m_oRoot; }
+		const JsonValue&	GetRoot() const { return m_oRoot; }
+		// For edits, operator[] adds missing members like on any JsonValue
+		JsonValue&			GetMutableRoot() { return m_oRoot; }
 
+		// Copies the live tree in new blocks without dead bytes and frees the old ones.
+		// In situ strings are copied too, the source buffer is not needed anymore.
+		void				Compact();
+
+		// Blocks are kept or freed according to the retain mode
 		void				Clear();
+		// iHighWater is only used by E_RETAIN_HIGH_WATER
+		void				SetRetainMode(ERetainMode eMode, size_t iHighWater = 0);
 
-		int					ReadString(const char* pJson);
-		int					ReadFile(const char* pFilename);
+		int					ReadString(const char* pJson, int iFlags = JsonValue::E_READ_DEFAULT);
+		int					ReadFile(const char* pFilename, int iFlags = JsonValue::E_READ_DEFAULT);
+
+		// See JsonValue::ReadString
+		int					ReadString(const char* pJson, const JsonPathSet& oPaths);
+		int					ReadFile(const char* pFilename, const JsonPathSet& oPaths, int iFlags = JsonValue::E_READ_DEFAULT);
 
+		// Destructive parsing, strings are unescaped in place and names/values point into pJson.
+		// pJson[iLength] must be the null terminator and pJson must outlive the JsonDoc content.
+		int					ReadInSitu(char* pJson, size_t iLength, int iFlags = JsonValue::E_READ_DEFAULT);
+
+		// Bytes of all blocks, retained ones included
 		size_t				MemoryUsage() const;
+		void				GetMemoryStats(MemoryStats& oStats) const;
 	protected:
 		Allocator			m_oAllocator;
 		JsonValue			m_oRoot;
 
 		struct Block
 		{
+			size_t			m_iSize;
 			size_t			m_iUsed;
 			Block*			m_pPrevious;
 		};
 
 		size_t				m_iBlockSize;
 		Block*				m_pLastBlock;
+		Block*				m_pRetainedBlocks;	// Empty, largest first
+		ERetainMode			m_eRetainMode;
+		size_t				m_iHighWater;
+		size_t				m_iReserved;
+		size_t				m_iPeak;
+		size_t				m_iDead;
+		bool				m_bInSitu;		// Some strings may point into the source buffer instead of the blocks
+
+		void				FreeBlocks();
+		static Block*		NewBlock(JsonDoc* pDoc, size_t iMinSize);
+		bool				IsInBlocks(const void* pMemory) const;
+
+		struct ParallelRange;
+
+		int					Read(const char* pJson, size_t iLength, int iFlags, bool bInSitu);
+		// Returns false when the document is not suited, before anything was parsed
+		bool				ReadParallelArray(const char* pJson, size_t iLength, int& iResult);
+		static void			ParseParallelRange(ParallelRange* pRange);
 
 		static void*		Allocate(JsonDoc* pDoc, size_t iSize, size_t iAlign);
 
@@ -351,6 +544,551 @@ namespace JsonStthm
 		static void			DeleteJsonValue(JsonValue* pValue, void* pUserData);
 		static char*		AllocString(size_t iSize, void* pUserData);
 		static void			FreeString(char* pString, void* pUserData);
+		static void*		AllocMemory(size_t iSize, void* pUserData);
+		static void			FreeMemory(void* pMemory, void* pUserData);
+	};
+
+	// Compiled JSON Pointer (RFC 6901) evaluated on JsonValue trees, segments are unescaped and hashed once.
+	// Extensions: "*" matches any member or array value, "?name=value" matches the childs
+	// having a member name equal to value (a number, true, false, null or else a string)
+	class STTHM_API JsonPath
+	{
+	public:
+		// Returns false to stop
+		typedef bool		(*MatchCallback)(const JsonValue& oValue, void* pUserData);
+
+							JsonPath();
+							JsonPath(const char* pPath);
+
+		// Returns false when pPath is not a valid path
+		bool				Compile(const char* pPath);
+		bool				IsValid() const		{ return m_bValid; }
+
+		// First matching value, JsonValue::INVALID when none
+		const JsonValue&	Find(const JsonValue& oRoot) const;
+		const JsonValue&	Find(const JsonDoc& oDoc) const;
+		// Calls pCallback for each matching value in document order, returns the number of matches
+		int					FindAll(const JsonValue& oRoot, MatchCallback pCallback, void* pUserData) const;
+		// First matching value of each root, documents are walked together one segment at a time so their
+		// cache misses overlap. Faster than Find when roots are scattered in memory, not when they are in order.
+		void				FindBatch(const JsonValue* const* pRoots, size_t iCount, const JsonValue** pResults) const;
+	protected:
+		enum ESegmentType
+		{
+			E_SEGMENT_NAME,
+			E_SEGMENT_WILDCARD,
+			E_SEGMENT_FILTER
+		};
+
+		struct Segment
+		{
+			ESegmentType		m_eType;
+			uint32_t			m_iName;	// Offset of the unescaped name in m_oNames
+			uint32_t			m_iHash;
+			int					m_iIndex;	// Array index matched by the name, -1 when it is not a number
+
+			// Filter value
+			JsonValue::EType	m_eValueType;
+			uint32_t			m_iString;	// Offset in m_oNames
+			bool				m_bBoolean;
+			int64_t				m_iInteger;
+			double				m_fFloat;
+		};
+
+		Internal::Buffer<Segment, 1>	m_oSegments;
+		Internal::Buffer<char, 1>		m_oNames;
+		bool							m_bValid;
+		bool							m_bSingle;	// No wildcard nor filter, at most one match
+
+		const char*			GetName(uint32_t iOffset) const		{ return m_oNames.Data() + iOffset; }
+		bool				PushToken(const char* pBegin, const char* pEnd, uint32_t& iOffset);
+		const JsonValue*	Step(const JsonValue* pValue, const Segment& oSegment) const;
+		bool				MatchFilter(const JsonValue& oValue, const Segment& oSegment) const;
+		bool				Walk(const JsonValue& oValue, size_t iSegment, MatchCallback pCallback, void* pUserData, int& iCount) const;
+
+		static bool			StoreFirst(const JsonValue& oValue, void* pUserData);
+	};
+
+	class JsonTape;
+
+	// Read only view on a value stored in a JsonTape, cheap to copy
+	class STTHM_API JsonTapeValue
+	{
+		friend class JsonTape;
+	public:
+		class Iterator;
+
+							JsonTapeValue();
+
+		JsonValue::EType	GetType() const;
+		int					GetMemberCount() const;
+
+		const char*			GetName() const { return m_pName; }
+
+		bool				IsValid() const		{ return m_pTape != NULL; }
+		bool				IsNull() const		{ return GetType() == JsonValue::E_TYPE_NULL; }
+		bool				IsObject() const	{ return GetType() == JsonValue::E_TYPE_OBJECT; }
+		bool				IsArray() const		{ return GetType() == JsonValue::E_TYPE_ARRAY; }
+		bool				IsString() const	{ return GetType() == JsonValue::E_TYPE_STRING; }
+		bool				IsBoolean() const	{ return GetType() == JsonValue::E_TYPE_BOOLEAN; }
+		bool				IsInteger() const	{ return GetType() == JsonValue::E_TYPE_INTEGER; }
+		bool				IsFloat() const		{ return GetType() == JsonValue::E_TYPE_FLOAT; }
+
+		bool				IsNumeric() const	{ return IsInteger() || IsFloat(); }
+		bool				IsContainer() const	{ return IsArray() || IsObject(); }
+
+		const char*			ToString() const;
+		bool				ToBoolean() const;
+		int64_t				ToInteger() const;
+		double				ToFloat() const;
+
+#ifdef STTHM_ENABLE_IMPLICIT_CAST
+							operator const char*() const;
+							operator bool() const;
+							operator int64_t() const;
+							operator double() const;
+#endif //STTHM_ENABLE_IMPLICIT_CAST
+
+		JsonTapeValue		operator [](const char* pName) const;
+		JsonTapeValue		operator [](int iIndex) const;
+	protected:
+							JsonTapeValue(const JsonTape* pTape, uint32_t iIndex, const char* pName);
+
+		const JsonTape*		m_pTape;
+		uint32_t			m_iIndex;
+		const char*			m_pName;
+	};
+
+	class STTHM_API JsonTapeValue::Iterator
+	{
+	public:
+		Iterator(const JsonTapeValue& oValue);
+		Iterator(const Iterator& oIt);
+
+		bool					IsValid() const;
+		bool					operator!=(const Iterator& oIte) const;
+		void					operator++();
+		const JsonTapeValue&	operator*() const;
+		const JsonTapeValue*	operator->() const;
+	protected:
+		void					SetChild(uint32_t iIndex);
+
+		JsonTapeValue			m_oChild;
+		bool					m_bObject;
+	};
+
+	// Read only document stored as a contiguous tape of 64 bits words and a single string buffer,
+	// more compact and cache friendly than JsonDoc but no random access to array values
+	class STTHM_API JsonTape
+	{
+		friend class JsonTapeValue;
+		friend class JsonTapeValue::Iterator;
+	public:
+							JsonTape();
+							~JsonTape();
+
+		JsonTapeValue		GetRoot() const;
+
+		void				Clear();
+
+		int					ReadString(const char* pJson);
+		int					ReadFile(const char* pFilename);
+
+		size_t				MemoryUsage() const;
+	protected:
+		// Each word is a 8 bits tag and a 56 bits payload
+		// Containers payload is the child count (24 bits, saturated) and the index following their end word (32 bits)
+		// Strings and keys payload is an offset in the string buffer
+		// Integer and float are followed by a word holding the raw value
+		enum ETag
+		{
+			E_TAG_NULL = 0,
+			E_TAG_TRUE,
+			E_TAG_FALSE,
+			E_TAG_INTEGER,
+			E_TAG_FLOAT,
+			E_TAG_STRING,
+			E_TAG_KEY,
+			E_TAG_OBJECT,
+			E_TAG_ARRAY,
+			E_TAG_END
+		};
+
+		Internal::Buffer<uint64_t, 1>	m_oTape;
+		Internal::Buffer<char, 1>		m_oStrings;
+		Allocator						m_oStringAllocator;
+
+		ETag				GetTag(uint32_t iIndex) const		{ return (ETag)(m_oTape.Data()[iIndex] >> 56); }
+		uint64_t			GetPayload(uint32_t iIndex) const	{ return m_oTape.Data()[iIndex] & 0x00FFFFFFFFFFFFFFULL; }
+		uint32_t			GetNext(uint32_t iIndex) const;
+		const char*			GetString(uint32_t iIndex) const	{ return m_oStrings.Data() + GetPayload(iIndex); }
+
+		void				PushWord(ETag eTag, uint64_t iPayload) { m_oTape.Push(((uint64_t)eTag << 56) | iPayload); }
+		bool				PushString(const char*& pString, ETag eTag);
+
+		// Recursive, nesting deeper than STTHM_MAX_DEPTH is an error
+		bool				ParseValue(const char*& pString, int iDepth);
+		bool				ParseObject(const char*& pString, int iDepth);
+		bool				ParseArray(const char*& pString, int iDepth);
+
+		static char*		AllocString(size_t iSize, void* pUserData);
+		static void			FreeString(char* pString, void* pUserData);
+	};
+
+	class JsonLazyDoc;
+
+	// Read only view on a value of a JsonLazyDoc, cheap to copy, navigation never allocates
+	class STTHM_API JsonLazyValue
+	{
+		friend class JsonLazyDoc;
+	public:
+		class Iterator;
+
+							JsonLazyValue();
+
+		JsonValue::EType	GetType() const;
+		int					GetMemberCount() const;
+
+		// Names and strings are unescaped in the document memory on each call
+		const char*			GetName() const;
+
+		bool				IsValid() const		{ return m_pDoc != NULL; }
+		bool				IsNull() const		{ return GetType() == JsonValue::E_TYPE_NULL; }
+		bool				IsObject() const	{ return GetType() == JsonValue::E_TYPE_OBJECT; }
+		bool				IsArray() const		{ return GetType() == JsonValue::E_TYPE_ARRAY; }
+		bool				IsString() const	{ return GetType() == JsonValue::E_TYPE_STRING; }
+		bool				IsBoolean() const	{ return GetType() == JsonValue::E_TYPE_BOOLEAN; }
+		bool				IsInteger() const	{ return GetType() == JsonValue::E_TYPE_INTEGER; }
+		bool				IsFloat() const		{ return GetType() == JsonValue::E_TYPE_FLOAT; }
+
+		bool				IsNumeric() const	{ return IsInteger() || IsFloat(); }
+		bool				IsContainer() const	{ return IsArray() || IsObject(); }
+
+		const char*			ToString() const;
+		bool				ToBoolean() const;
+		int64_t				ToInteger() const;
+		double				ToFloat() const;
+
+#ifdef STTHM_ENABLE_IMPLICIT_CAST
+							operator const char*() const;
+							operator bool() const;
+							operator int64_t() const;
+							operator double() const;
+#endif //STTHM_ENABLE_IMPLICIT_CAST
+
+		JsonLazyValue		operator [](const char* pName) const;
+		JsonLazyValue		operator [](int iIndex) const;
+	protected:
+							JsonLazyValue(const JsonLazyDoc* pDoc, uint32_t iIndex, uint32_t iName);
+
+		const JsonLazyDoc*	m_pDoc;
+		uint32_t			m_iIndex;	// Position of the value in the structural index
+		uint32_t			m_iName;	// Position of the member name, 0 for array values and root
+	};
+
+	class STTHM_API JsonLazyValue::Iterator
+	{
+	public:
+		Iterator(const JsonLazyValue& oValue);
+		Iterator(const Iterator& oIt);
+
+		bool					IsValid() const;
+		bool					operator!=(const Iterator& oIte) const;
+		void					operator++();
+		const JsonLazyValue&	operator*() const;
+		const JsonLazyValue*	operator->() const;
+	protected:
+		JsonLazyValue			m_oChild;
+		bool					m_bObject;
+	};
+
+	// Read only document over a raw JSON buffer, only its structure is indexed when reading,
+	// values are parsed when touched and unneeded sub trees are skipped in constant time
+	class STTHM_API JsonLazyDoc
+	{
+		friend class JsonLazyValue;
+		friend class JsonLazyValue::Iterator;
+	public:
+							JsonLazyDoc();
+							~JsonLazyDoc();
+
+		JsonLazyValue		GetRoot() const;
+
+		void				Clear();
+
+		// pJson is not copied and must outlive the document content.
+		// Only brackets nesting is checked here, malformed values read as null when touched
+		int					ReadString(const char* pJson);
+		int					ReadFile(const char* pFilename, int iFlags = JsonValue::E_READ_DEFAULT);
+
+		size_t				MemoryUsage() const;
+	protected:
+		const char*					m_pJson;
+		Internal::FileContent*		m_pFile;
+		Internal::Buffer<uint32_t>	m_oIndex;	// Offsets of structural chars, followed by a sentinel
+		Internal::Buffer<uint32_t>	m_oClose;	// For '{' and '[' entries, position of the matching close
+		mutable JsonDoc				m_oStrings;	// Unescaped names and strings
+
+		struct CachedString
+		{
+			uint32_t		m_iIndex;		// Structural index of the opening quote
+			const char*		m_pString;		// NULL for an empty slot
+		};
+		// Open addressing table, each string is unescaped once however often it is read
+		mutable Internal::Buffer<CachedString, 1>	m_oCache;
+		mutable size_t								m_iCached;
+
+		int					Read(const char* pJson, size_t iLength);
+
+		char				GetChar(uint32_t iIndex) const		{ return m_pJson[m_oIndex.Data()[iIndex]]; }
+		const char*			GetPointer(uint32_t iIndex) const	{ return m_pJson + m_oIndex.Data()[iIndex]; }
+		uint32_t			GetNext(uint32_t iIndex) const;
+		// Position of the first or following value of a container, 0 at the end, iName receives the member name
+		uint32_t			GetFirstChild(uint32_t iContainer, bool bObject, uint32_t& iName) const;
+		uint32_t			GetNextChild(uint32_t iChild, bool bObject, uint32_t& iName) const;
+		bool				MatchName(uint32_t iName, const char* pName) const;
+		const char*			UnescapeString(uint32_t iIndex) const;
+		CachedString*		FindCachedString(uint32_t iIndex) const;
+	};
+
+	// Receives JsonSax events, every callback returns what the reader should do next
+	class STTHM_API JsonSaxHandler
+	{
+	public:
+		enum EAction
+		{
+			E_ACTION_CONTINUE = 0,
+			E_ACTION_SKIP,		// From StartObject/StartArray: skip content and end event, from Key: skip member value
+			E_ACTION_STOP		// Stop reading, not considered as an error
+		};
+
+		virtual				~JsonSaxHandler() {}
+
+		// Strings are unescaped and only valid during the call
+		virtual EAction		StartObject()								{ return E_ACTION_CONTINUE; }
+		virtual EAction		Key(const char* /*pName*/, size_t /*iLength*/)	{ return E_ACTION_CONTINUE; }
+		virtual EAction		EndObject()									{ return E_ACTION_CONTINUE; }
+		virtual EAction		StartArray()								{ return E_ACTION_CONTINUE; }
+		virtual EAction		EndArray()									{ return E_ACTION_CONTINUE; }
+		virtual EAction		String(const char* /*pValue*/, size_t /*iLength*/)	{ return E_ACTION_CONTINUE; }
+		virtual EAction		Integer(int64_t /*iValue*/)					{ return E_ACTION_CONTINUE; }
+		virtual EAction		Float(double /*fValue*/)					{ return E_ACTION_CONTINUE; }
+		virtual EAction		Boolean(bool /*bValue*/)					{ return E_ACTION_CONTINUE; }
+		virtual EAction		Null()										{ return E_ACTION_CONTINUE; }
+	};
+
+	// Streaming reader sending events to a JsonSaxHandler, no value is allocated
+	class STTHM_API JsonSax
+	{
+	public:
+							JsonSax();
+
+		// Same return values as JsonValue::ReadString/ReadFile
+		int					ReadString(const char* pJson, JsonSaxHandler& oHandler);
+		int					ReadFile(const char* pFilename, JsonSaxHandler& oHandler, int iFlags = JsonValue::E_READ_DEFAULT);
+	protected:
+		Internal::CharBuffer	m_oString;
+		Allocator				m_oStringAllocator;
+		JsonSaxHandler*			m_pHandler;
+		bool					m_bStop;
+
+		bool				Continue(JsonSaxHandler::EAction eAction);
+		const char*			ReadStringValue(const char*& pString, size_t& iLength);
+
+		// Recursive, nesting deeper than STTHM_MAX_DEPTH is an error
+		bool				ParseValue(const char*& pString, int iDepth);
+		bool				ParseObject(const char*& pString, int iDepth);
+		bool				ParseArray(const char*& pString, int iDepth);
+
+		static char*		AllocString(size_t iSize, void* pUserData);
+		static void			FreeString(char* pString, void* pUserData);
+	};
+
+	// Incremental reader fed with chunks of a document, sends JsonSax events as soon as values are complete
+	class STTHM_API JsonPushReader
+	{
+	public:
+							JsonPushReader(JsonSaxHandler& oHandler);
+
+		// Forget current document and start a new one
+		void				Reset();
+
+		// Returns 0 while the document is valid so far, else the line of the error
+		int					Feed(const char* pData, size_t iLength);
+		// Signal the end of input, returns 0 when a complete document was read, else the line of the error
+		int					Finish();
+
+		bool				IsDone() const		{ return m_eState == E_STATE_DONE; }
+	protected:
+		enum EState
+		{
+			E_STATE_VALUE,			// Value expected
+			E_STATE_FIRST_KEY,		// Key or '}'
+			E_STATE_KEY,			// Key
+			E_STATE_COLON,			// ':'
+			E_STATE_OBJECT_NEXT,	// ',' or '}'
+			E_STATE_FIRST_VALUE,	// Value or ']'
+			E_STATE_ARRAY_NEXT,		// ',' or ']'
+			E_STATE_DONE,
+			E_STATE_ERROR
+		};
+
+		enum EToken
+		{
+			E_TOKEN_NONE,
+			E_TOKEN_STRING,
+			E_TOKEN_KEY,
+			E_TOKEN_SCALAR
+		};
+
+		JsonSaxHandler*			m_pHandler;
+		EState					m_eState;
+		EToken					m_eToken;
+		bool					m_bEscaped;
+		bool					m_bStarted;
+		bool					m_bStopped;		// Handler asked to stop, remaining input is ignored
+		bool					m_bSkipValue;	// Key callback asked to skip the member value
+		size_t					m_iSkipDepth;	// Containers are skipped while stack is at least this deep, 0 when not skipping
+		int						m_iLine;
+		Internal::CharBuffer	m_oToken;		// Raw string or scalar, can span several chunks
+		Internal::CharBuffer	m_oStack;		// '{' or '[' for each open container
+
+		bool				Fail();
+		bool				Send(JsonSaxHandler::EAction eAction);
+		bool				StartValue(char cChar);
+		bool				EndValue();
+		bool				EndContainer(char cOpen);
+		bool				EndString();
+		bool				EndScalar();
+	};
+
+	// Reads JSON Lines / NDJSON (one document per line), batches of lines are parsed on several threads
+	class STTHM_API JsonLinesReader
+	{
+	public:
+		// Returns false to stop reading
+		typedef bool		(*ValueCallback)(const JsonValue& oValue, void* pUserData);
+
+							// iThreadCount 0 uses all hardware threads, batches are cut at the first line end after iBatchSize bytes
+							JsonLinesReader(int iThreadCount = 0, size_t iBatchSize = 1024 * 1024);
+
+		// When bOrdered is true values are delivered one at a time in file order, up to the first invalid document.
+		// Else pCallback is called concurrently from worker threads, and values of lines after the first
+		// invalid document may still be delivered when their batch was parsed before the error was found.
+		// Returns 0 on success or when stopped, else the line of the first invalid document
+		int					ReadString(const char* pJson, ValueCallback pCallback, void* pUserData, bool bOrdered = true);
+		int					ReadFile(const char* pFilename, ValueCallback pCallback, void* pUserData, bool bOrdered = true, int iFlags = JsonValue::E_READ_DEFAULT);
+	protected:
+		struct Job;
+
+		int					m_iThreadCount;
+		size_t				m_iBatchSize;
+
+		int					Read(const char* pJson, size_t iLength, ValueCallback pCallback, void* pUserData, bool bOrdered);
+
+		static void			RunWorker(Job* pJob);
+		static bool			ParseBatch(JsonDoc& oDoc, const char* pBegin, const char* pEnd, const char*& pErrorLine);
+	};
+
+	// Pull reader over JSON text, used by typed bindings (see JsonStthmBind.h), no value is allocated.
+	// Every call fails once an error was met.
+	class STTHM_API JsonTextReader
+	{
+	public:
+							JsonTextReader(const char* pJson);
+
+		bool				HasFailed() const	{ return m_bFailed; }
+		int					GetErrorLine() const;
+
+		// Consume a null when there is one
+		bool				IsNull();
+		bool				ReadBoolean(bool& bValue);
+		// Fails when the value is out of [iMin, iMax] or is a float with a fractional part
+		bool				ReadInteger(int64_t& iValue, int64_t iMin = INT64_MIN, int64_t iMax = INT64_MAX);
+		bool				ReadFloat(double& fValue);
+		// Unescaped value, not null terminated and only valid until the next call
+		bool				ReadString(const char*& pValue, size_t& iLength);
+
+		bool				BeginObject();
+		// Returns false at the end of the object, name is not null terminated and only valid until the next call
+		bool				NextMember(const char*& pName, size_t& iLength, uint32_t& iHash);
+		bool				BeginArray();
+		// Returns false at the end of the array
+		bool				NextValue();
+		bool				SkipValue();
+	protected:
+		const char*				m_pJson;
+		const char*				m_pCursor;
+		bool					m_bFirst;	// No comma expected before next member or value
+		bool					m_bFailed;
+		Internal::CharBuffer	m_oString;
+		Allocator				m_oStringAllocator;
+
+		bool				Fail();
+		bool				ReadEscapedString(const char*& pValue, size_t& iLength);
+
+		static char*		AllocString(size_t iSize, void* pUserData);
+		static void			FreeString(char* pString, void* pUserData);
+	};
+
+	// Writes JSON text without building a tree, commas are inserted as needed.
+	// Text is appended to a growable CharBuffer, or to a bounded buffer flushed to a sink.
+	class STTHM_API JsonTextWriter
+	{
+		friend class JsonValue;
+	public:
+		// Returns false on write error
+		typedef bool		(*SinkCallback)(const char* pData, size_t iSize, void* pUserData);
+
+		// Sinks, pUserData is a FILE* or a file descriptor cast with (void*)(intptr_t)
+		static bool			FileSink(const char* pData, size_t iSize, void* pUserData);
+		static bool			FileDescriptorSink(const char* pData, size_t iSize, void* pUserData);
+
+							JsonTextWriter(Internal::CharBuffer& oOut, int iFlags = JsonValue::E_WRITE_DEFAULT);
+							// Buffer is flushed to the sink once it holds iFlushSize bytes, and on destruction
+							JsonTextWriter(SinkCallback pSink, void* pUserData, int iFlags = JsonValue::E_WRITE_DEFAULT, size_t iFlushSize = 64 * 1024);
+							~JsonTextWriter();
+
+		void				BeginObject();
+		void				EndObject();
+		void				Key(const char* pName);
+		// pKey is already quoted and followed by ':'
+		void				RawKey(const char* pKey, size_t iLength);
+		void				BeginArray();
+		void				EndArray();
+
+		void				String(const char* pValue);
+		void				Integer(int64_t iValue);
+		void				Float(double fValue);
+		void				Boolean(bool bValue);
+		void				Null();
+		// Written with an explicit stack, deep trees don't use native stack
+		void				Value(const JsonValue& oValue);
+
+		// Indentation of E_WRITE_PRETTY, cChar is '\t' or ' ', default is one tab per level
+		void				SetIndent(char cChar, size_t iWidth);
+
+		// Returns false when the sink has failed, buffered text is lost
+		bool				Flush();
+		bool				HasFailed() const { return m_bFailed; }
+	protected:
+		Internal::CharBuffer*	m_pOut;		// m_oBuffer when writing to a sink
+		Internal::CharBuffer	m_oBuffer;
+		SinkCallback			m_pSink;
+		void*					m_pSinkUserData;
+		size_t					m_iFlushSize;
+		const char*				m_pIndentTable;	// '\n' followed by indent chars
+		size_t					m_iIndentWidth;
+		size_t					m_iBaseIndent;	// Levels before the first value
+		size_t					m_iDepth;
+		bool					m_bFirst;	// No comma needed before next member or value
+		bool					m_bAfterKey;
+		bool					m_bRawUtf8;
+		bool					m_bPretty;
+		bool					m_bFailed;
+
+		void				Separate();
+		void				NewLine();
 	};
 }
 
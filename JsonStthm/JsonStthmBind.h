@@ -0,0 +1,309 @@
+#ifndef __JSON_STTHM_BIND_H__
+#define __JSON_STTHM_BIND_H__
+
+#include "JsonStthm.h"
+
+#include <limits> // numeric_limits
+#include <type_traits> // enable_if, is_integral, is_floating_point
+#include <vector>
+
+// Typed binding, structs are read straight from JSON text and written straight to a CharBuffer
+// without building a JsonValue tree.
+//
+// Fields are declared once per struct, at global scope:
+//
+//	struct Point { int64_t iX; double fY; std::vector<Point> oChilds; };
+//
+//	STTHM_BIND(Point,
+//		STTHM_BIND_FIELD(iX)
+//		STTHM_BIND_FIELD_NAMED(fY, "y")
+//		STTHM_BIND_FIELD(oChilds)
+//	)
+//
+//	Point oPoint;
+//	int iErrorLine = JsonStthm::Bind::ReadString(pJson, oPoint);
+//	JsonStthm::Bind::WriteString(oBuffer, oPoint);
+//
+// Supported members: bool, integers, floats, JsonStthmString, std::vector and bound structs.
+// Unknown members are skipped, missing and null members keep their value.
+// Integers that do not fit the member type are an error (unsigned 64 bits members stop at INT64_MAX).
+
+#define STTHM_BIND(Type, Fields) \
+	namespace JsonStthm { namespace Bind { \
+		template <> struct Binding<Type> \
+		{ \
+			typedef Type BoundType; \
+			static const bool c_bBound = true; \
+			template <typename Visitor> static void Visit(Visitor& oVisitor) { Fields } \
+		}; \
+	} }
+
+// Name hash is computed at compile time, key is quoted at compile time
+#define STTHM_BIND_FIELD_NAMED(Member, Name) \
+	if (oVisitor.template Visit<JsonStthm::Bind::HashName(Name)>(Name, "\"" Name "\":", &BoundType::Member)) return;
+
+#define STTHM_BIND_FIELD(Member) STTHM_BIND_FIELD_NAMED(Member, #Member)
+
+namespace JsonStthm
+{
+	namespace Bind
+	{
+		// FNV-1a, same hash as JsonTextReader::NextMember
+		constexpr uint32_t HashName(const char* pName, uint32_t iHash = 2166136261u)
+		{
+			return *pName == 0 ? iHash : HashName(pName + 1, (iHash ^ (uint8_t)*pName) * 16777619u);
+		}
+
+		// Specialized by STTHM_BIND
+		template <typename T>
+		struct Binding
+		{
+			static const bool c_bBound = false;
+		};
+
+		//////////////////////////////
+		// Declarations, so every overload is visible from the templates
+		//////////////////////////////
+
+		inline bool ReadValue(JsonTextReader& oReader, bool& bValue);
+		template <typename T> typename std::enable_if<std::is_integral<T>::value, bool>::type ReadValue(JsonTextReader& oReader, T& iValue);
+		template <typename T> typename std::enable_if<std::is_floating_point<T>::value, bool>::type ReadValue(JsonTextReader& oReader, T& fValue);
+#ifdef JsonStthmString
+		inline bool ReadValue(JsonTextReader& oReader, JsonStthmString& sValue);
+#endif //JsonStthmString
+		template <typename T> bool ReadValue(JsonTextReader& oReader, std::vector<T>& oValues);
+		inline bool ReadValue(JsonTextReader& oReader, std::vector<bool>& oValues);
+		template <typename T> typename std::enable_if<Binding<T>::c_bBound, bool>::type ReadValue(JsonTextReader& oReader, T& oValue);
+
+		inline void WriteValue(JsonTextWriter& oWriter, bool bValue);
+		template <typename T> typename std::enable_if<std::is_integral<T>::value>::type WriteValue(JsonTextWriter& oWriter, T iValue);
+		template <typename T> typename std::enable_if<std::is_floating_point<T>::value>::type WriteValue(JsonTextWriter& oWriter, T fValue);
+#ifdef JsonStthmString
+		inline void WriteValue(JsonTextWriter& oWriter, const JsonStthmString& sValue);
+#endif //JsonStthmString
+		template <typename T> void WriteValue(JsonTextWriter& oWriter, const std::vector<T>& oValues);
+		template <typename T> typename std::enable_if<Binding<T>::c_bBound>::type WriteValue(JsonTextWriter& oWriter, const T& oValue);
+
+		//////////////////////////////
+		// Visitors of bound fields
+		//////////////////////////////
+
+		template <typename T>
+		struct ReadVisitor
+		{
+			ReadVisitor(JsonTextReader& oReader, T& oObject)
+				: m_oReader(oReader)
+				, m_oObject(oObject)
+			{
+			}
+
+			// Returns true when the current member is this field
+			template <uint32_t Hash, size_t NameSize, size_t KeySize, typename Member>
+			bool Visit(const char (&pName)[NameSize], const char (&/*pKey*/)[KeySize], Member T::* pMember)
+			{
+				if (Hash != m_iHash || NameSize - 1 != m_iLength || memcmp(pName, m_pName, m_iLength) != 0)
+					return false;
+				m_bFound = true;
+				m_bResult = m_oReader.IsNull() || ReadValue(m_oReader, m_oObject.*pMember);
+				return true;
+			}
+
+			JsonTextReader&		m_oReader;
+			T&					m_oObject;
+			const char*			m_pName;
+			size_t				m_iLength;
+			uint32_t			m_iHash;
+			bool				m_bFound;
+			bool				m_bResult;
+		};
+
+		template <typename T>
+		struct WriteVisitor
+		{
+			WriteVisitor(JsonTextWriter& oWriter, const T& oObject)
+				: m_oWriter(oWriter)
+				, m_oObject(oObject)
+			{
+			}
+
+			template <uint32_t Hash, size_t NameSize, size_t KeySize, typename Member>
+			bool Visit(const char (&/*pName*/)[NameSize], const char (&pKey)[KeySize], Member T::* pMember)
+			{
+				m_oWriter.RawKey(pKey, KeySize - 1);
+				WriteValue(m_oWriter, m_oObject.*pMember);
+				return false;
+			}
+
+			JsonTextWriter&		m_oWriter;
+			const T&			m_oObject;
+		};
+
+		//////////////////////////////
+		// Read
+		//////////////////////////////
+
+		inline bool ReadValue(JsonTextReader& oReader, bool& bValue)
+		{
+			return oReader.ReadBoolean(bValue);
+		}
+
+		template <typename T>
+		typename std::enable_if<std::is_integral<T>::value, bool>::type ReadValue(JsonTextReader& oReader, T& iValue)
+		{
+			// Values are read as int64_t, larger unsigned types are bounded by it
+			const int64_t iMin = (int64_t)std::numeric_limits<T>::min();
+			const int64_t iMax = (uint64_t)std::numeric_limits<T>::max() > (uint64_t)INT64_MAX ? INT64_MAX : (int64_t)std::numeric_limits<T>::max();
+			int64_t iRead;
+			if (oReader.ReadInteger(iRead, iMin, iMax) == false)
+				return false;
+			iValue = (T)iRead;
+			return true;
+		}
+
+		template <typename T>
+		typename std::enable_if<std::is_floating_point<T>::value, bool>::type ReadValue(JsonTextReader& oReader, T& fValue)
+		{
+			double fRead;
+			if (oReader.ReadFloat(fRead) == false)
+				return false;
+			fValue = (T)fRead;
+			return true;
+		}
+
+#ifdef JsonStthmString
+		inline bool ReadValue(JsonTextReader& oReader, JsonStthmString& sValue)
+		{
+			const char* pValue;
+			size_t iLength;
+			if (oReader.ReadString(pValue, iLength) == false)
+				return false;
+			sValue.assign(pValue, iLength);
+			return true;
+		}
+#endif //JsonStthmString
+
+		template <typename T>
+		bool ReadValue(JsonTextReader& oReader, std::vector<T>& oValues)
+		{
+			oValues.clear();
+			if (oReader.BeginArray() == false)
+				return false;
+			while (oReader.NextValue())
+			{
+				oValues.resize(oValues.size() + 1);
+				if (oReader.IsNull() == false && ReadValue(oReader, oValues.back()) == false)
+					return false;
+			}
+			return oReader.HasFailed() == false;
+		}
+
+		inline bool ReadValue(JsonTextReader& oReader, std::vector<bool>& oValues)
+		{
+			oValues.clear();
+			if (oReader.BeginArray() == false)
+				return false;
+			while (oReader.NextValue())
+			{
+				bool bValue = false;
+				if (oReader.IsNull() == false && oReader.ReadBoolean(bValue) == false)
+					return false;
+				oValues.push_back(bValue);
+			}
+			return oReader.HasFailed() == false;
+		}
+
+		template <typename T>
+		typename std::enable_if<Binding<T>::c_bBound, bool>::type ReadValue(JsonTextReader& oReader, T& oValue)
+		{
+			if (oReader.BeginObject() == false)
+				return false;
+
+			ReadVisitor<T> oVisitor(oReader, oValue);
+			while (oReader.NextMember(oVisitor.m_pName, oVisitor.m_iLength, oVisitor.m_iHash))
+			{
+				oVisitor.m_bFound = false;
+				Binding<T>::Visit(oVisitor);
+				if (oVisitor.m_bFound == false)
+				{
+					if (oReader.SkipValue() == false)
+						return false;
+				}
+				else if (oVisitor.m_bResult == false)
+				{
+					return false;
+				}
+			}
+			return oReader.HasFailed() == false;
+		}
+
+		//////////////////////////////
+		// Write
+		//////////////////////////////
+
+		inline void WriteValue(JsonTextWriter& oWriter, bool bValue)
+		{
+			oWriter.Boolean(bValue);
+		}
+
+		template <typename T>
+		typename std::enable_if<std::is_integral<T>::value>::type WriteValue(JsonTextWriter& oWriter, T iValue)
+		{
+			oWriter.Integer((int64_t)iValue);
+		}
+
+		template <typename T>
+		typename std::enable_if<std::is_floating_point<T>::value>::type WriteValue(JsonTextWriter& oWriter, T fValue)
+		{
+			oWriter.Float((double)fValue);
+		}
+
+#ifdef JsonStthmString
+		inline void WriteValue(JsonTextWriter& oWriter, const JsonStthmString& sValue)
+		{
+			oWriter.String(sValue.c_str());
+		}
+#endif //JsonStthmString
+
+		template <typename T>
+		void WriteValue(JsonTextWriter& oWriter, const std::vector<T>& oValues)
+		{
+			oWriter.BeginArray();
+			for (typename std::vector<T>::const_iterator oIt = oValues.begin(); oIt != oValues.end(); ++oIt)
+				WriteValue(oWriter, (const T&)*oIt);
+			oWriter.EndArray();
+		}
+
+		template <typename T>
+		typename std::enable_if<Binding<T>::c_bBound>::type WriteValue(JsonTextWriter& oWriter, const T& oValue)
+		{
+			oWriter.BeginObject();
+			WriteVisitor<T> oVisitor(oWriter, oValue);
+			Binding<T>::Visit(oVisitor);
+			oWriter.EndObject();
+		}
+
+		//////////////////////////////
+		// Entry points
+		//////////////////////////////
+
+		// Returns 0 on success, -1 when pJson is NULL, else the line of the error
+		template <typename T>
+		int ReadString(const char* pJson, T& oValue)
+		{
+			JsonTextReader oReader(pJson);
+			if (ReadValue(oReader, oValue) == false)
+				return oReader.GetErrorLine();
+			return 0;
+		}
+
+		// Appends the compact JSON of oValue to sOutJson, iFlags are JsonValue::EWriteFlags
+		template <typename T>
+		void WriteString(Internal::CharBuffer& sOutJson, const T& oValue, int iFlags = JsonValue::E_WRITE_DEFAULT)
+		{
+			JsonTextWriter oWriter(sOutJson, iFlags);
+			WriteValue(oWriter, oValue);
+		}
+	}
+}
+
+#endif // __JSON_STTHM_BIND_H__
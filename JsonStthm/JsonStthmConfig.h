@@ -25,6 +25,40 @@
 
 //#define STTHM_ENABLE_IMPLICIT_CAST
 
+// Objects with more members than this get a hash index used by operator[](const char*)
+#ifndef STTHM_MEMBER_INDEX_THRESHOLD
+#define STTHM_MEMBER_INDEX_THRESHOLD 16
+#endif
+
+// Arrays with more values than this get a pointer vector used by operator[](int)
+#ifndef STTHM_ARRAY_INDEX_THRESHOLD
+#define STTHM_ARRAY_INDEX_THRESHOLD 16
+#endif
+
+// Deepest nesting of objects and arrays accepted by JsonValue, JsonDoc, JsonTape and JsonSax parsing
+#ifndef STTHM_MAX_DEPTH
+#define STTHM_MAX_DEPTH 1024
+#endif
+
+// Largest size reached by the geometric growth of JsonDoc blocks, bigger allocations get their own block
+#ifndef STTHM_DOC_MAX_BLOCK_SIZE
+#define STTHM_DOC_MAX_BLOCK_SIZE (1 << 20)
+#endif
+
+// Write floats with snprintf("%.17g") instead of the shortest round-trip representation
+//#define STTHM_WRITE_FLOAT_WITH_PRINTF
+
+// Disable SSE2/AVX2 code paths and use scalar fallbacks only
+//#define STTHM_DISABLE_SIMD
+
+// Always read files with fread instead of mapping them in memory (mmap)
+//#define STTHM_DISABLE_FILE_MAPPING
+
+// Threads used by JsonDoc with E_READ_PARALLEL_ARRAY, 0 for all hardware threads
+#ifndef STTHM_PARALLEL_THREAD_COUNT
+#define STTHM_PARALLEL_THREAD_COUNT 0
+#endif
+
 // End of configuration
 
 #endif // __JSON_STTHM_CONFIG_H__
\ No newline at end of file
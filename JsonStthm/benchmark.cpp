@@ -0,0 +1,963 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCHMARKER_USE_MACROS
+#include "../Benchmarker/Benchmarker.h"
+
+#include "JsonStthm.h"
+#include "JsonStthmBind.h"
+
+const char* const c_pBenchmarkFile = "JsonStthmBenchmark.json";
+const char* const c_pBenchmarkLinesFile = "JsonStthmBenchmark.jsonl";
+
+// Array of small objects, iCount * ~100 bytes
+bool GenerateFile(const char* pFilename, int iCount)
+{
+	FILE* pFile = fopen(pFilename, "wb");
+	if (pFile == NULL)
+		return false;
+
+	fputs("[\n", pFile);
+	for (int i = 0; i < iCount; ++i)
+	{
+		fprintf(pFile, "\t{ \"id\": %d, \"name\": \"item_%d\", \"value\": %d.%d, \"tags\": [\"a\", \"b\\n\"], \"valid\": %s }%s\n",
+			i, i, i * 7, i % 1000, (i & 1) ? "true" : "false", (i + 1 < iCount) ? "," : "");
+	}
+	fputs("]\n", pFile);
+	fclose(pFile);
+	return true;
+}
+
+// One small object per line
+bool GenerateLinesFile(const char* pFilename, int iCount)
+{
+	FILE* pFile = fopen(pFilename, "wb");
+	if (pFile == NULL)
+		return false;
+
+	for (int i = 0; i < iCount; ++i)
+	{
+		fprintf(pFile, "{ \"id\": %d, \"name\": \"item_%d\", \"value\": %d.%d, \"tags\": [\"a\", \"b\\n\"], \"valid\": %s }\n",
+			i, i, i * 7, i % 1000, (i & 1) ? "true" : "false");
+	}
+	fclose(pFile);
+	return true;
+}
+
+struct BenchmarkItem
+{
+	int64_t						iId;
+	std::string					sName;
+	double						fValue;
+	std::vector<std::string>	oTags;
+	bool						bValid;
+};
+
+STTHM_BIND(BenchmarkItem,
+	STTHM_BIND_FIELD_NAMED(iId, "id")
+	STTHM_BIND_FIELD_NAMED(sName, "name")
+	STTHM_BIND_FIELD_NAMED(fValue, "value")
+	STTHM_BIND_FIELD_NAMED(oTags, "tags")
+	STTHM_BIND_FIELD_NAMED(bValid, "valid")
+)
+
+void ReadItemsFromTree(const JsonStthm::JsonValue& oRoot, std::vector<BenchmarkItem>& oItems)
+{
+	oItems.resize(oRoot.GetMemberCount());
+	int iIndex = 0;
+	for (JsonStthm::JsonValue::Iterator oIt(&oRoot); oIt.IsValid(); ++oIt, ++iIndex)
+	{
+		BenchmarkItem& oItem = oItems[iIndex];
+		oItem.iId = (*oIt)["id"].ToInteger();
+		oItem.sName = (*oIt)["name"].ToString();
+		oItem.fValue = (*oIt)["value"].ToFloat();
+		oItem.bValid = (*oIt)["valid"].ToBoolean();
+		oItem.oTags.clear();
+		for (JsonStthm::JsonValue::Iterator oTag(&(*oIt)["tags"]); oTag.IsValid(); ++oTag)
+			oItem.oTags.push_back(oTag->ToString());
+	}
+}
+
+// Allocator written before AllocMemory and FreeMemory existed, used through a derived value
+JsonStthm::JsonValue* LegacyCreateJsonValue(JsonStthm::Allocator* pAllocator, void* pUserData);
+void LegacyDeleteJsonValue(JsonStthm::JsonValue* pValue, void* pUserData);
+char* LegacyAllocString(size_t iSize, void* /*pUserData*/) { return (char*)malloc(iSize); }
+void LegacyFreeString(char* pString, void* /*pUserData*/) { free(pString); }
+
+JsonStthm::Allocator g_oLegacyAllocator = { LegacyCreateJsonValue, LegacyDeleteJsonValue, LegacyAllocString, LegacyFreeString, NULL };
+
+struct LegacyJsonValue : public JsonStthm::JsonValue
+{
+	LegacyJsonValue() : JsonValue(&g_oLegacyAllocator) {}
+};
+
+JsonStthm::JsonValue* LegacyCreateJsonValue(JsonStthm::Allocator* /*pAllocator*/, void* /*pUserData*/) { return new LegacyJsonValue(); }
+void LegacyDeleteJsonValue(JsonStthm::JsonValue* pValue, void* /*pUserData*/) { delete (LegacyJsonValue*)pValue; }
+
+JsonStthm::JsonValue* BaselineCreateJsonValue(JsonStthm::Allocator* pAllocator, void* pUserData);
+void BaselineDeleteJsonValue(JsonStthm::JsonValue* pValue, void* pUserData);
+void* BaselineAllocMemory(size_t iSize, void* /*pUserData*/) { return malloc(iSize); }
+void BaselineFreeMemory(void* pMemory, void* /*pUserData*/) { free(pMemory); }
+
+JsonStthm::Allocator g_oBaselineAllocator = { BaselineCreateJsonValue, BaselineDeleteJsonValue, LegacyAllocString, LegacyFreeString, NULL, BaselineAllocMemory, BaselineFreeMemory };
+
+// Recursive parser replaced by the iterative JsonValue::Parse, same building steps with the native stack instead of a parent stack.
+// All values are BaselineJsonValue so childs can recurse.
+struct BaselineJsonValue : public JsonStthm::JsonValue
+{
+	BaselineJsonValue() : JsonValue(&g_oBaselineAllocator) {}
+
+	using JsonValue::Parse;
+
+	static void SkipSpaces(const char*& pString)
+	{
+		while (*pString == ' ' || (*pString >= '\t' && *pString <= '\r'))
+			++pString;
+	}
+
+	bool ParseRecursive(const char*& pString)
+	{
+		SkipSpaces(pString);
+		const char cChar = *pString;
+		if (cChar != '{' && cChar != '[')
+			return ParseLeaf(pString, false);
+
+		// '{' + 2 == '}', '[' + 2 == ']'
+		++pString;
+		InitType(cChar == '{' ? E_TYPE_OBJECT : E_TYPE_ARRAY);
+		SkipSpaces(pString);
+		if (*pString != cChar + 2)
+		{
+			for (;;)
+			{
+				BaselineJsonValue* pChild = (BaselineJsonValue*)ParseNewChild(pString, false);
+				if (pChild == NULL || pChild->ParseRecursive(pString) == false)
+					return false;
+
+				SkipSpaces(pString);
+				if (*pString == cChar + 2)
+					break;
+				if (*pString != ',')
+					return false;
+				++pString;
+			}
+		}
+		++pString;
+
+		if (m_eType == E_TYPE_OBJECT && m_iChildCount > STTHM_MEMBER_INDEX_THRESHOLD)
+			BuildMemberIndex();
+		else if (m_eType == E_TYPE_ARRAY && m_iChildCount > STTHM_ARRAY_INDEX_THRESHOLD)
+			BuildChildArray();
+		return true;
+	}
+};
+
+JsonStthm::JsonValue* BaselineCreateJsonValue(JsonStthm::Allocator* /*pAllocator*/, void* /*pUserData*/) { return new BaselineJsonValue(); }
+void BaselineDeleteJsonValue(JsonStthm::JsonValue* pValue, void* /*pUserData*/) { delete (BaselineJsonValue*)pValue; }
+
+// Parse a single float and compare its bits, so -0.0 and rounding are checked exactly
+bool ReadsAsFloat(const char* pJson, double fExpected)
+{
+	JsonStthm::JsonValue oValue;
+	if (oValue.ReadString(pJson) != 0 || oValue.IsFloat() == false)
+		return false;
+	double fValue = oValue.ToFloat();
+	return memcmp(&fValue, &fExpected, sizeof(double)) == 0;
+}
+
+// Logs JsonSax events in a string, can skip an object, a member or stop after some events
+class RecordingHandler : public JsonStthm::JsonSaxHandler
+{
+public:
+	std::string		m_sEvents;
+	std::string		m_sSkipKey;
+	int				m_iSkipObject = -1;	// Index of the StartObject event returning E_ACTION_SKIP
+	int				m_iStopAfter = -1;	// Event count before returning E_ACTION_STOP
+
+	virtual EAction	StartObject()								{ return Record("{", m_iObjects++ == m_iSkipObject); }
+	virtual EAction	Key(const char* pName, size_t iLength)		{ return Record(std::string("k:") + std::string(pName, iLength), m_sSkipKey == pName); }
+	virtual EAction	EndObject()									{ return Record("}"); }
+	virtual EAction	StartArray()								{ return Record("["); }
+	virtual EAction	EndArray()									{ return Record("]"); }
+	virtual EAction	String(const char* pValue, size_t iLength)	{ return Record(std::string("s:") + std::string(pValue, iLength)); }
+	virtual EAction	Integer(int64_t iValue)						{ return Record("i:" + std::to_string(iValue)); }
+	virtual EAction	Float(double fValue)						{ return Record("f:" + std::to_string(fValue)); }
+	virtual EAction	Boolean(bool bValue)						{ return Record(bValue ? "true" : "false"); }
+	virtual EAction	Null()										{ return Record("null"); }
+protected:
+	int				m_iObjects = 0;
+	int				m_iEvents = 0;
+
+	EAction			Record(const std::string& sEvent, bool bSkip = false)
+	{
+		m_sEvents.append(m_sEvents.empty() ? "" : " ").append(sEvent);
+		if (++m_iEvents == m_iStopAfter)
+			return E_ACTION_STOP;
+		return bSkip ? E_ACTION_SKIP : E_ACTION_CONTINUE;
+	}
+};
+
+// Appends written chunks, fails from the iFailAt-th call when set
+struct SinkState
+{
+	std::string		sOut;
+	int				iCalls;
+	int				iFailAt;
+};
+
+bool AppendSink(const char* pData, size_t iSize, void* pUserData)
+{
+	SinkState* pState = (SinkState*)pUserData;
+	if (++pState->iCalls == pState->iFailAt)
+		return false;
+	pState->sOut.append(pData, iSize);
+	return true;
+}
+
+// Pretty text of iDepth nested arrays around 1
+std::string NestedPretty(int iDepth, char cChar, size_t iWidth)
+{
+	std::string sOut;
+	for (int i = 1; i <= iDepth; ++i)
+		sOut.append("[\n").append(i * iWidth, cChar);
+	sOut.append("1");
+	for (int i = iDepth - 1; i >= 0; --i)
+		sOut.append("\n").append(i * iWidth, cChar).append("]");
+	return sOut;
+}
+
+std::string WritePretty(const JsonStthm::JsonValue& oValue, char cChar, size_t iWidth)
+{
+	JsonStthm::Internal::CharBuffer oOut;
+	JsonStthm::JsonTextWriter oWriter(oOut, JsonStthm::JsonValue::E_WRITE_PRETTY);
+	oWriter.SetIndent(cChar, iWidth);
+	oWriter.Value(oValue);
+	oWriter.Flush();
+	return std::string(oOut.Data(), oOut.Size());
+}
+
+bool CountLine(const JsonStthm::JsonValue& oValue, void* pUserData)
+{
+	if (oValue.IsObject())
+		++*(int*)pUserData;
+	return true;
+}
+
+int main()
+{
+	if (GenerateFile(c_pBenchmarkFile, 500000) == false)
+		return 1;
+	if (GenerateLinesFile(c_pBenchmarkLinesFile, 500000) == false)
+		return 1;
+
+	BEGIN_TEST_SUITE("ReadFile")
+		JsonStthm::JsonValue oMapped;
+		JsonStthm::JsonValue oRead;
+		CHECK_FATAL(oMapped.ReadFile(c_pBenchmarkFile) == 0)
+		CHECK_FATAL(oRead.ReadFile(c_pBenchmarkFile, JsonStthm::JsonValue::E_READ_NO_FILE_MAPPING) == 0)
+		CHECK(oMapped == oRead)
+		CHECK(oMapped.GetMemberCount() == 500000)
+	END_TEST_SUITE()
+
+	BEGIN_BENCHMARK_VERSUS("JsonDoc::ReadFile")
+		BEGIN_BENCHMARK_VERSUS_CHALLENGER("fread")
+			JsonStthm::JsonDoc oDoc;
+			oDoc.ReadFile(c_pBenchmarkFile, JsonStthm::JsonValue::E_READ_NO_FILE_MAPPING);
+		END_BENCHMARK_VERSUS_CHALLENGER()
+
+		BEGIN_BENCHMARK_VERSUS_CHALLENGER("mmap")
+			JsonStthm::JsonDoc oDoc;
+			oDoc.ReadFile(c_pBenchmarkFile);
+		END_BENCHMARK_VERSUS_CHALLENGER()
+	END_BENCHMARK_VERSUS()
+
+	BEGIN_TEST_SUITE("Numbers")
+		JsonStthm::JsonValue oValue;
+		CHECK(oValue.ReadString("9007199254740993") == 0 && oValue.IsInteger() && oValue.ToInteger() == 9007199254740993LL)
+		CHECK(ReadsAsFloat("9007199254740993.0", 9007199254740992.0))
+		CHECK(ReadsAsFloat("2.2250738585072011e-308", 2.2250738585072011e-308))
+		CHECK(ReadsAsFloat("1e23", 1e23))
+		CHECK(ReadsAsFloat("1e2", 100.0))
+		CHECK(ReadsAsFloat("18446744073709551616", 18446744073709551616.0))
+		CHECK(ReadsAsFloat("-0", -0.0))
+		CHECK(oValue.ReadString("0") == 0 && oValue.IsInteger() && oValue.ToInteger() == 0)
+		CHECK(oValue.ReadString("1e") == 1)
+		CHECK(oValue.ReadString("1e+") == 1)
+		CHECK(oValue.ReadString("1.") == 1)
+		CHECK(oValue.ReadString("-") == 1)
+		CHECK(oValue.ReadString(".5") == 1)
+	END_TEST_SUITE()
+
+	BEGIN_TEST_SUITE("Float round trip")
+		const double c_pFloats[] = { 5e-324, 1.7976931348623157e308, 0.1, -0.0, 1e21 };
+		for (size_t i = 0; i < sizeof(c_pFloats) / sizeof(c_pFloats[0]); ++i)
+		{
+			std::string sFloat;
+			JsonStthm::JsonValue(c_pFloats[i]).WriteString(sFloat, true);
+			CHECK(ReadsAsFloat(sFloat.c_str(), c_pFloats[i]))
+		}
+#ifndef STTHM_WRITE_FLOAT_WITH_PRINTF
+		// Shortest representation
+		std::string sShortest;
+		JsonStthm::JsonValue(0.1).WriteString(sShortest, true);
+		CHECK(sShortest == "0.1")
+		JsonStthm::JsonValue(1e21).WriteString(sShortest, true);
+		CHECK(sShortest == "1e21")
+		JsonStthm::JsonValue(-0.0).WriteString(sShortest, true);
+		CHECK(sShortest == "-0.0")
+#endif //STTHM_WRITE_FLOAT_WITH_PRINTF
+	END_TEST_SUITE()
+
+	BEGIN_TEST_SUITE("Legacy allocator")
+		// No AllocMemory, members and items are found by walking the children
+		std::string sMembers = "{";
+		for (int i = 0; i < 100; ++i)
+			sMembers.append(i > 0 ? ",\"m" : "\"m").append(std::to_string(i)).append("\":[1,2,3]");
+		sMembers.append("}");
+		LegacyJsonValue oValue;
+		CHECK(g_oLegacyAllocator.AllocMemory == NULL && g_oLegacyAllocator.FreeMemory == NULL)
+		CHECK_FATAL(oValue.ReadString(sMembers.c_str()) == 0)
+		const JsonStthm::JsonValue& oConstValue = oValue;
+		CHECK(oValue.GetMemberCount() == 100 && oConstValue["m73"][2].ToInteger() == 3 && oConstValue["m100"].IsValid() == false)
+		oValue["m100"] = (int64_t)5;
+		CHECK(oValue.GetMemberCount() == 101 && oConstValue["m100"].ToInteger() == 5)
+	END_TEST_SUITE()
+
+	{
+		JsonStthm::JsonDoc oDoc;
+		oDoc.ReadFile(c_pBenchmarkFile);
+
+		BEGIN_TEST_SUITE("JsonTextWriter sink")
+			std::string sExpected;
+			oDoc.GetRoot().WriteString(sExpected, true);
+			SinkState oState = { std::string(), 0, 0 };
+			{
+				JsonStthm::JsonTextWriter oWriter(AppendSink, &oState, JsonStthm::JsonValue::E_WRITE_DEFAULT, 256);
+				oWriter.Value(oDoc.GetRoot());
+				CHECK(oWriter.Flush())
+			}
+			CHECK(oState.iCalls > 1000 && oState.sOut == sExpected)
+
+			// Failing sink, nothing is sent afterwards
+			SinkState oFailing = { std::string(), 0, 3 };
+			JsonStthm::JsonTextWriter oWriter(AppendSink, &oFailing, JsonStthm::JsonValue::E_WRITE_DEFAULT, 256);
+			oWriter.Value(oDoc.GetRoot());
+			CHECK(oWriter.Flush() == false && oWriter.HasFailed() && oFailing.iCalls == 3)
+		END_TEST_SUITE()
+
+		BEGIN_TEST_SUITE("JsonTextWriter indent")
+			// One level deeper than the 128 chars indent table, indents are written in several slices
+			const int c_iDepth = 129;
+			std::string sNested = NestedPretty(c_iDepth, '\t', 1);
+			JsonStthm::JsonValue oNested;
+			CHECK_FATAL(oNested.ReadString(sNested.c_str()) == 0)
+			CHECK(WritePretty(oNested, '\t', 1) == sNested)
+			CHECK(WritePretty(oNested, ' ', 2) == NestedPretty(c_iDepth, ' ', 2))
+			CHECK(WritePretty(oNested, ' ', 0) == NestedPretty(c_iDepth, ' ', 0))
+
+			JsonStthm::JsonValue oSmall;
+			CHECK_FATAL(oSmall.ReadString("{\"a\":[1,true],\"b\":{\"c\":null}}") == 0)
+			CHECK(WritePretty(oSmall, ' ', 2) == "{\n  \"a\": [\n    1,\n    true\n  ],\n  \"b\": {\n    \"c\": null\n  }\n}")
+
+			// Default is one tab per level, as JsonValue::Write
+			std::string sDefault;
+			oSmall.WriteString(sDefault, false);
+			CHECK(WritePretty(oSmall, '\t', 1) == sDefault)
+		END_TEST_SUITE()
+
+		BEGIN_BENCHMARK_VERSUS("JsonValue::Write")
+			BEGIN_BENCHMARK_VERSUS_CHALLENGER("compact")
+				JsonStthm::Internal::CharBuffer oOut;
+				oDoc.GetRoot().Write(oOut, 0, true);
+			END_BENCHMARK_VERSUS_CHALLENGER()
+
+			BEGIN_BENCHMARK_VERSUS_CHALLENGER("pretty")
+				JsonStthm::Internal::CharBuffer oOut;
+				oDoc.GetRoot().Write(oOut, 0, false);
+			END_BENCHMARK_VERSUS_CHALLENGER()
+		END_BENCHMARK_VERSUS()
+	}
+
+	{
+		// Requests of ~1MB parsed one after the other
+		std::string sRequest = "[";
+		for (int i = 0; i < 20000; ++i)
+		{
+			char pItem[128];
+			snprintf(pItem, sizeof(pItem), "%s{ \"id\": %d, \"name\": \"item_%d\", \"tags\": [\"a\", \"b\"] }", (i > 0) ? "," : "", i, i);
+			sRequest.append(pItem);
+		}
+		sRequest.append("]");
+
+		JsonStthm::JsonDoc oLargest;
+		oLargest.SetRetainMode(JsonStthm::JsonDoc::E_RETAIN_LARGEST_BLOCK);
+		JsonStthm::JsonDoc oHighWater;
+		oHighWater.SetRetainMode(JsonStthm::JsonDoc::E_RETAIN_HIGH_WATER, 16 << 20);
+
+		BEGIN_TEST_SUITE("JsonDoc retained blocks")
+			JsonStthm::JsonDoc::MemoryStats oStats;
+			CHECK(oHighWater.ReadString(sRequest.c_str()) == 0)
+			oHighWater.GetMemoryStats(oStats);
+			CHECK(oStats.m_iReserved == oHighWater.MemoryUsage() && oStats.m_iUsed + oStats.m_iWasted <= oStats.m_iReserved)
+			const size_t iReserved = oStats.m_iReserved;
+			oHighWater.Clear();
+			oHighWater.GetMemoryStats(oStats);
+			CHECK(oStats.m_iUsed == 0 && oStats.m_iRetained == iReserved && oStats.m_iPeak == iReserved)
+			// Blocks are taken largest first, a second parse can need one more block, then usage is stable
+			CHECK(oHighWater.ReadString(sRequest.c_str()) == 0 && oHighWater.MemoryUsage() >= iReserved)
+			const size_t iStableReserved = oHighWater.MemoryUsage();
+			CHECK(oHighWater.ReadString(sRequest.c_str()) == 0 && oHighWater.MemoryUsage() == iStableReserved)
+			CHECK(oHighWater.GetRoot()[19999]["name"] == JsonStthm::JsonValue("item_19999"))
+		END_TEST_SUITE()
+
+		BEGIN_BENCHMARK_VERSUS("JsonDoc reuse, 20 requests")
+			BEGIN_BENCHMARK_VERSUS_CHALLENGER("new JsonDoc per request")
+				for (int i = 0; i < 20; ++i)
+				{
+					JsonStthm::JsonDoc oDoc;
+					oDoc.ReadString(sRequest.c_str());
+				}
+			END_BENCHMARK_VERSUS_CHALLENGER()
+
+			BEGIN_BENCHMARK_VERSUS_CHALLENGER("E_RETAIN_LARGEST_BLOCK")
+				for (int i = 0; i < 20; ++i)
+					oLargest.ReadString(sRequest.c_str());
+			END_BENCHMARK_VERSUS_CHALLENGER()
+
+			BEGIN_BENCHMARK_VERSUS_CHALLENGER("E_RETAIN_HIGH_WATER 16MB")
+				for (int i = 0; i < 20; ++i)
+					oHighWater.ReadString(sRequest.c_str());
+			END_BENCHMARK_VERSUS_CHALLENGER()
+		END_BENCHMARK_VERSUS()
+	}
+
+	BEGIN_TEST_SUITE("JsonDoc edits and Compact")
+		JsonStthm::JsonDoc oDoc;
+		JsonStthm::JsonValue oValue;
+		CHECK_FATAL(oDoc.ReadFile(c_pBenchmarkFile) == 0 && oValue.ReadFile(c_pBenchmarkFile) == 0)
+		for (int i = 0; i < 1000; ++i)
+		{
+			oDoc.GetMutableRoot()[i]["name"] = "patched";
+			oValue[i]["name"] = "patched";
+		}
+		CHECK(oDoc.GetMutableRoot().Remove(4242) && oValue.Remove(4242))
+		CHECK(oDoc.GetMutableRoot()[0].Remove("tags") && oValue[0].Remove("tags"))
+		oDoc.GetMutableRoot().Append()["id"] = (int64_t)500000;
+		oValue.Append()["id"] = (int64_t)500000;
+		CHECK(oDoc.GetRoot() == oValue)
+
+		JsonStthm::JsonDoc::MemoryStats oStats;
+		oDoc.GetMemoryStats(oStats);
+		CHECK(oStats.m_iDead > 0)
+		const size_t iEdited = oDoc.MemoryUsage();
+		oDoc.Compact();
+		oDoc.GetMemoryStats(oStats);
+		CHECK(oStats.m_iDead == 0 && oDoc.MemoryUsage() < iEdited && oDoc.GetRoot() == oValue)
+	END_TEST_SUITE()
+
+	BEGIN_TEST_SUITE("JsonDoc::ReadInSitu")
+		const char* const c_pEscaped = "{\"plain\":\"abc\",\"na\\tme\":\"l\\u00e9\\\"t\\\\\",\"list\":[\"\\ud83d\\ude00\",\"\\/x\\n\"]}";
+		std::string sBuffer = c_pEscaped;
+		JsonStthm::JsonDoc oInSitu;
+		JsonStthm::JsonValue oCopy;
+		CHECK_FATAL(oInSitu.ReadInSitu(&sBuffer[0], sBuffer.size()) == 0 && oCopy.ReadString(c_pEscaped) == 0)
+		const JsonStthm::JsonValue& oRoot = oInSitu.GetRoot();
+		CHECK(oRoot == oCopy && strcmp(oRoot["plain"].ToString(), "abc") == 0)
+		CHECK(strcmp(oRoot["na\tme"].ToString(), "l\xC3\xA9\"t\\") == 0)
+		CHECK(strcmp(oRoot["list"][0].ToString(), "\xF0\x9F\x98\x80") == 0 && strcmp(oRoot["list"][1].ToString(), "/x\n") == 0)
+		CHECK(oRoot["plain"].ToString() >= sBuffer.data() && oRoot["plain"].ToString() < sBuffer.data() + sBuffer.size())
+
+		// Compact copies the strings out of the source buffer
+		oInSitu.Compact();
+		sBuffer.assign(sBuffer.size(), 'x');
+		CHECK(oInSitu.GetRoot() == oCopy)
+	END_TEST_SUITE()
+
+	BEGIN_BENCHMARK_VERSUS("Load, patch and write")
+		BEGIN_BENCHMARK_VERSUS_CHALLENGER("JsonValue")
+			JsonStthm::JsonValue oValue;
+			oValue.ReadFile(c_pBenchmarkFile);
+			oValue[1234]["name"] = "patched";
+			oValue.Remove(4242);
+			JsonStthm::Internal::CharBuffer oOut;
+			oValue.Write(oOut, 0, true);
+		END_BENCHMARK_VERSUS_CHALLENGER()
+
+		BEGIN_BENCHMARK_VERSUS_CHALLENGER("JsonDoc")
+			JsonStthm::JsonDoc oDoc;
+			oDoc.ReadFile(c_pBenchmarkFile);
+			oDoc.GetMutableRoot()[1234]["name"] = "patched";
+			oDoc.GetMutableRoot().Remove(4242);
+			JsonStthm::Internal::CharBuffer oOut;
+			oDoc.GetRoot().Write(oOut, 0, true);
+		END_BENCHMARK_VERSUS_CHALLENGER()
+	END_BENCHMARK_VERSUS()
+
+	BEGIN_TEST_SUITE("JsonLazyDoc")
+		JsonStthm::JsonDoc oFull;
+		JsonStthm::JsonLazyDoc oLazy;
+		CHECK_FATAL(oFull.ReadFile(c_pBenchmarkFile) == 0)
+		CHECK_FATAL(oLazy.ReadFile(c_pBenchmarkFile) == 0)
+		CHECK(oLazy.GetRoot()[123456]["id"].ToInteger() == oFull.GetRoot()[123456]["id"].ToInteger())
+		CHECK(strcmp(oLazy.GetRoot()[42]["name"].ToString(), oFull.GetRoot()[42]["name"].ToString()) == 0)
+
+		// Strings are unescaped once
+		const size_t iMemory = oLazy.MemoryUsage();
+		CHECK(oLazy.GetRoot()[42]["name"].ToString() == oLazy.GetRoot()[42]["name"].ToString() && oLazy.MemoryUsage() == iMemory)
+		int iMismatches = 0;
+		for (int i = 0; i < 1000; ++i)
+		{
+			JsonStthm::JsonLazyValue oTag = oLazy.GetRoot()[i]["tags"][1];
+			if (strcmp(oTag.ToString(), "b\n") != 0 || strcmp(oLazy.GetRoot()[i]["name"].ToString(), oFull.GetRoot()[i]["name"].ToString()) != 0)
+				++iMismatches;
+		}
+		CHECK(iMismatches == 0 && strcmp(oLazy.GetRoot()[42]["name"].ToString(), "item_42") == 0)
+	END_TEST_SUITE()
+
+	BEGIN_BENCHMARK_VERSUS("Read a few fields")
+		BEGIN_BENCHMARK_VERSUS_CHALLENGER("JsonDoc")
+			JsonStthm::JsonDoc oDoc;
+			oDoc.ReadFile(c_pBenchmarkFile);
+			int64_t iId = oDoc.GetRoot()[123456]["id"].ToInteger() + oDoc.GetRoot()[400000]["id"].ToInteger();
+			(void)iId;
+		END_BENCHMARK_VERSUS_CHALLENGER()
+
+		BEGIN_BENCHMARK_VERSUS_CHALLENGER("JsonLazyDoc")
+			JsonStthm::JsonLazyDoc oDoc;
+			oDoc.ReadFile(c_pBenchmarkFile);
+			int64_t iId = oDoc.GetRoot()[123456]["id"].ToInteger() + oDoc.GetRoot()[400000]["id"].ToInteger();
+			(void)iId;
+		END_BENCHMARK_VERSUS_CHALLENGER()
+	END_BENCHMARK_VERSUS()
+
+	BEGIN_TEST_SUITE("JsonTape")
+		JsonStthm::JsonDoc oFull;
+		JsonStthm::JsonTape oTape;
+		CHECK_FATAL(oFull.ReadFile(c_pBenchmarkFile) == 0)
+		CHECK_FATAL(oTape.ReadFile(c_pBenchmarkFile) == 0)
+		CHECK(oTape.GetRoot().IsArray() && oTape.GetRoot().GetMemberCount() == 500000)
+
+		// Same items in the same order as the tree
+		int iMismatches = 0;
+		JsonStthm::JsonValue::Iterator oFullIt(&oFull.GetRoot());
+		for (JsonStthm::JsonTapeValue::Iterator oIt(oTape.GetRoot()); oIt.IsValid(); ++oIt, ++oFullIt)
+		{
+			const JsonStthm::JsonTapeValue oTags = (*oIt)["tags"];
+			if (oFullIt.IsValid() == false || oIt->GetMemberCount() != 5
+				|| (*oIt)["id"].ToInteger() != (*oFullIt)["id"].ToInteger()
+				|| strcmp((*oIt)["name"].ToString(), (*oFullIt)["name"].ToString()) != 0
+				|| (*oIt)["value"].ToFloat() != (*oFullIt)["value"].ToFloat()
+				|| (*oIt)["valid"].ToBoolean() != (*oFullIt)["valid"].ToBoolean()
+				|| oTags.GetMemberCount() != 2 || strcmp(oTags[1].ToString(), "b\n") != 0)
+				++iMismatches;
+		}
+		CHECK(iMismatches == 0 && oFullIt.IsValid() == false)
+
+		// Numbers are only read from number tags
+		CHECK_FATAL(oTape.ReadString("{\"i\":-7,\"f\":2.5,\"s\":\"x\",\"n\":null,\"o\":{},\"a\":[true]}") == 0)
+		JsonStthm::JsonTapeValue oRoot = oTape.GetRoot();
+		CHECK(oRoot["i"].IsInteger() && oRoot["i"].ToInteger() == -7 && oRoot["i"].ToFloat() == -7.0)
+		CHECK(oRoot["f"].IsFloat() && oRoot["f"].ToFloat() == 2.5 && oRoot["f"].ToInteger() == 2)
+		CHECK(oRoot["s"].ToInteger() == 0 && oRoot["n"].ToFloat() == 0.0 && oRoot["o"].ToInteger() == 0 && oRoot["a"][0].ToFloat() == 0.0)
+		CHECK(oRoot["n"].IsNull() && oRoot["o"].GetMemberCount() == 0 && oRoot["a"][0].ToBoolean() && oRoot["missing"].IsValid() == false)
+	END_TEST_SUITE()
+
+	BEGIN_TEST_SUITE("JsonPathSet")
+		JsonStthm::JsonPathSet oPaths;
+		CHECK_FATAL(oPaths.Add("/*/id"))
+		JsonStthm::JsonDoc oFull;
+		JsonStthm::JsonDoc oProjected;
+		CHECK_FATAL(oFull.ReadFile(c_pBenchmarkFile) == 0)
+		CHECK_FATAL(oProjected.ReadFile(c_pBenchmarkFile, oPaths) == 0)
+		CHECK(oProjected.GetRoot()[4242]["id"].ToInteger() == oFull.GetRoot()[4242]["id"].ToInteger())
+		CHECK(oProjected.GetRoot()[4242]["name"].IsValid() == false)
+		CHECK(oProjected.MemoryUsage() * 3 < oFull.MemoryUsage())
+	END_TEST_SUITE()
+
+	BEGIN_BENCHMARK_VERSUS("JsonDoc::ReadFile projection")
+		BEGIN_BENCHMARK_VERSUS_CHALLENGER("all values")
+			JsonStthm::JsonDoc oDoc;
+			oDoc.ReadFile(c_pBenchmarkFile);
+		END_BENCHMARK_VERSUS_CHALLENGER()
+
+		BEGIN_BENCHMARK_VERSUS_CHALLENGER("/*/id")
+			JsonStthm::JsonPathSet oPaths;
+			oPaths.Add("/*/id");
+			JsonStthm::JsonDoc oDoc;
+			oDoc.ReadFile(c_pBenchmarkFile, oPaths);
+		END_BENCHMARK_VERSUS_CHALLENGER()
+	END_BENCHMARK_VERSUS()
+
+	{
+		JsonStthm::JsonDoc oDoc;
+		oDoc.ReadFile(c_pBenchmarkFile);
+		const JsonStthm::JsonValue& oRoot = oDoc.GetRoot();
+		const int iCount = oRoot.GetMemberCount();
+		const JsonStthm::JsonValue** pItems = new const JsonStthm::JsonValue*[iCount];
+		const JsonStthm::JsonValue** pResults = new const JsonStthm::JsonValue*[iCount];
+		// Items visited out of memory order, like documents gathered from several sources, so lookups miss the cache
+		for (int i = 0; i < iCount; ++i)
+			pItems[i] = &oRoot[(int)((int64_t)i * 7919 % iCount)];
+		JsonStthm::JsonPath oPath("/tags/1");
+
+		BEGIN_TEST_SUITE("JsonPath")
+			CHECK(&oPath.Find(*pItems[42]) == &(*pItems[42])["tags"][1])
+			oPath.FindBatch(pItems, iCount, pResults);
+			CHECK(pResults[iCount - 1] == &(*pItems[iCount - 1])["tags"][1])
+		END_TEST_SUITE()
+
+		BEGIN_BENCHMARK_VERSUS("Find /tags/1 in scattered items")
+			BEGIN_BENCHMARK_VERSUS_CHALLENGER("operator[]")
+				for (int i = 0; i < iCount; ++i)
+					pResults[i] = &(*pItems[i])["tags"][1];
+			END_BENCHMARK_VERSUS_CHALLENGER()
+
+			BEGIN_BENCHMARK_VERSUS_CHALLENGER("JsonPath::Find")
+				for (int i = 0; i < iCount; ++i)
+					pResults[i] = &oPath.Find(*pItems[i]);
+			END_BENCHMARK_VERSUS_CHALLENGER()
+
+			BEGIN_BENCHMARK_VERSUS_CHALLENGER("JsonPath::FindBatch")
+				oPath.FindBatch(pItems, iCount, pResults);
+			END_BENCHMARK_VERSUS_CHALLENGER()
+		END_BENCHMARK_VERSUS()
+
+		delete[] pItems;
+		delete[] pResults;
+	}
+
+	{
+		JsonStthm::Internal::CharBuffer oContent;
+		FILE* pFile = fopen(c_pBenchmarkFile, "rb");
+		char pChunk[4096];
+		size_t iRead;
+		while (pFile != NULL && (iRead = fread(pChunk, 1, sizeof(pChunk), pFile)) > 0)
+			oContent.PushRange(pChunk, iRead);
+		if (pFile != NULL)
+			fclose(pFile);
+		oContent.Push('\0');
+
+		std::vector<BenchmarkItem> oBound;
+		std::vector<BenchmarkItem> oCopied;
+		BEGIN_TEST_SUITE("JsonStthmBind")
+			JsonStthm::JsonDoc oDoc;
+			CHECK_FATAL(JsonStthm::Bind::ReadString(oContent.Data(), oBound) == 0)
+			CHECK_FATAL(oDoc.ReadString(oContent.Data()) == 0)
+			ReadItemsFromTree(oDoc.GetRoot(), oCopied);
+			CHECK(oBound.size() == oCopied.size())
+			CHECK(oBound[4242].sName == oCopied[4242].sName && oBound[4242].oTags == oCopied[4242].oTags && oBound[4242].fValue == oCopied[4242].fValue)
+
+			JsonStthm::Internal::CharBuffer oOut;
+			JsonStthm::Bind::WriteString(oOut, oBound);
+			oOut.Push('\0');
+			JsonStthm::JsonValue oWritten;
+			CHECK(oWritten.ReadString(oOut.Data()) == 0 && oWritten == oDoc.GetRoot())
+
+			std::vector<uint8_t> oBytes;
+			CHECK(JsonStthm::Bind::ReadString("[1,\n255]", oBytes) == 0 && JsonStthm::Bind::ReadString("[1,\n300]", oBytes) == 2)
+			CHECK(JsonStthm::Bind::ReadString("[2.0,\n1e2]", oBytes) == 0 && oBytes.size() == 2 && oBytes[1] == 100)
+			CHECK(JsonStthm::Bind::ReadString("[1,\n1.5]", oBytes) == 2)
+		END_TEST_SUITE()
+
+		BEGIN_BENCHMARK_VERSUS("Read structs")
+			BEGIN_BENCHMARK_VERSUS_CHALLENGER("JsonDoc then copy")
+				JsonStthm::JsonDoc oDoc;
+				oDoc.ReadString(oContent.Data());
+				ReadItemsFromTree(oDoc.GetRoot(), oCopied);
+			END_BENCHMARK_VERSUS_CHALLENGER()
+
+			BEGIN_BENCHMARK_VERSUS_CHALLENGER("JsonStthmBind")
+				JsonStthm::Bind::ReadString(oContent.Data(), oBound);
+			END_BENCHMARK_VERSUS_CHALLENGER()
+		END_BENCHMARK_VERSUS()
+
+		const size_t iLength = oContent.Size() - 1;
+		BEGIN_TEST_SUITE("Validate")
+			CHECK(JsonStthm::JsonValue::Validate(oContent.Data(), iLength) == 0)
+			JsonStthm::JsonDoc oDoc;
+			CHECK(oDoc.ReadString(oContent.Data(), JsonStthm::JsonValue::E_READ_VALIDATE_UTF8) == 0)
+			CHECK(JsonStthm::JsonValue::Validate("[\"\xC3\"]", 5) == 1)
+			CHECK(JsonStthm::JsonValue::Validate("[1,]", 4) == 1)
+			CHECK(JsonStthm::JsonValue::Validate("[\"a\x01\"]", 6) == 1 && JsonStthm::JsonValue::Validate("[\"a\\u0001\"]", 11) == 0)
+
+			// Long non-ASCII runs go through the SIMD lookups, invalid bytes are found past the first blocks
+			std::string sAccents = "[\"";
+			for (int i = 0; i < 100; ++i)
+				sAccents.append("\xC3\xA9t\xE2\x82\xAC\xF0\x9F\x98\x80");
+			sAccents.append("\"]");
+			CHECK(oDoc.ReadString(sAccents.c_str(), JsonStthm::JsonValue::E_READ_VALIDATE_UTF8) == 0)
+			sAccents[700] = '\xED'; // Surrogate lead in the middle of a sequence
+			sAccents[701] = '\xA0';
+			CHECK(oDoc.ReadString(sAccents.c_str(), JsonStthm::JsonValue::E_READ_VALIDATE_UTF8) != 0)
+		END_TEST_SUITE()
+
+		BEGIN_BENCHMARK_VERSUS("Validate")
+			BEGIN_BENCHMARK_VERSUS_CHALLENGER("JsonDoc::ReadString")
+				JsonStthm::JsonDoc oDoc;
+				oDoc.ReadString(oContent.Data());
+			END_BENCHMARK_VERSUS_CHALLENGER()
+
+			BEGIN_BENCHMARK_VERSUS_CHALLENGER("JsonDoc::ReadString E_READ_VALIDATE_UTF8")
+				JsonStthm::JsonDoc oDoc;
+				oDoc.ReadString(oContent.Data(), JsonStthm::JsonValue::E_READ_VALIDATE_UTF8);
+			END_BENCHMARK_VERSUS_CHALLENGER()
+
+			BEGIN_BENCHMARK_VERSUS_CHALLENGER("JsonValue::Validate")
+				JsonStthm::JsonValue::Validate(oContent.Data(), iLength);
+			END_BENCHMARK_VERSUS_CHALLENGER()
+		END_BENCHMARK_VERSUS()
+	}
+
+	{
+		// String heavy document, ASCII with a few escapes and Japanese text
+		JsonStthm::JsonValue oStrings;
+		for (int i = 0; i < 200000; ++i)
+		{
+			oStrings[i]["text"] = "The quick brown fox jumps over the lazy dog, \"quoted\"\tand tabbed";
+			oStrings[i]["ja"] = "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E\xE3\x81\xAE\xE3\x83\x86\xE3\x82\xAD\xE3\x82\xB9\xE3\x83\x88";
+		}
+
+		BEGIN_TEST_SUITE("E_WRITE_RAW_UTF8")
+			std::string sEscaped;
+			std::string sRaw;
+			oStrings.WriteString(sEscaped, true);
+			oStrings.WriteString(sRaw, true, JsonStthm::JsonValue::E_WRITE_RAW_UTF8);
+			CHECK(sRaw.size() < sEscaped.size())
+			JsonStthm::JsonValue oEscaped;
+			JsonStthm::JsonValue oRaw;
+			CHECK(oEscaped.ReadString(sEscaped.c_str()) == 0 && oRaw.ReadString(sRaw.c_str()) == 0)
+			CHECK(oEscaped == oStrings && oRaw == oStrings)
+		END_TEST_SUITE()
+
+		BEGIN_BENCHMARK_VERSUS("Write strings")
+			BEGIN_BENCHMARK_VERSUS_CHALLENGER("escaped")
+				JsonStthm::Internal::CharBuffer oOut;
+				oStrings.Write(oOut, 0, true);
+			END_BENCHMARK_VERSUS_CHALLENGER()
+
+			BEGIN_BENCHMARK_VERSUS_CHALLENGER("E_WRITE_RAW_UTF8")
+				JsonStthm::Internal::CharBuffer oOut;
+				oStrings.Write(oOut, 0, true, JsonStthm::JsonValue::E_WRITE_RAW_UTF8);
+			END_BENCHMARK_VERSUS_CHALLENGER()
+		END_BENCHMARK_VERSUS()
+	}
+
+	{
+		JsonStthm::JsonValue oItems;
+		oItems.ReadFile(c_pBenchmarkFile);
+		const int iItemCount = oItems.GetMemberCount();
+
+		BEGIN_TEST_SUITE("Move, Detach and Adopt")
+			JsonStthm::JsonValue oCopy(oItems);
+			JsonStthm::JsonValue oMoved(std::move(oCopy));
+			CHECK(oCopy.IsNull() && oMoved == oItems)
+			JsonStthm::JsonValue oDetached;
+			CHECK(oMoved.Detach(1234, oDetached) && oDetached == oItems[1234] && oMoved.GetMemberCount() == iItemCount - 1)
+			CHECK(oMoved[1234] == oItems[1235])
+			oMoved.Adopt(oDetached);
+			CHECK(oDetached.IsNull() && oMoved[iItemCount - 1] == oItems[1234])
+		END_TEST_SUITE()
+
+		BEGIN_BENCHMARK_VERSUS("Store values in a std::vector")
+			BEGIN_BENCHMARK_VERSUS_CHALLENGER("copy")
+				std::vector<JsonStthm::JsonValue> oValues;
+				oValues.reserve(iItemCount);
+				for (JsonStthm::JsonValue::Iterator oIt(&oItems); oIt.IsValid(); ++oIt)
+					oValues.push_back(*oIt);
+			END_BENCHMARK_VERSUS_CHALLENGER()
+
+			BEGIN_BENCHMARK_VERSUS_CHALLENGER("move, then move back")
+				std::vector<JsonStthm::JsonValue> oValues;
+				oValues.reserve(iItemCount);
+				for (JsonStthm::JsonValue::Iterator oIt(&oItems); oIt.IsValid(); ++oIt)
+					oValues.push_back(std::move(*oIt));
+				int iIndex = 0;
+				for (JsonStthm::JsonValue::Iterator oIt(&oItems); oIt.IsValid(); ++oIt)
+					*oIt = std::move(oValues[iIndex++]);
+			END_BENCHMARK_VERSUS_CHALLENGER()
+		END_BENCHMARK_VERSUS()
+	}
+
+	BEGIN_TEST_SUITE("E_READ_PARALLEL_ARRAY")
+		JsonStthm::JsonValue oSequential;
+		JsonStthm::JsonDoc oParallel;
+		CHECK_FATAL(oSequential.ReadFile(c_pBenchmarkFile) == 0)
+		CHECK_FATAL(oParallel.ReadFile(c_pBenchmarkFile, JsonStthm::JsonValue::E_READ_PARALLEL_ARRAY) == 0)
+		CHECK(oSequential == oParallel.GetRoot())
+
+		// Values before the error are kept and counted
+		std::string sInvalid = "[";
+		for (int i = 0; i < 20000; ++i)
+			sInvalid.append(i == 0 ? "" : ",").append(i == 15000 ? "{ \"id\": }" : "{ \"id\": 1 }");
+		sInvalid.append("]");
+		CHECK(oParallel.ReadString(sInvalid.c_str(), JsonStthm::JsonValue::E_READ_PARALLEL_ARRAY) == 1)
+		int iLinked = 0;
+		for (JsonStthm::JsonValue::Iterator oIt(&oParallel.GetRoot()); oIt.IsValid(); ++oIt)
+			++iLinked;
+		CHECK(iLinked >= 15000 && oParallel.GetRoot().GetMemberCount() == iLinked && oParallel.GetRoot()[5].IsObject())
+	END_TEST_SUITE()
+
+	BEGIN_BENCHMARK_VERSUS("JsonDoc top level array")
+		BEGIN_BENCHMARK_VERSUS_CHALLENGER("sequential")
+			JsonStthm::JsonDoc oDoc;
+			oDoc.ReadFile(c_pBenchmarkFile);
+		END_BENCHMARK_VERSUS_CHALLENGER()
+
+		BEGIN_BENCHMARK_VERSUS_CHALLENGER("parallel")
+			JsonStthm::JsonDoc oDoc;
+			oDoc.ReadFile(c_pBenchmarkFile, JsonStthm::JsonValue::E_READ_PARALLEL_ARRAY);
+		END_BENCHMARK_VERSUS_CHALLENGER()
+	END_BENCHMARK_VERSUS()
+
+	{
+		// Deep nesting around the STTHM_MAX_DEPTH limit, then many shallow nests
+		std::string sDeepest(STTHM_MAX_DEPTH, '[');
+		sDeepest.append(STTHM_MAX_DEPTH, ']');
+		std::string sTooDeep(STTHM_MAX_DEPTH + 1, '[');
+		sTooDeep.append(STTHM_MAX_DEPTH + 1, ']');
+		std::string sNested = "[";
+		for (int i = 0; i < 20000; ++i)
+			sNested.append(i > 0 ? ",[[[[{\"a\":[[{\"b\":[1,2]}]]}]]]]" : "[[[[{\"a\":[[{\"b\":[1,2]}]]}]]]]");
+		sNested.append("]");
+
+		BEGIN_TEST_SUITE("STTHM_MAX_DEPTH")
+			JsonStthm::JsonValue oValue;
+			CHECK(oValue.ReadString(sDeepest.c_str()) == 0)
+			CHECK(oValue.ReadString(sTooDeep.c_str()) == 1)
+			JsonStthm::JsonDoc oDoc;
+			CHECK(oDoc.ReadString(sTooDeep.c_str()) == 1)
+			CHECK(oDoc.ReadString(sNested.c_str()) == 0 && oDoc.GetRoot().GetMemberCount() == 20000)
+			JsonStthm::JsonTape oTape;
+			CHECK(oTape.ReadString(sDeepest.c_str()) == 0)
+			CHECK(oTape.ReadString(sTooDeep.c_str()) == 1)
+			JsonStthm::JsonSax oSax;
+			JsonStthm::JsonSaxHandler oHandler;
+			CHECK(oSax.ReadString(sDeepest.c_str(), oHandler) == 0)
+			CHECK(oSax.ReadString(sTooDeep.c_str(), oHandler) == 1)
+
+			// Recursive baseline of the versus below builds the same tree
+			BaselineJsonValue oIterative;
+			BaselineJsonValue oRecursive;
+			const char* pIterative = sNested.c_str();
+			const char* pRecursive = sNested.c_str();
+			CHECK_FATAL(oIterative.Parse(pIterative, false) && oRecursive.ParseRecursive(pRecursive))
+			CHECK(pIterative == pRecursive && oIterative == oRecursive)
+		END_TEST_SUITE()
+
+		BEGIN_BENCHMARK_VERSUS("Nested containers")
+			BEGIN_BENCHMARK_VERSUS_CHALLENGER("JsonValue::Parse, iterative")
+				BaselineJsonValue oValue;
+				const char* pString = sNested.c_str();
+				oValue.Parse(pString, false);
+			END_BENCHMARK_VERSUS_CHALLENGER()
+
+			BEGIN_BENCHMARK_VERSUS_CHALLENGER("Baseline, recursive")
+				BaselineJsonValue oValue;
+				const char* pString = sNested.c_str();
+				oValue.ParseRecursive(pString);
+			END_BENCHMARK_VERSUS_CHALLENGER()
+		END_BENCHMARK_VERSUS()
+	}
+
+	BEGIN_TEST_SUITE("JsonSax")
+		const char* const c_pEvents = "{\"a\":[1,2.5,\"x\\ty\",true,null],\"b\":{\"c\":false},\"d\":{\"e\":[{}]},\"f\":-3}";
+		JsonStthm::JsonSax oSax;
+		RecordingHandler oAll;
+		CHECK(oSax.ReadString(c_pEvents, oAll) == 0)
+		CHECK(oAll.m_sEvents == "{ k:a [ i:1 f:2.500000 s:x\ty true null ] k:b { k:c false } k:d { k:e [ { } ] } k:f i:-3 }")
+
+		// Skipped object, its content and end event are not sent
+		RecordingHandler oSkipObject;
+		oSkipObject.m_iSkipObject = 1;
+		CHECK(oSax.ReadString(c_pEvents, oSkipObject) == 0)
+		CHECK(oSkipObject.m_sEvents == "{ k:a [ i:1 f:2.500000 s:x\ty true null ] k:b { k:d { k:e [ { } ] } k:f i:-3 }")
+
+		// Skipped member, its whole value is not sent
+		RecordingHandler oSkipKey;
+		oSkipKey.m_sSkipKey = "d";
+		CHECK(oSax.ReadString(c_pEvents, oSkipKey) == 0)
+		CHECK(oSkipKey.m_sEvents == "{ k:a [ i:1 f:2.500000 s:x\ty true null ] k:b { k:c false } k:d k:f i:-3 }")
+
+		// Stop is not an error, nothing is sent afterwards
+		RecordingHandler oStop;
+		oStop.m_iStopAfter = 4;
+		CHECK(oSax.ReadString(c_pEvents, oStop) == 0)
+		CHECK(oStop.m_sEvents == "{ k:a [ i:1")
+		CHECK(oSax.ReadString("{\"a\":[1,", oAll) == 1)
+	END_TEST_SUITE()
+
+	BEGIN_TEST_SUITE("JsonPushReader")
+		// Same events as JsonSax whatever the chunk boundaries
+		const char* const c_pSplit = "{ \"n\\u00e9\": [-12.5e1, 123456789012, \"a\\\"b\\ud83d\\ude00\"],\n \"t\": true, \"f\": false, \"z\": null, \"o\": {\"p\": [[], {}]} }";
+		const size_t iSplitLength = strlen(c_pSplit);
+		JsonStthm::JsonSax oSax;
+		RecordingHandler oExpected;
+		CHECK_FATAL(oSax.ReadString(c_pSplit, oExpected) == 0)
+		int iMismatches = 0;
+		for (size_t iSplit = 0; iSplit <= iSplitLength; ++iSplit)
+		{
+			RecordingHandler oHandler;
+			JsonStthm::JsonPushReader oReader(oHandler);
+			if (oReader.Feed(c_pSplit, iSplit) != 0 || oReader.Feed(c_pSplit + iSplit, iSplitLength - iSplit) != 0
+				|| oReader.Finish() != 0 || oHandler.m_sEvents != oExpected.m_sEvents)
+				++iMismatches;
+		}
+		CHECK(iMismatches == 0)
+
+		RecordingHandler oBytes;
+		JsonStthm::JsonPushReader oByteReader(oBytes);
+		for (size_t i = 0; i < iSplitLength; ++i)
+			oByteReader.Feed(c_pSplit + i, 1);
+		CHECK(oByteReader.Finish() == 0 && oByteReader.IsDone() && oBytes.m_sEvents == oExpected.m_sEvents)
+
+		// A top level number only ends with Finish, incomplete documents fail there
+		RecordingHandler oNumber;
+		JsonStthm::JsonPushReader oNumberReader(oNumber);
+		CHECK(oNumberReader.Feed("12", 2) == 0 && oNumber.m_sEvents.empty() && oNumberReader.Finish() == 0 && oNumber.m_sEvents == "i:12")
+		oNumberReader.Reset();
+		oNumber.m_sEvents.clear();
+		CHECK(oNumberReader.Feed(" ", 1) == 0 && oNumberReader.Finish() == 0 && oNumber.m_sEvents.empty()) // Empty input is not an error, as for JsonSax
+		const char* const c_pIncomplete[] = { "{\"a\":[1,", "{\"a\"", "\"abc", "[1,\n2", "tru" };
+		for (size_t i = 0; i < sizeof(c_pIncomplete) / sizeof(c_pIncomplete[0]); ++i)
+		{
+			RecordingHandler oHandler;
+			JsonStthm::JsonPushReader oReader(oHandler);
+			CHECK(oReader.Feed(c_pIncomplete[i], strlen(c_pIncomplete[i])) == 0 && oReader.Finish() != 0 && oReader.IsDone() == false)
+		}
+	END_TEST_SUITE()
+
+	BEGIN_TEST_SUITE("JsonLinesReader")
+		JsonStthm::JsonLinesReader oReader;
+		int iCount = 0;
+		CHECK(oReader.ReadFile(c_pBenchmarkLinesFile, CountLine, &iCount) == 0)
+		CHECK(iCount == 500000)
+
+		// Small batches on several threads, nothing after the invalid line is delivered
+		std::string sLines;
+		for (int i = 0; i < 20000; ++i)
+			sLines.append(i == 10000 ? "{ \"id\": ,\n" : "{ \"id\": 1 }\n");
+		JsonStthm::JsonLinesReader oSmallBatches(4, 4096);
+		iCount = 0;
+		CHECK(oSmallBatches.ReadString(sLines.c_str(), CountLine, &iCount) == 10001 && iCount == 10000)
+	END_TEST_SUITE()
+
+	BEGIN_BENCHMARK_VERSUS("JsonLinesReader::ReadFile")
+		BEGIN_BENCHMARK_VERSUS_CHALLENGER("1 thread")
+			JsonStthm::JsonLinesReader oReader(1);
+			int iCount = 0;
+			oReader.ReadFile(c_pBenchmarkLinesFile, CountLine, &iCount);
+		END_BENCHMARK_VERSUS_CHALLENGER()
+
+		BEGIN_BENCHMARK_VERSUS_CHALLENGER("all threads, ordered")
+			JsonStthm::JsonLinesReader oReader;
+			int iCount = 0;
+			oReader.ReadFile(c_pBenchmarkLinesFile, CountLine, &iCount);
+		END_BENCHMARK_VERSUS_CHALLENGER()
+	END_BENCHMARK_VERSUS()
+
+	remove(c_pBenchmarkFile);
+	remove(c_pBenchmarkLinesFile);
+	return 0;
+}
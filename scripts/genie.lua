@@ -121,3 +121,29 @@ solution "UtilsCollection"
 			flags			{ "Optimize" }
 
 		SetupPrefix()
+
+	project "JsonStthmBenchmark"
+		uuid				"3b6f1c2e-8d4a-4f7e-9c15-52a7e0d9b841"
+		kind				"ConsoleApp"
+		targetdir			"../.output/"
+
+		files {
+							"../JsonStthm/**.cpp",
+							"../JsonStthm/**.h",
+
+							"../Benchmarker/Benchmarker.cpp",
+							"../Benchmarker/Benchmarker.h"
+		}
+
+		configuration		"linux"
+			links			{ "pthread" }
+
+		configuration()
+
+		configuration		"Debug"
+			flags			{ "Symbols" }
+			
+		configuration		"Release"
+			flags			{ "Optimize" }
+
+		SetupPrefix()